@@ -0,0 +1,24 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/BoltCircleParameterisation.hh>
+
+#include <G4VPhysicalVolume.hh>
+#include <G4PhysicalConstants.hh>
+
+namespace RAT
+{
+  G4ThreeVector BoltCircleParameterisation::GetPosition(const G4int copyNo) const
+  {
+    G4ThreeVector position(fFirstPosition);
+    return position.rotateZ(CLHEP::twopi*double(copyNo+1)/double(fNCopies));
+  } // GetPosition
+
+  void BoltCircleParameterisation::ComputeTransformation(const G4int copyNo,
+                                                         G4VPhysicalVolume *physVol) const
+  {
+    physVol->SetTranslation(GetPosition(copyNo));
+    physVol->SetRotation(0);
+  } // ComputeTransformation
+} // namespace RAT
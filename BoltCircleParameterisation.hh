@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::BoltCircleParameterisation
+//
+// \brief Places the copies of a volume evenly round a circle
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version, for the calibration source screws. \n
+//
+//
+// \detail Copy n sits at the first position rotated by (n+1) steps of
+//         2 pi / nCopies about the z axis, which matches the order the
+//         screw holes are cut in. The copies are not rotated, so the
+//         parameterised volume should be symmetric about its own z axis.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_BoltCircleParameterisation__
+#define __RAT_BoltCircleParameterisation__
+
+#include <G4VPVParameterisation.hh>
+#include <G4ThreeVector.hh>
+
+class G4VPhysicalVolume;
+
+namespace RAT
+{
+
+  class BoltCircleParameterisation : public G4VPVParameterisation
+  {
+  public:
+    BoltCircleParameterisation(const int nCopies, const G4ThreeVector &firstPosition)
+      : fNCopies(nCopies), fFirstPosition(firstPosition) { };
+    virtual ~BoltCircleParameterisation() { };
+
+    virtual void ComputeTransformation(const G4int copyNo,
+                                       G4VPhysicalVolume *physVol) const;
+
+    int GetNCopies() const { return fNCopies; };
+    const G4ThreeVector& GetFirstPosition() const { return fFirstPosition; };
+    G4ThreeVector GetPosition(const G4int copyNo) const;
+  protected:
+    int fNCopies;
+    G4ThreeVector fFirstPosition;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceEarlyAbort.hh>
+#include <RAT/CalibSourceTagGate.hh>
+
+#include <G4RunManager.hh>
+#include <G4Threading.hh>
+#include <G4EventManager.hh>
+#include <G4StackManager.hh>
+#include <G4Track.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4LogicalVolume.hh>
+
+namespace RAT
+{
+  void CalibSourceEarlyAbort::Install(CalibSourceTagGate *gate)
+  {
+    // Nothing is tracked on the master of a multithreaded run, which only
+    // takes a stacking action from the action initialization
+    if(G4Threading::IsMultithreadedApplication() && !G4Threading::IsWorkerThread())
+      return;
+    // The run manager, and so its stacking action, is per thread
+    G4RunManager* runManager = G4RunManager::GetRunManager();
+    G4UserStackingAction* current = const_cast<G4UserStackingAction*>(runManager->GetUserStackingAction());
+    CalibSourceEarlyAbort* earlyAbort = dynamic_cast<CalibSourceEarlyAbort*>(current);
+    if(earlyAbort == NULL){
+      earlyAbort = new CalibSourceEarlyAbort(current);
+      runManager->SetUserAction(earlyAbort);
+    }
+    earlyAbort->fGates.push_back(gate);
+  } // Install
+
+  CalibSourceEarlyAbort::CalibSourceEarlyAbort(G4UserStackingAction *action)
+    : fAction(action), fDecided(false)
+  {
+  }
+
+  CalibSourceEarlyAbort::~CalibSourceEarlyAbort()
+  {
+    delete fAction;
+  }
+
+  G4ClassificationOfNewTrack CalibSourceEarlyAbort::ClassifyNewTrack(const G4Track *track)
+  {
+    if(!fDecided && !InSource(track))
+      return fWaiting;
+    G4ClassificationOfNewTrack classification = fAction != NULL ? fAction->ClassifyNewTrack(track) : fUrgent;
+    // The sources are tracked to the end before anything else
+    if(!fDecided && classification != fKill)
+      classification = fUrgent;
+    return classification;
+  } // ClassifyNewTrack
+
+  void CalibSourceEarlyAbort::NewStage()
+  {
+    if(fDecided){
+      if(fAction != NULL)
+        fAction->NewStage();
+      return;
+    }
+
+    fDecided = true;
+    for(size_t i=0; i<fGates.size(); i++)
+      if(fGates[i]->Fires()){
+        // The waiting tracks are now in the urgent stack, and the other
+        // action has not seen them yet
+        if(fAction != NULL)
+          stackManager->ReClassify();
+        return;
+      }
+    G4EventManager::GetEventManager()->AbortCurrentEvent();
+  } // NewStage
+
+  void CalibSourceEarlyAbort::PrepareNewEvent()
+  {
+    fDecided = false;
+    if(fAction != NULL)
+      fAction->PrepareNewEvent();
+  } // PrepareNewEvent
+
+  G4bool CalibSourceEarlyAbort::InSource(const G4Track *track) const
+  {
+    // Primaries are not in a volume until their first step, and are what
+    // the sources emit
+    if(track->GetParentID() == 0 || track->GetVolume() == NULL)
+      return true;
+    const G4Region* region = track->GetVolume()->GetLogicalVolume()->GetRegion();
+    for(size_t i=0; i<fGates.size(); i++)
+      if(fGates[i]->GetRegion() == region)
+        return true;
+    return false;
+  } // InSource
+} // namespace RAT
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceEarlyAbort
+//
+// \brief Stacking action that aborts events whose source tag cannot fire
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Tracks are first followed only inside the gated sources' regions.
+//         Primaries and everything made in a source region go on the
+//         urgent stack; tracks made anywhere else wait. Once the urgent
+//         stack is empty the source is done with. If no tag gate (see
+//         CalibSourceTagGate) fires, the event is aborted before any of
+//         the waiting tracks, and the optical photons they would make,
+//         are tracked. Otherwise the waiting tracks are handed to the
+//         detector's own stacking action and the event carries on.
+//
+//         Install puts one in front of the stacking action the run manager
+//         already has on this thread, which then sees every track and
+//         stage it would have seen without it, apart from the first stage.
+//         The geometry factories call it while creating the sensitive
+//         detectors, i.e. after the user actions are set.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceEarlyAbort__
+#define __RAT_CalibSourceEarlyAbort__
+
+#include <G4UserStackingAction.hh>
+
+#include <vector>
+
+namespace RAT
+{
+
+  class CalibSourceTagGate;
+
+  class CalibSourceEarlyAbort : public G4UserStackingAction
+  {
+  public:
+    // Add the gate to this thread's stacking action, installing it first
+    // if need be
+    static void Install(CalibSourceTagGate *gate);
+
+    virtual ~CalibSourceEarlyAbort();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track *track);
+    virtual void NewStage();
+    virtual void PrepareNewEvent();
+
+  protected:
+    CalibSourceEarlyAbort(G4UserStackingAction *action);
+
+    // Whether the track starts in one of the gated sources
+    G4bool InSource(const G4Track *track) const;
+
+    // The stacking action this one is in front of, if any; owned
+    G4UserStackingAction *fAction;
+    std::vector<CalibSourceTagGate*> fGates;
+    // Whether this event's tag has been decided
+    G4bool fDecided;
+  };
+
+} // namespace RAT
+
+#endif
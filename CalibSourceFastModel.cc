@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceFastModel.hh>
+#include <RAT/CalibSourceResponse.hh>
+
+#include <RAT/Log.hh>
+
+#include <G4FastTrack.hh>
+#include <G4FastStep.hh>
+#include <G4Track.hh>
+#include <G4Step.hh>
+#include <G4VSolid.hh>
+#include <G4Electron.hh>
+#include <G4Positron.hh>
+#include <G4Gamma.hh>
+#include <G4SDManager.hh>
+#include <G4VSensitiveDetector.hh>
+#include <G4PhysicalConstants.hh>
+
+namespace RAT
+{
+  CalibSourceFastModel::CalibSourceFastModel(const std::string &name, G4Region *envelope,
+                                             const CalibSourceResponse &response,
+                                             const std::string &detectorName)
+    : G4VFastSimulationModel(name,envelope), fResponse(response)
+  {
+    fDetector = G4SDManager::GetSDMpointer()->FindSensitiveDetector(detectorName,false);
+    Log::Assert(fDetector != NULL,"CalibSourceFastModel: No sensitive detector " + detectorName +
+                " for " + name + ".");
+  }
+
+  G4bool CalibSourceFastModel::IsApplicable(const G4ParticleDefinition &particle)
+  {
+    return &particle == G4Electron::Definition() || &particle == G4Positron::Definition() ||
+      &particle == G4Gamma::Definition();
+  } // IsApplicable
+
+  G4bool CalibSourceFastModel::ModelTrigger(const G4FastTrack &fastTrack)
+  {
+    // Only what the isotope emits, before it has taken a step
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    if(track->GetParentID() != 0 || track->GetCurrentStepNumber() > 1)
+      return false;
+    if(track->GetDefinition() == G4Gamma::Definition())
+      return fResponse.CoversGamma(track->GetKineticEnergy());
+    return fResponse.CoversBeta(track->GetKineticEnergy());
+  } // ModelTrigger
+
+  void CalibSourceFastModel::DoIt(const G4FastTrack &fastTrack, G4FastStep &fastStep)
+  {
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const double startEnergy = track->GetKineticEnergy();
+    const bool isGamma = track->GetDefinition() == G4Gamma::Definition();
+
+    const double tagEnergy = isGamma ? fResponse.SampleGammaTag(startEnergy) :
+      fResponse.SampleBetaTag(startEnergy);
+    if(tagEnergy > 0.)
+      Tag(track,tagEnergy);
+    // The deposit below is for the energy balance; the tag is the table's
+    // alone, so the fast step must not reach the sensitive detector too
+    fastStep.ProposeSteppingControl(AvoidHitInvocation);
+
+    double energy = startEnergy;
+    G4ThreeVector direction = fastTrack.GetPrimaryTrackLocalDirection();
+    if(!isGamma || !fResponse.SampleGammaEscape(energy,direction)){
+      fastStep.KillPrimaryTrack();
+      fastStep.ProposeTotalEnergyDeposited(startEnergy);
+      return;
+    }
+
+    // Out of the envelope in a straight line
+    const G4ThreeVector position = fastTrack.GetPrimaryTrackLocalPosition();
+    const double distance = fastTrack.GetEnvelopeSolid()->DistanceToOut(position,direction);
+    fastStep.ProposePrimaryTrackFinalPosition(position+distance*direction);
+    fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime()+distance/CLHEP::c_light);
+    fastStep.ProposePrimaryTrackFinalKineticEnergyAndDirection(energy,direction);
+    fastStep.ProposePrimaryTrackPathLength(distance);
+    fastStep.ProposeTotalEnergyDeposited(startEnergy-energy);
+  } // DoIt
+
+  void CalibSourceFastModel::Tag(const G4Track *track, const double energy)
+  {
+    // A step of no length where the particle starts
+    G4Step step;
+    step.InitializeStep(const_cast<G4Track*>(track));
+    step.SetTotalEnergyDeposit(energy);
+    fDetector->Hit(&step);
+  } // Tag
+} // namespace RAT
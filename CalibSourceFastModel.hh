@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceFastModel
+//
+// \brief Fast simulation of a calibration source capsule
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Betas and gammas emitted by the isotope (primaries starting in
+//         the source envelope) are not tracked through the capsule.
+//         Instead the response table (see CalibSourceResponse) decides
+//         whether each one tags, i.e. leaves energy in the scintillator,
+//         and whether a gamma escapes, with what energy and direction.
+//         A tag is passed to the source's sensitive detector as a single
+//         step at the particle's starting point. A gamma that escapes
+//         leaves the envelope in a straight line from there, and is
+//         tracked in full from then on; everything else is absorbed.
+//
+//         Particles entering the envelope from outside, and any energy the
+//         table does not cover, are tracked in full as usual. Brems and
+//         annihilation photons from the betas are not produced.
+//
+//         The physics list must include the fast simulation process (e.g.
+//         G4FastSimulationPhysics) for e-, e+ and gamma. Models belong to a
+//         thread, so they are created while the source is built and again
+//         on each worker in GeoCalibSourceFactory::ConstructSDandField.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceFastModel__
+#define __RAT_CalibSourceFastModel__
+
+#include <G4VFastSimulationModel.hh>
+
+#include <string>
+
+class G4Region;
+class G4Track;
+class G4VSensitiveDetector;
+
+namespace RAT
+{
+
+  class CalibSourceResponse;
+
+  class CalibSourceFastModel : public G4VFastSimulationModel
+  {
+  public:
+    // The sensitive detector called detectorName must already exist on
+    // this thread
+    CalibSourceFastModel(const std::string &name, G4Region *envelope,
+                         const CalibSourceResponse &response,
+                         const std::string &detectorName);
+    virtual ~CalibSourceFastModel() { };
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition &particle);
+    virtual G4bool ModelTrigger(const G4FastTrack &fastTrack);
+    virtual void DoIt(const G4FastTrack &fastTrack, G4FastStep &fastStep);
+
+  protected:
+    // Hand the deposited energy to the sensitive detector
+    void Tag(const G4Track *track, const double energy);
+
+    const CalibSourceResponse &fResponse;
+    G4VSensitiveDetector *fDetector;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceFidelityActions.hh>
+
+#include <RAT/Log.hh>
+
+#include <G4ParticleGun.hh>
+#include <G4Electron.hh>
+#include <G4Gamma.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4Event.hh>
+#include <G4Step.hh>
+#include <G4Track.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4RunManager.hh>
+#include <G4Threading.hh>
+#include <G4RandomDirection.hh>
+#include <Randomize.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+namespace RAT
+{
+  void CalibSourceFidelityEventAction::BeginOfEventAction(const G4Event *event)
+  {
+    fRecord = CalibSourceFidelityEvent();
+    fRecord.id = event->GetEventID();
+    fRecord.tagEnergy = 0.;
+    fStartTime = ThreadTime();
+  } // BeginOfEventAction
+
+  void CalibSourceFidelityEventAction::EndOfEventAction(const G4Event *event)
+  {
+    fRecord.cpuTime = ThreadTime()-fStartTime;
+    CalibSourceFidelityRun* run =
+      static_cast<CalibSourceFidelityRun*>(G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+    run->Record(fRecord);
+  } // EndOfEventAction
+
+  double CalibSourceFidelityEventAction::ThreadTime()
+  {
+    // Only this thread's time, however busy the other threads are
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID,&now);
+    return now.tv_sec+1e-9*now.tv_nsec;
+  } // ThreadTime
+
+  CalibSourceFidelityGenerator::CalibSourceFidelityGenerator(const CalibSourceFidelitySettings &settings)
+    : fSettings(settings), fBetaShapeMax(0.)
+  {
+    fGun = new G4ParticleGun(1);
+    // The shape has a single maximum, so a fine scan bounds it
+    for(int i=1; i<1000; i++)
+      fBetaShapeMax = std::max(fBetaShapeMax,BetaShape(settings.betaEndPoint*i/1000.));
+    fBetaShapeMax *= 1.01;
+  }
+
+  CalibSourceFidelityGenerator::~CalibSourceFidelityGenerator()
+  {
+    delete fGun;
+  }
+
+  void CalibSourceFidelityGenerator::GeneratePrimaries(G4Event *event)
+  {
+    fGun->SetParticlePosition(fSettings.source.origin);
+    fGun->SetParticleTime(0.);
+    if(fSettings.source.mode == CalibSourceResponseSettings::kOptical){
+      G4ThreeVector direction = G4RandomDirection();
+      if(direction.dot(fSettings.source.axis) < 0.)
+        direction = -direction;
+      fGun->SetParticleDefinition(G4OpticalPhoton::Definition());
+      fGun->SetParticlePolarization(direction.orthogonal().unit());
+      fGun->SetParticleEnergy(fSettings.source.photonEnergy);
+      fGun->SetParticleMomentumDirection(direction);
+      fGun->GeneratePrimaryVertex(event);
+      return;
+    }
+
+    // The beta, then the gammas of the cascade, with no angular correlation
+    fGun->SetParticleDefinition(G4Electron::Definition());
+    fGun->SetParticleEnergy(BetaEnergy());
+    fGun->SetParticleMomentumDirection(G4RandomDirection());
+    fGun->GeneratePrimaryVertex(event);
+    fGun->SetParticleDefinition(G4Gamma::Definition());
+    for(size_t i=0; i<fSettings.gammaLines.size(); i++){
+      fGun->SetParticleEnergy(fSettings.gammaLines[i]);
+      fGun->SetParticleMomentumDirection(G4RandomDirection());
+      fGun->GeneratePrimaryVertex(event);
+    }
+  } // GeneratePrimaries
+
+  double CalibSourceFidelityGenerator::BetaEnergy() const
+  {
+    while(true){
+      const double T = fSettings.betaEndPoint*G4UniformRand();
+      if(fBetaShapeMax*G4UniformRand() < BetaShape(T))
+        return T;
+    }
+  } // BetaEnergy
+
+  double CalibSourceFidelityGenerator::BetaShape(const double T) const
+  {
+    if(T <= 0. || T >= fSettings.betaEndPoint)
+      return 0.;
+    const double E = T+CLHEP::electron_mass_c2;
+    const double p = std::sqrt(E*E-CLHEP::electron_mass_c2*CLHEP::electron_mass_c2);
+    return p*E*(fSettings.betaEndPoint-T)*(fSettings.betaEndPoint-T);
+  } // BetaShape
+
+  void CalibSourceFidelityStepping::UserSteppingAction(const G4Step *step)
+  {
+    if(fWorld == NULL){
+      G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+      fWorld = store->GetVolume("world");
+      fScintillator = store->GetVolume(fIndex+"_scintillator_log",false);
+    }
+
+    CalibSourceFidelityEvent &record = fEventAction->GetRecord();
+    if(fScintillator != NULL &&
+       step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume() == fScintillator)
+      record.tagEnergy += step->GetTotalEnergyDeposit();
+
+    // Everything that leaves the source is recorded, and then dropped
+    const G4StepPoint* post = step->GetPostStepPoint();
+    if(post->GetStepStatus() != fGeomBoundary || post->GetPhysicalVolume() == NULL ||
+       post->GetPhysicalVolume()->GetLogicalVolume() != fWorld)
+      return;
+    G4Track* track = step->GetTrack();
+    CalibSourceFidelityParticle particle;
+    particle.kind = CalibSourceFidelityParticle::GetKind(track->GetDefinition());
+    particle.energy = post->GetKineticEnergy();
+    particle.time = post->GetGlobalTime();
+    record.escaped.push_back(particle);
+    track->SetTrackStatus(fStopAndKill);
+  } // UserSteppingAction
+
+  G4Run* CalibSourceFidelityRunAction::GenerateRun()
+  {
+    return new CalibSourceFidelityRun(fSettings);
+  } // GenerateRun
+
+  void CalibSourceFidelityRunAction::EndOfRunAction(const G4Run *run)
+  {
+    // The master's run holds the events of all the workers
+    if(G4Threading::IsMasterThread())
+      static_cast<const CalibSourceFidelityRun*>(run)->Write();
+  } // EndOfRunAction
+
+  void CalibSourceFidelityActionInitialization::Build() const
+  {
+    CalibSourceFidelityEventAction* eventAction = new CalibSourceFidelityEventAction();
+    SetUserAction(eventAction);
+    SetUserAction(new CalibSourceFidelityGenerator(fSettings));
+    SetUserAction(new CalibSourceFidelityStepping(fSettings.source.index,eventAction));
+    SetUserAction(new CalibSourceFidelityRunAction(fSettings));
+  } // Build
+
+  void CalibSourceFidelityActionInitialization::BuildForMaster() const
+  {
+    SetUserAction(new CalibSourceFidelityRunAction(fSettings));
+  } // BuildForMaster
+} // namespace RAT
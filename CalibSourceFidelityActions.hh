@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////
+// \file CalibSourceFidelityActions.hh
+//
+// \brief User actions of calib_source_fidelity
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail The geometry is that of calib_source_response
+//         (CalibSourceResponseDetector): one source alone in a world, the
+//         envelope its only daughter. A particle stepping into the world
+//         has escaped and is not tracked any further.
+//
+//         Each event is one decay of the tagged source's isotope, from the
+//         settings' origin: a beta with the allowed spectrum shape up to
+//         the end point, then each gamma of the cascade, all in random
+//         directions. In optical mode it is one LED photon heading into
+//         the upper hemisphere of the source axis, as for the response.
+//         Everything is drawn at the start of the event, and Geant4 seeds
+//         each event from the run's seed alone, so two configurations run
+//         with the same seed start from the same primaries event by event.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceFidelityActions__
+#define __RAT_CalibSourceFidelityActions__
+
+#include <RAT/CalibSourceFidelityRun.hh>
+
+#include <G4VUserPrimaryGeneratorAction.hh>
+#include <G4VUserActionInitialization.hh>
+#include <G4UserSteppingAction.hh>
+#include <G4UserEventAction.hh>
+#include <G4UserRunAction.hh>
+
+#include <string>
+
+class G4ParticleGun;
+class G4LogicalVolume;
+
+namespace RAT
+{
+
+  class CalibSourceFidelityEventAction : public G4UserEventAction
+  {
+  public:
+    CalibSourceFidelityEventAction() : fStartTime(0.) { };
+    virtual void BeginOfEventAction(const G4Event *event);
+    virtual void EndOfEventAction(const G4Event *event);
+    CalibSourceFidelityEvent& GetRecord() { return fRecord; };
+  protected:
+    // CPU time of this thread so far, in seconds
+    static double ThreadTime();
+
+    CalibSourceFidelityEvent fRecord;
+    double fStartTime;
+  };
+
+  class CalibSourceFidelityGenerator : public G4VUserPrimaryGeneratorAction
+  {
+  public:
+    CalibSourceFidelityGenerator(const CalibSourceFidelitySettings &settings);
+    virtual ~CalibSourceFidelityGenerator();
+    virtual void GeneratePrimaries(G4Event *event);
+  protected:
+    // Kinetic energy of a beta, drawn from the allowed shape
+    double BetaEnergy() const;
+    // Relative number of betas with kinetic energy T, without the Fermi
+    // function
+    double BetaShape(const double T) const;
+
+    const CalibSourceFidelitySettings &fSettings;
+    G4ParticleGun *fGun;
+    double fBetaShapeMax;
+  };
+
+  class CalibSourceFidelityStepping : public G4UserSteppingAction
+  {
+  public:
+    CalibSourceFidelityStepping(const std::string &index,
+                                CalibSourceFidelityEventAction *eventAction)
+      : fIndex(index), fEventAction(eventAction), fWorld(NULL), fScintillator(NULL) { };
+    virtual void UserSteppingAction(const G4Step *step);
+  protected:
+    std::string fIndex;
+    CalibSourceFidelityEventAction *fEventAction;
+    // Looked up on the first step, once the geometry exists
+    G4LogicalVolume *fWorld;
+    G4LogicalVolume *fScintillator;
+  };
+
+  class CalibSourceFidelityRunAction : public G4UserRunAction
+  {
+  public:
+    CalibSourceFidelityRunAction(const CalibSourceFidelitySettings &settings)
+      : fSettings(settings) { };
+    virtual G4Run* GenerateRun();
+    virtual void EndOfRunAction(const G4Run *run);
+  protected:
+    const CalibSourceFidelitySettings &fSettings;
+  };
+
+  class CalibSourceFidelityActionInitialization : public G4VUserActionInitialization
+  {
+  public:
+    CalibSourceFidelityActionInitialization(const CalibSourceFidelitySettings &settings)
+      : fSettings(settings) { };
+    virtual void Build() const;
+    virtual void BuildForMaster() const;
+  protected:
+    const CalibSourceFidelitySettings &fSettings;
+  };
+
+} // namespace RAT
+
+#endif
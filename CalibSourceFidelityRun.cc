@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceFidelityRun.hh>
+
+#include <RAT/Log.hh>
+
+#include <G4ParticleDefinition.hh>
+#include <G4Gamma.hh>
+#include <G4Electron.hh>
+#include <G4Positron.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace RAT
+{
+  namespace
+  {
+    bool EarlierEvent(const CalibSourceFidelityEvent &a, const CalibSourceFidelityEvent &b)
+    {
+      return a.id < b.id;
+    }
+
+    const char* const kKindNames[] = { "gamma", "e-", "e+", "opticalphoton", "other" };
+  }
+
+  CalibSourceFidelityParticle::Kind CalibSourceFidelityParticle::GetKind(const G4ParticleDefinition *particle)
+  {
+    if(particle == G4Gamma::Definition())
+      return kGamma;
+    if(particle == G4Electron::Definition())
+      return kElectron;
+    if(particle == G4Positron::Definition())
+      return kPositron;
+    if(particle == G4OpticalPhoton::Definition())
+      return kOpticalPhoton;
+    return kOther;
+  } // GetKind
+
+  const char* CalibSourceFidelityParticle::GetKindName(const int kind)
+  {
+    return kind >= 0 && kind < kNKinds ? kKindNames[kind] : "unknown";
+  } // GetKindName
+
+  void CalibSourceFidelityRun::Merge(const G4Run *run)
+  {
+    const CalibSourceFidelityRun* workerRun = static_cast<const CalibSourceFidelityRun*>(run);
+    fEvents.insert(fEvents.end(),workerRun->fEvents.begin(),workerRun->fEvents.end());
+    G4Run::Merge(run);
+  } // Merge
+
+  void CalibSourceFidelityRun::Write() const
+  {
+    std::vector<CalibSourceFidelityEvent> events(fEvents);
+    std::sort(events.begin(),events.end(),EarlierEvent);
+
+    std::ofstream out(fSettings.outputFile.c_str());
+    Log::Assert(out.good(),"CalibSourceFidelityRun: Cannot write " + fSettings.outputFile + ".");
+    out << std::setprecision(9)
+        << "calib_source_fidelity 1\n"
+        << "index " << fSettings.source.index << "\n"
+        << "detail_level " << fSettings.detailLevel << "\n"
+        << "geometry_hash " << fSettings.source.geometryHash << "\n"
+        << "tag_threshold " << fSettings.tagThreshold/CLHEP::MeV << "\n"
+        << "events " << events.size() << "\n";
+    for(size_t i=0; i<events.size(); i++){
+      const CalibSourceFidelityEvent &event = events[i];
+      out << event.id << " " << event.tagEnergy/CLHEP::MeV << " " << event.cpuTime << " " << event.escaped.size();
+      for(size_t j=0; j<event.escaped.size(); j++)
+        out << " " << event.escaped[j].kind << " " << event.escaped[j].energy/CLHEP::MeV
+            << " " << event.escaped[j].time/CLHEP::ns;
+      out << "\n";
+    }
+    Log::Assert(out.good(),"CalibSourceFidelityRun: Cannot write " + fSettings.outputFile + ".");
+    info << "CalibSourceFidelityRun: Wrote " << events.size() << " events of " << fSettings.source.index
+         << " at " << fSettings.detailLevel << " detail to " << fSettings.outputFile << newline;
+  } // Write
+
+  bool CalibSourceFidelityRun::Read(const std::string &path, CalibSourceFidelitySample &sample)
+  {
+    std::ifstream in(path.c_str());
+    std::string format, field;
+    int version = 0;
+    size_t nEvents = 0;
+    in >> format >> version
+       >> field >> sample.index
+       >> field >> sample.detailLevel
+       >> field >> sample.geometryHash
+       >> field >> sample.tagThreshold
+       >> field >> nEvents;
+    if(!in || format != "calib_source_fidelity" || version != 1)
+      return false;
+    sample.tagThreshold *= CLHEP::MeV;
+
+    sample.events.assign(nEvents,CalibSourceFidelityEvent());
+    for(size_t i=0; i<nEvents; i++){
+      CalibSourceFidelityEvent &event = sample.events[i];
+      size_t nEscaped = 0;
+      in >> event.id >> event.tagEnergy >> event.cpuTime >> nEscaped;
+      event.tagEnergy *= CLHEP::MeV;
+      event.escaped.resize(in ? nEscaped : 0);
+      for(size_t j=0; j<event.escaped.size(); j++){
+        in >> event.escaped[j].kind >> event.escaped[j].energy >> event.escaped[j].time;
+        event.escaped[j].energy *= CLHEP::MeV;
+        event.escaped[j].time *= CLHEP::ns;
+      }
+      if(!in)
+        return false;
+    }
+    return true;
+  } // Read
+} // namespace RAT
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceFidelityRun
+//
+// \brief The events of a run of calib_source_fidelity, one geometry
+//        configuration of a source
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Each event is one decay of the isotope (or one LED photon), and
+//         its record holds the energy deposited in the scintillator, the
+//         CPU time the worker thread spent on it and every particle that
+//         left the source. Each worker thread fills its own run and the
+//         master merges them, then writes the events in order of their ID,
+//         so that the same event of two configurations can be compared:
+//
+//           calib_source_fidelity 1
+//           index <index>
+//           detail_level <level>
+//           geometry_hash <hash>
+//           tag_threshold <MeV>
+//           events <n>
+//           <id> <tag MeV> <cpu s> <n escaped> [<kind> <MeV> <ns>]...
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceFidelityRun__
+#define __RAT_CalibSourceFidelityRun__
+
+#include <RAT/CalibSourceResponseRun.hh>
+
+#include <G4Run.hh>
+
+#include <string>
+#include <vector>
+
+class G4ParticleDefinition;
+
+namespace RAT
+{
+
+  // What calib_source_fidelity runs, shared by all the threads of one
+  // configuration
+  struct CalibSourceFidelitySettings
+  {
+    // The source, and the origin, axis and geometry hash the detector
+    // construction fills in; optical mode is the UFO's LED
+    CalibSourceResponseSettings source;
+    std::string detailLevel;
+    std::string outputFile;
+    // Tagged: the end point of the isotope's beta and the gammas of the
+    // cascade that follows it
+    double betaEndPoint;
+    std::vector<double> gammaLines;
+    // Energy in the scintillator that tags the event
+    double tagThreshold;
+  };
+
+  // A particle leaving the source
+  struct CalibSourceFidelityParticle
+  {
+    enum Kind { kGamma, kElectron, kPositron, kOpticalPhoton, kOther, kNKinds };
+
+    static Kind GetKind(const G4ParticleDefinition *particle);
+    static const char* GetKindName(const int kind);
+
+    int kind;
+    double energy;
+    double time;
+  };
+
+  struct CalibSourceFidelityEvent
+  {
+    int id;
+    double tagEnergy;
+    // Of the worker thread, from the start to the end of the event
+    double cpuTime;
+    std::vector<CalibSourceFidelityParticle> escaped;
+  };
+
+  // The header and events of a file written by CalibSourceFidelityRun
+  struct CalibSourceFidelitySample
+  {
+    std::string index;
+    std::string detailLevel;
+    std::string geometryHash;
+    double tagThreshold;
+    std::vector<CalibSourceFidelityEvent> events;
+  };
+
+  class CalibSourceFidelityRun : public G4Run
+  {
+  public:
+    CalibSourceFidelityRun(const CalibSourceFidelitySettings &settings)
+      : fSettings(settings) { };
+
+    void Record(const CalibSourceFidelityEvent &event) { fEvents.push_back(event); };
+    virtual void Merge(const G4Run *run);
+    // Write the events to the settings' output file
+    void Write() const;
+    // Read a file written by Write; false if it cannot be read
+    static bool Read(const std::string &path, CalibSourceFidelitySample &sample);
+
+  protected:
+    const CalibSourceFidelitySettings &fSettings;
+    std::vector<CalibSourceFidelityEvent> fEvents;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,581 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceGeometryCache.hh>
+#include <RAT/CalibSourceSolid.hh>
+#include <RAT/CalibSourceHoleRing.hh>
+#include <RAT/CalibSourceSolidCache.hh>
+#include <RAT/BoltCircleParameterisation.hh>
+#include <RAT/CalibSourceRegistry.hh>
+
+#include <G4Material.hh>
+
+#include <G4ThreeVector.hh>
+#include <G4RotationMatrix.hh>
+#include <G4Transform3D.hh>
+
+#include <G4Box.hh>
+#include <G4Tubs.hh>
+#include <G4Cons.hh>
+#include <G4Polycone.hh>
+#include <G4UnionSolid.hh>
+#include <G4SubtractionSolid.hh>
+#include <G4IntersectionSolid.hh>
+#include <G4DisplacedSolid.hh>
+#include <G4MultiUnion.hh>
+#include <G4LogicalVolume.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4PVPlacement.hh>
+#include <G4PVParameterised.hh>
+#include <G4VisAttributes.hh>
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace RAT
+{
+  namespace
+  {
+    // Magic, then a word that reads differently on a machine of the other
+    // byte order
+    const char kMagic[8] = {'R','A','T','C','S','G','E','O'};
+    const uint32_t kByteOrder = 0x01020304;
+    // Raise whenever what Write stores, or how, changes
+    const uint32_t kFormatVersion = 2;
+
+    // Placed in the envelope itself, rather than in one of the volumes
+    const int32_t kEnvelope = -1;
+
+    // The exact volume kept on the solid, if it is a CalibSourceSolid
+    template<class Solid>
+    double AnalyticVolume(const G4VSolid *solid)
+    {
+      const CalibSourceSolid<Solid>* known = dynamic_cast<const CalibSourceSolid<Solid>*>(solid);
+      return known != NULL ? known->GetAnalyticVolume() : -1.;
+    }
+
+    template<class Solid>
+    G4VSolid* WithVolume(CalibSourceSolid<Solid> *solid, const double volume)
+    {
+      solid->SetCubicVolume(volume);
+      return solid;
+    }
+
+    // Values appended as they are in memory; counts and indices as 32 bit
+    // words, strings after their length
+    class Output
+    {
+    public:
+      void Put(const void *data, const size_t size) { fData.append(static_cast<const char*>(data),size); };
+      void Double(const double value) { Put(&value,sizeof(value)); };
+      void Int(const int32_t value) { Put(&value,sizeof(value)); };
+      void Index(const uint32_t value) { Put(&value,sizeof(value)); };
+      void String(const std::string &value) { Index(value.size()); Put(value.data(),value.size()); };
+      void Vector(const G4ThreeVector &value) { Double(value.x()); Double(value.y()); Double(value.z()); };
+      void Transform(const G4RotationMatrix &rotation, const G4ThreeVector &translation)
+      {
+        Vector(rotation.colX());
+        Vector(rotation.colY());
+        Vector(rotation.colZ());
+        Vector(translation);
+      };
+      const std::string& GetData() const { return fData; };
+    protected:
+      std::string fData;
+    };
+
+    // Reads them back, noting (rather than reading past) the end of the data
+    class Input
+    {
+    public:
+      Input(const std::string &data, const size_t start) : fData(data), fPosition(start), fOverrun(false) { };
+      void Take(void *value, const size_t size)
+      {
+        if(fOverrun || size > fData.size()-fPosition){
+          fOverrun = true;
+          memset(value,0,size);
+          return;
+        }
+        memcpy(value,fData.data()+fPosition,size);
+        fPosition += size;
+      };
+      double Double() { double value; Take(&value,sizeof(value)); return value; };
+      int32_t Int() { int32_t value; Take(&value,sizeof(value)); return value; };
+      uint32_t Index() { uint32_t value; Take(&value,sizeof(value)); return value; };
+      std::string String()
+      {
+        const uint32_t size = Index();
+        if(fOverrun || size > fData.size()-fPosition){
+          fOverrun = true;
+          return "";
+        }
+        fPosition += size;
+        return fData.substr(fPosition-size,size);
+      };
+      G4ThreeVector Vector()
+      {
+        const double x = Double();
+        const double y = Double();
+        return G4ThreeVector(x,y,Double());
+      };
+      G4Transform3D Transform()
+      {
+        const G4ThreeVector colX = Vector();
+        const G4ThreeVector colY = Vector();
+        const G4ThreeVector colZ = Vector();
+        return G4Transform3D(G4RotationMatrix(colX,colY,colZ),Vector());
+      };
+      // Every value read, and nothing left over
+      bool Complete() const { return !fOverrun && fPosition == fData.size(); };
+      bool Good() const { return !fOverrun; };
+    protected:
+      const std::string &fData;
+      size_t fPosition;
+      bool fOverrun;
+    };
+
+    struct SolidRecord
+    {
+      std::string type;
+      std::string name;
+      double volume;
+      std::vector<double> values;
+      std::vector<uint32_t> parts;
+      std::vector<G4Transform3D> transforms;
+    };
+
+    struct LogicalRecord
+    {
+      std::string name;
+      uint32_t solid;
+      std::string material;
+      bool invisible;
+      std::vector<std::string> notes;
+    };
+
+    struct PlacementRecord
+    {
+      bool boltCircle;
+      std::string name;
+      uint32_t logical;
+      int32_t mother;
+      int32_t copies;
+      G4Transform3D transform;
+    };
+
+    // Store the solid after the solids it is made of, once; false if it is
+    // of a type that cannot be stored
+    bool AddSolid(const G4VSolid *solid, Output &output, std::map<const G4VSolid*, uint32_t> &indices)
+    {
+      if(indices.find(solid) != indices.end())
+        return true;
+
+      const G4String type = solid->GetEntityType();
+      Output record;
+      record.String(type);
+      record.String(solid->GetName());
+      if(type == "G4Box"){
+        const G4Box* box = static_cast<const G4Box*>(solid);
+        record.Double(AnalyticVolume<G4Box>(solid));
+        record.Double(box->GetXHalfLength());
+        record.Double(box->GetYHalfLength());
+        record.Double(box->GetZHalfLength());
+      }
+      else if(type == "G4Tubs"){
+        const G4Tubs* tubs = static_cast<const G4Tubs*>(solid);
+        record.Double(AnalyticVolume<G4Tubs>(solid));
+        record.Double(tubs->GetInnerRadius());
+        record.Double(tubs->GetOuterRadius());
+        record.Double(tubs->GetZHalfLength());
+        record.Double(tubs->GetStartPhiAngle());
+        record.Double(tubs->GetDeltaPhiAngle());
+      }
+      else if(type == "G4Cons"){
+        const G4Cons* cons = static_cast<const G4Cons*>(solid);
+        record.Double(AnalyticVolume<G4Cons>(solid));
+        record.Double(cons->GetInnerRadiusMinusZ());
+        record.Double(cons->GetOuterRadiusMinusZ());
+        record.Double(cons->GetInnerRadiusPlusZ());
+        record.Double(cons->GetOuterRadiusPlusZ());
+        record.Double(cons->GetZHalfLength());
+        record.Double(cons->GetStartPhiAngle());
+        record.Double(cons->GetDeltaPhiAngle());
+      }
+      else if(type == "G4Polycone"){
+        const G4PolyconeHistorical* original = static_cast<const G4Polycone*>(solid)->GetOriginalParameters();
+        record.Double(AnalyticVolume<G4Polycone>(solid));
+        record.Double(original->Start_angle);
+        record.Double(original->Opening_angle);
+        record.Index(original->Num_z_planes);
+        for(int i=0; i<original->Num_z_planes; i++){
+          record.Double(original->Z_values[i]);
+          record.Double(original->Rmin[i]);
+          record.Double(original->Rmax[i]);
+        }
+      }
+      else if(type == "CalibSourceHoleRing"){
+        // Works out its own volume
+        const CalibSourceHoleRing* ring = static_cast<const CalibSourceHoleRing*>(solid);
+        record.Double(-1.);
+        record.Index(ring->GetNHoles());
+        record.Double(ring->GetHoleRadius());
+        record.Double(ring->GetZHalfLength());
+        record.Double(ring->GetDistance());
+        record.Double(ring->GetFirstAngle());
+      }
+      else if(type == "G4UnionSolid" || type == "G4SubtractionSolid" || type == "G4IntersectionSolid"){
+        // A displaced second part is stored as a displaced solid
+        for(int i=0; i<2; i++)
+          if(!AddSolid(solid->GetConstituentSolid(i),output,indices))
+            return false;
+        double volume = AnalyticVolume<G4UnionSolid>(solid);
+        if(type == "G4SubtractionSolid")
+          volume = AnalyticVolume<G4SubtractionSolid>(solid);
+        else if(type == "G4IntersectionSolid")
+          volume = AnalyticVolume<G4IntersectionSolid>(solid);
+        record.Double(volume);
+        record.Index(indices[solid->GetConstituentSolid(0)]);
+        record.Index(indices[solid->GetConstituentSolid(1)]);
+      }
+      else if(type == "G4DisplacedSolid"){
+        const G4DisplacedSolid* displaced = static_cast<const G4DisplacedSolid*>(solid);
+        if(!AddSolid(displaced->GetConstituentMovedSolid(),output,indices))
+          return false;
+        record.Double(AnalyticVolume<G4DisplacedSolid>(solid));
+        record.Index(indices[displaced->GetConstituentMovedSolid()]);
+        record.Transform(displaced->GetObjectRotation(),displaced->GetObjectTranslation());
+      }
+      else if(type == "G4MultiUnion"){
+        const G4MultiUnion* multiUnion = static_cast<const G4MultiUnion*>(solid);
+        for(int i=0; i<multiUnion->GetNumberOfSolids(); i++)
+          if(!AddSolid(multiUnion->GetSolid(i),output,indices))
+            return false;
+        record.Double(AnalyticVolume<G4MultiUnion>(solid));
+        record.Index(multiUnion->GetNumberOfSolids());
+        for(int i=0; i<multiUnion->GetNumberOfSolids(); i++){
+          const G4Transform3D &transform = multiUnion->GetTransformation(i);
+          record.Index(indices[multiUnion->GetSolid(i)]);
+          record.Transform(transform.getRotation(),transform.getTranslation());
+        }
+      }
+      else
+        return false;
+
+      const uint32_t index = indices.size();
+      indices[solid] = index;
+      output.Put(record.GetData().data(),record.GetData().size());
+      return true;
+    }
+
+    // The dimensions of a solid, in the order AddSolid stores them
+    bool ReadSolid(Input &input, const uint32_t nRead, SolidRecord &record)
+    {
+      record.type = input.String();
+      record.name = input.String();
+      record.volume = input.Double();
+      size_t nValues = 0;
+      if(record.type == "G4Box")
+        nValues = 3;
+      else if(record.type == "G4Tubs")
+        nValues = 5;
+      else if(record.type == "G4Cons")
+        nValues = 7;
+      else if(record.type == "G4Polycone"){
+        record.values.push_back(input.Double());
+        record.values.push_back(input.Double());
+        const uint32_t nPlanes = input.Index();
+        if(nPlanes < 2)
+          return false;
+        nValues = 3*static_cast<size_t>(nPlanes);
+      }
+      else if(record.type == "CalibSourceHoleRing"){
+        const uint32_t nHoles = input.Index();
+        if(nHoles == 0)
+          return false;
+        record.values.push_back(nHoles);
+        nValues = 4;
+      }
+      else if(record.type == "G4UnionSolid" || record.type == "G4SubtractionSolid" ||
+              record.type == "G4IntersectionSolid"){
+        record.parts.push_back(input.Index());
+        record.parts.push_back(input.Index());
+      }
+      else if(record.type == "G4DisplacedSolid"){
+        record.parts.push_back(input.Index());
+        record.transforms.push_back(input.Transform());
+      }
+      else if(record.type == "G4MultiUnion"){
+        const uint32_t nParts = input.Index();
+        if(nParts == 0)
+          return false;
+        for(uint32_t i=0; i<nParts && input.Good(); i++){
+          record.parts.push_back(input.Index());
+          record.transforms.push_back(input.Transform());
+        }
+      }
+      else
+        return false;
+      for(size_t i=0; i<nValues && input.Good(); i++)
+        record.values.push_back(input.Double());
+      // The ring would refuse holes that touch
+      if(record.type == "CalibSourceHoleRing" && input.Good()){
+        const std::vector<double> &v = record.values;
+        if(!(v[1] > 0. && v[2] > 0. && v[3] >= 0. && (v[0] == 1. || v[3]*std::sin(CLHEP::pi/v[0]) > v[1])))
+          return false;
+      }
+      // Parts always come first
+      for(size_t i=0; i<record.parts.size(); i++)
+        if(record.parts[i] >= nRead)
+          return false;
+      return input.Good();
+    }
+
+    G4VSolid* BuildSolid(const SolidRecord &record, const std::vector<G4VSolid*> &solids)
+    {
+      const std::vector<double> &v = record.values;
+      if(record.type == "G4Box")
+        return CalibSourceSolidCache::Box(record.name,v[0],v[1],v[2]);
+      if(record.type == "G4Tubs")
+        return CalibSourceSolidCache::Tubs(record.name,v[0],v[1],v[2],v[3],v[4]);
+      if(record.type == "G4Cons")
+        return CalibSourceSolidCache::Cons(record.name,v[0],v[1],v[2],v[3],v[4],v[5],v[6]);
+      if(record.type == "G4Polycone"){
+        const size_t nPlanes = (v.size()-2)/3;
+        std::vector<double> zPlanes(nPlanes), rInner(nPlanes), rOuter(nPlanes);
+        for(size_t i=0; i<nPlanes; i++){
+          zPlanes[i] = v[2+3*i];
+          rInner[i] = v[3+3*i];
+          rOuter[i] = v[4+3*i];
+        }
+        return WithVolume(new CalibSourceSolid<G4Polycone>(record.name,v[0],v[1],nPlanes,
+                                                           &zPlanes[0],&rInner[0],&rOuter[0]),record.volume);
+      }
+      if(record.type == "CalibSourceHoleRing")
+        return CalibSourceSolidCache::HoleRing(record.name,static_cast<int>(v[0]),v[1],v[2],v[3],v[4]);
+      G4VSolid* first = solids[record.parts[0]];
+      if(record.type == "G4UnionSolid")
+        return WithVolume(new CalibSourceSolid<G4UnionSolid>(record.name,first,solids[record.parts[1]]),
+                          record.volume);
+      if(record.type == "G4SubtractionSolid")
+        return WithVolume(new CalibSourceSolid<G4SubtractionSolid>(record.name,first,solids[record.parts[1]]),
+                          record.volume);
+      if(record.type == "G4IntersectionSolid")
+        return WithVolume(new CalibSourceSolid<G4IntersectionSolid>(record.name,first,solids[record.parts[1]]),
+                          record.volume);
+      if(record.type == "G4DisplacedSolid")
+        return WithVolume(new CalibSourceSolid<G4DisplacedSolid>(record.name,first,record.transforms[0]),
+                          record.volume);
+      CalibSourceSolid<G4MultiUnion>* multiUnion = new CalibSourceSolid<G4MultiUnion>(record.name);
+      for(size_t i=0; i<record.parts.size(); i++)
+        multiUnion->AddNode(*solids[record.parts[i]],record.transforms[i]);
+      multiUnion->Voxelize();
+      return WithVolume(multiUnion,record.volume);
+    }
+  }
+
+  CalibSourceGeometryCache::CalibSourceGeometryCache(const std::string &directory, const std::string &index,
+                                                     const std::string &geometryHash,
+                                                     const std::string &factoryVersion)
+    : fHash(geometryHash), fFactoryVersion(factoryVersion)
+  {
+    std::ostringstream path;
+    path << directory << "/" << index << "_" << geometryHash << "_f" << kFormatVersion
+         << "_" << factoryVersion << ".bin";
+    fPath = path.str();
+  }
+
+  std::string CalibSourceGeometryCache::GetHeader() const
+  {
+    Output header;
+    header.Put(kMagic,sizeof(kMagic));
+    header.Put(&kByteOrder,sizeof(kByteOrder));
+    header.Index(kFormatVersion);
+    header.String(fFactoryVersion);
+    header.String(fHash);
+    return header.GetData();
+  } // GetHeader
+
+  bool CalibSourceGeometryCache::Write(const G4LogicalVolume *envelopeLog, const Notes &notes) const
+  {
+    // Every volume in the envelope, in the order they are met going down
+    // the tree, and every placement in each
+    std::vector<const G4LogicalVolume*> logicals;
+    std::map<const G4LogicalVolume*, uint32_t> logicalIndices;
+    Output placements;
+    uint32_t nPlacements = 0;
+    for(int32_t mother=kEnvelope; mother<static_cast<int32_t>(logicals.size()); mother++){
+      const G4LogicalVolume* motherLog = mother == kEnvelope ? envelopeLog : logicals[mother];
+      for(size_t i=0; i<motherLog->GetNoDaughters(); i++){
+        const G4VPhysicalVolume* daughter = motherLog->GetDaughter(i);
+        const G4LogicalVolume* logical = daughter->GetLogicalVolume();
+        if(logicalIndices.find(logical) == logicalIndices.end()){
+          logicalIndices[logical] = logicals.size();
+          logicals.push_back(logical);
+        }
+        const BoltCircleParameterisation* boltCircle =
+          dynamic_cast<const BoltCircleParameterisation*>(daughter->GetParameterisation());
+        if(daughter->IsParameterised() && boltCircle == NULL)
+          return false;
+        if(daughter->IsReplicated() && !daughter->IsParameterised())
+          return false;
+        placements.Int(boltCircle != NULL);
+        placements.String(daughter->GetName());
+        placements.Index(logicalIndices[logical]);
+        placements.Int(mother);
+        if(boltCircle != NULL){
+          placements.Int(boltCircle->GetNCopies());
+          placements.Transform(G4RotationMatrix(),boltCircle->GetFirstPosition());
+        }
+        else{
+          placements.Int(daughter->GetCopyNo());
+          placements.Transform(daughter->GetObjectRotationValue(),daughter->GetObjectTranslation());
+        }
+        nPlacements++;
+      }
+    }
+
+    Output solids;
+    std::map<const G4VSolid*, uint32_t> solidIndices;
+    for(size_t i=0; i<logicals.size(); i++)
+      if(!AddSolid(logicals[i]->GetSolid(),solids,solidIndices))
+        return false;
+
+    Output output;
+    const std::string header = GetHeader();
+    output.Put(header.data(),header.size());
+    output.Index(solidIndices.size());
+    output.Put(solids.GetData().data(),solids.GetData().size());
+    output.Index(logicals.size());
+    for(size_t i=0; i<logicals.size(); i++){
+      const G4LogicalVolume* logical = logicals[i];
+      output.String(logical->GetName());
+      output.Index(solidIndices[logical->GetSolid()]);
+      output.String(logical->GetMaterial()->GetName());
+      const G4VisAttributes* vis = logical->GetVisAttributes();
+      output.Int(vis != NULL && !vis->IsVisible());
+      Notes::const_iterator found = notes.find(logical);
+      const std::vector<std::string> none;
+      const std::vector<std::string> &logicalNotes = found != notes.end() ? found->second : none;
+      output.Index(logicalNotes.size());
+      for(size_t j=0; j<logicalNotes.size(); j++)
+        output.String(logicalNotes[j]);
+    }
+    output.Index(nPlacements);
+    output.Put(placements.GetData().data(),placements.GetData().size());
+
+    // Write to a name of our own and move it into place, so that another
+    // job never reads half a file
+    mkdir(fPath.substr(0,fPath.rfind('/')).c_str(),0777);
+    std::ostringstream temporary;
+    temporary << fPath << ".tmp" << getpid();
+    {
+      std::ofstream file(temporary.str().c_str(),std::ios::binary | std::ios::trunc);
+      if(!file.write(output.GetData().data(),output.GetData().size()) || !file.flush()){
+        file.close();
+        remove(temporary.str().c_str());
+        return false;
+      }
+    }
+    if(rename(temporary.str().c_str(),fPath.c_str()) != 0){
+      remove(temporary.str().c_str());
+      return false;
+    }
+    return true;
+  } // Write
+
+  bool CalibSourceGeometryCache::Read(G4LogicalVolume *envelopeLog, Notes &notes,
+                                      std::vector<G4VPhysicalVolume*> &placements) const
+  {
+    std::ifstream file(fPath.c_str(),std::ios::binary);
+    if(!file)
+      return false;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    const std::string data = contents.str();
+    // Anything written in another format, by another version of the
+    // factory or for other parameters is rejected, and built again
+    const std::string header = GetHeader();
+    if(data.compare(0,header.size(),header) != 0)
+      return false;
+
+    // Read everything, and find the materials, before creating anything
+    Input input(data,header.size());
+    std::vector<SolidRecord> solidRecords(input.Index());
+    if(!input.Good() || solidRecords.size() > data.size())
+      return false;
+    for(uint32_t i=0; i<solidRecords.size(); i++)
+      if(!ReadSolid(input,i,solidRecords[i]))
+        return false;
+
+    std::vector<LogicalRecord> logicalRecords(input.Index());
+    if(!input.Good() || logicalRecords.size() > data.size())
+      return false;
+    std::vector<G4Material*> materials;
+    for(size_t i=0; i<logicalRecords.size(); i++){
+      LogicalRecord &record = logicalRecords[i];
+      record.name = input.String();
+      record.solid = input.Index();
+      record.material = input.String();
+      record.invisible = input.Int() != 0;
+      record.notes.resize(std::min<size_t>(input.Index(),data.size()));
+      for(size_t j=0; j<record.notes.size(); j++)
+        record.notes[j] = input.String();
+      materials.push_back(CalibSourceRegistry::FindMaterial(record.material));
+      if(!input.Good() || record.solid >= solidRecords.size() || materials.back() == NULL)
+        return false;
+    }
+
+    std::vector<PlacementRecord> placementRecords(input.Index());
+    if(!input.Good() || placementRecords.size() > data.size())
+      return false;
+    for(size_t i=0; i<placementRecords.size(); i++){
+      PlacementRecord &record = placementRecords[i];
+      record.boltCircle = input.Int() != 0;
+      record.name = input.String();
+      record.logical = input.Index();
+      record.mother = input.Int();
+      record.copies = input.Int();
+      record.transform = input.Transform();
+      if(!input.Good() || record.logical >= logicalRecords.size() || record.mother < kEnvelope ||
+         record.mother >= static_cast<int32_t>(logicalRecords.size()) || (record.boltCircle && record.copies <= 0))
+        return false;
+    }
+    if(!input.Complete())
+      return false;
+
+    std::vector<G4VSolid*> solids;
+    for(size_t i=0; i<solidRecords.size(); i++)
+      solids.push_back(BuildSolid(solidRecords[i],solids));
+
+    std::vector<G4LogicalVolume*> logicals;
+    for(size_t i=0; i<logicalRecords.size(); i++){
+      const LogicalRecord &record = logicalRecords[i];
+      G4LogicalVolume* logical = new G4LogicalVolume(solids[record.solid],materials[i],record.name);
+      if(record.invisible)
+        logical->SetVisAttributes(G4VisAttributes::Invisible);
+      if(!record.notes.empty())
+        notes[logical] = record.notes;
+      logicals.push_back(logical);
+    }
+
+    for(size_t i=0; i<placementRecords.size(); i++){
+      const PlacementRecord &record = placementRecords[i];
+      G4LogicalVolume* motherLog = record.mother == kEnvelope ? envelopeLog : logicals[record.mother];
+      if(record.boltCircle)
+        new G4PVParameterised(record.name,logicals[record.logical],motherLog,kUndefined,record.copies,
+                              new BoltCircleParameterisation(record.copies,record.transform.getTranslation()));
+      else
+        placements.push_back(new G4PVPlacement(record.transform,logicals[record.logical],record.name,
+                                               motherLog,false,record.copies,false));
+    }
+    return true;
+  } // Read
+} // namespace RAT
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceGeometryCache
+//
+// \brief The built parts of a calibration source, stored in a file
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Write stores everything inside a source's envelope: each solid
+//         once with its dimensions (and its exact volume, see
+//         CalibSourceSolid), each logical volume with its solid, the name
+//         of its material and the notes the factory keeps on it, and each
+//         placement or bolt circle. Read rebuilds them in an empty envelope
+//         without any of the boolean construction, volume calculations or
+//         lookups of the factory, sharing solids just as the original did.
+//         Materials are found by name, so the detector's own materials
+//         (and their optical properties) are used.
+//
+//         The file is <directory>/<index>_<hash>_f<format>_<version>.bin,
+//         where the hash is that of the parameters
+//         (CalibSourceParams::GetHash, including the sensitive detector
+//         settings), the format is the version of this file layout and the
+//         version is that of the factory that built the parts (see
+//         GeoCalibSourceFactory::GetGeometryVersion). All three are checked
+//         again in the header, and a file that differs in any of them is
+//         never read: the source is built in full and stored anew.
+//
+//         Only the solids and volumes the calibration factories use can be
+//         stored: boxes, tubes, cones, polycones, hole rings, boolean,
+//         displaced and multi-union solids, placements and
+//         BoltCircleParameterisation.
+//         Write fails for anything else, and the source is then built in
+//         full every time.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceGeometryCache__
+#define __RAT_CalibSourceGeometryCache__
+
+#include <string>
+#include <vector>
+#include <map>
+
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+
+namespace RAT
+{
+
+  class CalibSourceGeometryCache
+  {
+  public:
+    // What the factory notes on a logical volume (its colour field, its
+    // sensitive detector), to act on again when it is read back
+    typedef std::map<const G4LogicalVolume*, std::vector<std::string> > Notes;
+
+    CalibSourceGeometryCache(const std::string &directory, const std::string &index,
+                             const std::string &geometryHash, const std::string &factoryVersion);
+
+    // Store everything inside envelopeLog; false if a part cannot be
+    // stored or the file cannot be written
+    bool Write(const G4LogicalVolume *envelopeLog, const Notes &notes) const;
+    // Rebuild the parts in the empty envelopeLog, adding every placement
+    // made to placements; false, creating nothing, if there is no file for
+    // these parameters and this version of the factory, or a material it
+    // names does not exist
+    bool Read(G4LogicalVolume *envelopeLog, Notes &notes,
+              std::vector<G4VPhysicalVolume*> &placements) const;
+
+    const std::string& GetPath() const { return fPath; };
+
+  protected:
+    // Format, factory version and parameter hash, as the file starts
+    std::string GetHeader() const;
+
+    std::string fHash;
+    std::string fFactoryVersion;
+    std::string fPath;
+  };
+
+} // namespace RAT
+
+#endif
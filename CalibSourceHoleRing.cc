@@ -0,0 +1,333 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceHoleRing.hh>
+
+#include <RAT/Log.hh>
+#include <RAT/string_utilities.hpp>
+
+#include <G4AffineTransform.hh>
+#include <G4VoxelLimits.hh>
+#include <G4BoundingEnvelope.hh>
+#include <G4VGraphicsScene.hh>
+#include <G4Polyhedron.hh>
+#include <G4RotationMatrix.hh>
+#include <G4Transform3D.hh>
+#include <Randomize.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace RAT
+{
+  CalibSourceHoleRing::CalibSourceHoleRing(const G4String &name,
+                                           const int nHoles,
+                                           const double holeRadius,
+                                           const double halfLength,
+                                           const double distance,
+                                           const double firstAngle)
+    : G4CSGSolid(name), fNHoles(nHoles), fHoleRadius(holeRadius), fHalfLength(halfLength),
+      fDistance(distance), fFirstAngle(firstAngle), fStep(CLHEP::twopi/nHoles)
+  {
+    Log::Assert(nHoles > 0 && holeRadius > 0. && halfLength > 0. && distance >= 0.,
+                "CalibSourceHoleRing: " + name + " needs holes of positive size.");
+    Log::Assert(nHoles == 1 || distance*std::sin(CLHEP::pi/nHoles) > holeRadius,
+                "CalibSourceHoleRing: The " + to_string(nHoles) + " holes of " + name + " touch.");
+    for(int i=0; i<nHoles; i++){
+      fCos.push_back(std::cos(firstAngle+i*fStep));
+      fSin.push_back(std::sin(firstAngle+i*fStep));
+    }
+  }
+
+  G4ThreeVector CalibSourceHoleRing::GetHolePosition(const int hole) const
+  {
+    return G4ThreeVector(fDistance*fCos[hole],fDistance*fSin[hole],0.);
+  } // GetHolePosition
+
+  int CalibSourceHoleRing::Sector(const G4ThreeVector &p) const
+  {
+    if(fNHoles == 1)
+      return 0;
+    const int sector = static_cast<int>(std::floor((std::atan2(p.y(),p.x())-fFirstAngle)/fStep+0.5)) % fNHoles;
+    return sector < 0 ? sector+fNHoles : sector;
+  } // Sector
+
+  G4ThreeVector CalibSourceHoleRing::ToHole(const int hole, const G4ThreeVector &p) const
+  {
+    return G4ThreeVector(fCos[hole]*p.x()+fSin[hole]*p.y()-fDistance,-fSin[hole]*p.x()+fCos[hole]*p.y(),p.z());
+  } // ToHole
+
+  G4ThreeVector CalibSourceHoleRing::AlongHole(const int hole, const G4ThreeVector &v) const
+  {
+    return G4ThreeVector(fCos[hole]*v.x()+fSin[hole]*v.y(),-fSin[hole]*v.x()+fCos[hole]*v.y(),v.z());
+  } // AlongHole
+
+  G4ThreeVector CalibSourceHoleRing::FromHole(const int hole, const G4ThreeVector &v) const
+  {
+    return G4ThreeVector(fCos[hole]*v.x()-fSin[hole]*v.y(),fSin[hole]*v.x()+fCos[hole]*v.y(),v.z());
+  } // FromHole
+
+  EInside CalibSourceHoleRing::Inside(const G4ThreeVector &p) const
+  {
+    const double halfTolerance = 0.5*kCarTolerance;
+    const G4ThreeVector q = ToHole(Sector(p),p);
+    const double rho = q.perp();
+    const double z = std::fabs(q.z());
+    if(rho > fHoleRadius+halfTolerance || z > fHalfLength+halfTolerance)
+      return kOutside;
+    if(rho < fHoleRadius-halfTolerance && z < fHalfLength-halfTolerance)
+      return kInside;
+    return kSurface;
+  } // Inside
+
+  G4ThreeVector CalibSourceHoleRing::SurfaceNormal(const G4ThreeVector &p) const
+  {
+    const double halfTolerance = 0.5*kCarTolerance;
+    const int hole = Sector(p);
+    const G4ThreeVector q = ToHole(hole,p);
+    const double rho = q.perp();
+    const double sideDistance = std::fabs(rho-fHoleRadius);
+    const double endDistance = std::fabs(std::fabs(q.z())-fHalfLength);
+    const G4ThreeVector side = rho > 0. ? G4ThreeVector(q.x()/rho,q.y()/rho,0.) : G4ThreeVector(1.,0.,0.);
+    const G4ThreeVector end(0.,0.,q.z() >= 0. ? 1. : -1.);
+    // On an edge the normal is between those of the two surfaces
+    if(sideDistance <= halfTolerance && endDistance <= halfTolerance)
+      return FromHole(hole,(side+end).unit());
+    return FromHole(hole,sideDistance < endDistance ? side : end);
+  } // SurfaceNormal
+
+  double CalibSourceHoleRing::HoleDistanceToIn(const G4ThreeVector &p, const G4ThreeVector &v) const
+  {
+    const double halfTolerance = 0.5*kCarTolerance;
+    // Through an end, from beyond it
+    if(std::fabs(p.z()) >= fHalfLength-halfTolerance && p.z()*v.z() < 0.){
+      const double t = std::max(0.,(std::fabs(p.z())-fHalfLength)/std::fabs(v.z()));
+      const double x = p.x()+t*v.x();
+      const double y = p.y()+t*v.y();
+      if(x*x+y*y <= (fHoleRadius+halfTolerance)*(fHoleRadius+halfTolerance))
+        return t;
+    }
+    // Through the side, from outside it and heading in
+    const double a = v.x()*v.x()+v.y()*v.y();
+    if(a <= 0.)
+      return kInfinity;
+    const double b = p.x()*v.x()+p.y()*v.y();
+    const double c = p.x()*p.x()+p.y()*p.y()-fHoleRadius*fHoleRadius;
+    if(c <= -kCarTolerance*fHoleRadius || b >= 0.)
+      return kInfinity;
+    const double discriminant = b*b-a*c;
+    if(discriminant < 0.)
+      return kInfinity;
+    const double t = std::max(0.,(-b-std::sqrt(discriminant))/a);
+    return std::fabs(p.z()+t*v.z()) <= fHalfLength+halfTolerance ? t : kInfinity;
+  } // HoleDistanceToIn
+
+  double CalibSourceHoleRing::RingDistanceToIn(const G4ThreeVector &p, const G4ThreeVector &v,
+                                               const double tMin, const double tMax) const
+  {
+    if(tMin > tMax)
+      return kInfinity;
+    // The holes are disjoint and each is inside its own sector, so the
+    // first hole hit is in the first sector that has one
+    const int last = Sector(p+tMax*v);
+    const int step = p.x()*v.y()-p.y()*v.x() >= 0. ? 1 : fNHoles-1;
+    int hole = Sector(p+tMin*v);
+    for(int i=0; i<fNHoles; i++){
+      const double t = HoleDistanceToIn(ToHole(hole,p),AlongHole(hole,v));
+      if(t < kInfinity)
+        return t;
+      if(hole == last)
+        break;
+      hole = (hole+step)%fNHoles;
+    }
+    return kInfinity;
+  } // RingDistanceToIn
+
+  double CalibSourceHoleRing::DistanceToIn(const G4ThreeVector &p, const G4ThreeVector &v) const
+  {
+    if(fNHoles == 1)
+      return HoleDistanceToIn(ToHole(0,p),AlongHole(0,v));
+
+    // Only the part of the ray between the end planes...
+    const double halfTolerance = 0.5*kCarTolerance;
+    double tMin = 0., tMax = kInfinity;
+    if(v.z() != 0.){
+      const double t0 = (-fHalfLength-halfTolerance-p.z())/v.z();
+      const double t1 = (fHalfLength+halfTolerance-p.z())/v.z();
+      tMin = std::max(tMin,std::min(t0,t1));
+      tMax = std::min(tMax,std::max(t0,t1));
+    }
+    else if(std::fabs(p.z()) > fHalfLength+halfTolerance)
+      return kInfinity;
+
+    // ...and inside the circle round the holes can reach them
+    const double outer = fDistance+fHoleRadius+halfTolerance;
+    const double a = v.x()*v.x()+v.y()*v.y();
+    if(a <= 0.)
+      return p.perp2() <= outer*outer && tMin <= tMax ? HoleDistanceToIn(ToHole(Sector(p),p),AlongHole(Sector(p),v)) : kInfinity;
+    const double b = p.x()*v.x()+p.y()*v.y();
+    const double outerDiscriminant = b*b-a*(p.perp2()-outer*outer);
+    if(outerDiscriminant <= 0.)
+      return kInfinity;
+    tMin = std::max(tMin,(-b-std::sqrt(outerDiscriminant))/a);
+    tMax = std::min(tMax,(-b+std::sqrt(outerDiscriminant))/a);
+    if(tMin > tMax)
+      return kInfinity;
+
+    // The circle inside the holes cuts the ray in two, and the holes near
+    // where it goes in are nearer than those near where it comes out
+    const double inner = fDistance-fHoleRadius-halfTolerance;
+    const double innerDiscriminant = b*b-a*(p.perp2()-inner*inner);
+    if(inner <= 0. || innerDiscriminant <= 0.)
+      return RingDistanceToIn(p,v,tMin,tMax);
+    const double tInnerIn = (-b-std::sqrt(innerDiscriminant))/a;
+    const double tInnerOut = (-b+std::sqrt(innerDiscriminant))/a;
+    const double t = RingDistanceToIn(p,v,tMin,std::min(tMax,tInnerIn));
+    if(t < kInfinity)
+      return t;
+    return RingDistanceToIn(p,v,std::max(tMin,tInnerOut),tMax);
+  } // DistanceToIn
+
+  double CalibSourceHoleRing::DistanceToIn(const G4ThreeVector &p) const
+  {
+    // The nearest axis is that of the hole in the same sector
+    const G4ThreeVector q = ToHole(Sector(p),p);
+    return std::max(0.,std::max(q.perp()-fHoleRadius,std::fabs(q.z())-fHalfLength));
+  } // DistanceToIn
+
+  double CalibSourceHoleRing::DistanceToOut(const G4ThreeVector &p, const G4ThreeVector &v,
+                                            const G4bool calcNorm, G4bool *validNorm,
+                                            G4ThreeVector *n) const
+  {
+    const int hole = Sector(p);
+    const G4ThreeVector q = ToHole(hole,p);
+    const G4ThreeVector w = AlongHole(hole,v);
+
+    // Through an end
+    double distance = kInfinity;
+    G4ThreeVector normal;
+    if(w.z() > 0.){
+      distance = std::max(0.,(fHalfLength-q.z())/w.z());
+      normal = G4ThreeVector(0.,0.,1.);
+    }
+    else if(w.z() < 0.){
+      distance = std::max(0.,(fHalfLength+q.z())/-w.z());
+      normal = G4ThreeVector(0.,0.,-1.);
+    }
+
+    // Through the side
+    const double a = w.x()*w.x()+w.y()*w.y();
+    if(a > 0.){
+      const double b = q.x()*w.x()+q.y()*w.y();
+      const double c = q.x()*q.x()+q.y()*q.y()-fHoleRadius*fHoleRadius;
+      double sideDistance = 0.;
+      if(c < -kCarTolerance*fHoleRadius || b < 0.)
+        sideDistance = std::max(0.,(-b+std::sqrt(std::max(0.,b*b-a*c)))/a);
+      if(sideDistance < distance){
+        distance = sideDistance;
+        const G4ThreeVector exit = q+distance*w;
+        normal = G4ThreeVector(exit.x(),exit.y(),0.).unit();
+      }
+    }
+
+    // Only a single hole lies wholly behind the surface it is left through
+    if(calcNorm){
+      *validNorm = fNHoles == 1;
+      *n = FromHole(hole,normal);
+    }
+    return distance;
+  } // DistanceToOut
+
+  double CalibSourceHoleRing::DistanceToOut(const G4ThreeVector &p) const
+  {
+    const G4ThreeVector q = ToHole(Sector(p),p);
+    return std::max(0.,std::min(fHoleRadius-q.perp(),fHalfLength-std::fabs(q.z())));
+  } // DistanceToOut
+
+  void CalibSourceHoleRing::BoundingLimits(G4ThreeVector &pMin, G4ThreeVector &pMax) const
+  {
+    // Each hole is inside the square round its circle
+    pMin.set(kInfinity,kInfinity,-fHalfLength);
+    pMax.set(-kInfinity,-kInfinity,fHalfLength);
+    for(int i=0; i<fNHoles; i++){
+      const G4ThreeVector position = GetHolePosition(i);
+      pMin.setX(std::min(pMin.x(),position.x()-fHoleRadius));
+      pMin.setY(std::min(pMin.y(),position.y()-fHoleRadius));
+      pMax.setX(std::max(pMax.x(),position.x()+fHoleRadius));
+      pMax.setY(std::max(pMax.y(),position.y()+fHoleRadius));
+    }
+  } // BoundingLimits
+
+  G4bool CalibSourceHoleRing::CalculateExtent(const EAxis pAxis, const G4VoxelLimits &pVoxelLimit,
+                                              const G4AffineTransform &pTransform,
+                                              G4double &pMin, G4double &pMax) const
+  {
+    G4ThreeVector boxMin, boxMax;
+    BoundingLimits(boxMin,boxMax);
+    G4BoundingEnvelope box(boxMin,boxMax);
+    return box.CalculateExtent(pAxis,pVoxelLimit,pTransform,pMin,pMax);
+  } // CalculateExtent
+
+  G4double CalibSourceHoleRing::GetCubicVolume()
+  {
+    return fNHoles*CLHEP::pi*fHoleRadius*fHoleRadius*2.*fHalfLength;
+  } // GetCubicVolume
+
+  G4double CalibSourceHoleRing::GetSurfaceArea()
+  {
+    return fNHoles*CLHEP::twopi*fHoleRadius*(2.*fHalfLength+fHoleRadius);
+  } // GetSurfaceArea
+
+  G4ThreeVector CalibSourceHoleRing::GetPointOnSurface() const
+  {
+    // Any hole, then its side or one of its ends by area
+    const int hole = std::min(fNHoles-1,static_cast<int>(fNHoles*G4UniformRand()));
+    const double sideArea = 2.*fHalfLength;
+    const double choice = (sideArea+fHoleRadius)*G4UniformRand();
+    const double phi = CLHEP::twopi*G4UniformRand();
+    G4ThreeVector point;
+    if(choice < sideArea)
+      point.set(fHoleRadius*std::cos(phi),fHoleRadius*std::sin(phi),fHalfLength*(2.*G4UniformRand()-1.));
+    else{
+      const double rho = fHoleRadius*std::sqrt(G4UniformRand());
+      point.set(rho*std::cos(phi),rho*std::sin(phi),choice < sideArea+fHoleRadius/2. ? fHalfLength : -fHalfLength);
+    }
+    return FromHole(hole,point)+GetHolePosition(hole);
+  } // GetPointOnSurface
+
+  std::ostream& CalibSourceHoleRing::StreamInfo(std::ostream &os) const
+  {
+    os << "-----------------------------------------------------------\n"
+       << "    *** Dump for solid - " << GetName() << " ***\n"
+       << "    ===================================================\n"
+       << " Solid type: CalibSourceHoleRing\n"
+       << " Parameters: \n"
+       << "   number of holes: " << fNHoles << "\n"
+       << "   hole radius: " << fHoleRadius/CLHEP::mm << " mm\n"
+       << "   half length in z: " << fHalfLength/CLHEP::mm << " mm\n"
+       << "   distance of axes: " << fDistance/CLHEP::mm << " mm\n"
+       << "   first hole at: " << fFirstAngle/CLHEP::deg << " degrees\n"
+       << "-----------------------------------------------------------\n";
+    return os;
+  } // StreamInfo
+
+  void CalibSourceHoleRing::DescribeYourselfTo(G4VGraphicsScene &scene) const
+  {
+    scene.AddSolid(*this);
+  } // DescribeYourselfTo
+
+  G4Polyhedron* CalibSourceHoleRing::CreatePolyhedron() const
+  {
+    G4Polyhedron* polyhedron = NULL;
+    for(int i=0; i<fNHoles; i++){
+      G4PolyhedronTubs hole(0.,fHoleRadius,fHalfLength,0.,CLHEP::twopi);
+      hole.Transform(G4Transform3D(G4RotationMatrix(),GetHolePosition(i)));
+      if(polyhedron == NULL)
+        polyhedron = new G4Polyhedron(hole);
+      else
+        *polyhedron = polyhedron->add(hole);
+    }
+    return polyhedron;
+  } // CreatePolyhedron
+} // namespace RAT
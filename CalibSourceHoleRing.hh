@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceHoleRing
+//
+// \brief A ring of identical cylindrical holes, as one solid
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version, for the screw holes of the sources. \n
+//
+//
+// \detail nHoles cylinders parallel to the z axis, equally spaced round
+//         it with their axes at distance from it, the first at firstAngle
+//         from the x axis. The factories take the whole ring out of a
+//         flange or disc with a single subtraction (or add it to a union),
+//         rather than one boolean or multi-union node per hole.
+//
+//         The holes may not touch, so each lies inside its own sector of
+//         2 pi / nHoles round the axis and the hole nearest any point is
+//         the one in the point's sector. Inside, the safeties and the
+//         normal fold the point into that sector and look at that one
+//         hole, whatever the number of holes. A ray is first clipped to
+//         the end planes and to the ring the holes lie in; the angle round
+//         the axis changes monotonically along each piece of it that is
+//         left, so DistanceToIn only looks at the holes of the sectors it
+//         passes through, nearest first, and stops at the first it hits.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceHoleRing__
+#define __RAT_CalibSourceHoleRing__
+
+#include <G4CSGSolid.hh>
+#include <G4ThreeVector.hh>
+
+#include <vector>
+
+namespace RAT
+{
+
+  class CalibSourceHoleRing : public G4CSGSolid
+  {
+  public:
+    CalibSourceHoleRing(const G4String &name,
+                        const int nHoles,
+                        const double holeRadius,
+                        const double halfLength,
+                        const double distance,
+                        const double firstAngle = 0.);
+    virtual ~CalibSourceHoleRing() { };
+
+    virtual EInside Inside(const G4ThreeVector &p) const;
+    virtual G4ThreeVector SurfaceNormal(const G4ThreeVector &p) const;
+    virtual G4double DistanceToIn(const G4ThreeVector &p, const G4ThreeVector &v) const;
+    virtual G4double DistanceToIn(const G4ThreeVector &p) const;
+    virtual G4double DistanceToOut(const G4ThreeVector &p, const G4ThreeVector &v,
+                                   const G4bool calcNorm = false,
+                                   G4bool *validNorm = 0, G4ThreeVector *n = 0) const;
+    virtual G4double DistanceToOut(const G4ThreeVector &p) const;
+
+    virtual void BoundingLimits(G4ThreeVector &pMin, G4ThreeVector &pMax) const;
+    virtual G4bool CalculateExtent(const EAxis pAxis, const G4VoxelLimits &pVoxelLimit,
+                                   const G4AffineTransform &pTransform,
+                                   G4double &pMin, G4double &pMax) const;
+    virtual G4double GetCubicVolume();
+    virtual G4double GetSurfaceArea();
+    virtual G4ThreeVector GetPointOnSurface() const;
+
+    virtual G4String GetEntityType() const { return "CalibSourceHoleRing"; };
+    virtual G4VSolid* Clone() const { return new CalibSourceHoleRing(*this); };
+    virtual std::ostream& StreamInfo(std::ostream &os) const;
+    virtual void DescribeYourselfTo(G4VGraphicsScene &scene) const;
+    virtual G4Polyhedron* CreatePolyhedron() const;
+
+    int GetNHoles() const { return fNHoles; };
+    double GetHoleRadius() const { return fHoleRadius; };
+    double GetZHalfLength() const { return fHalfLength; };
+    double GetDistance() const { return fDistance; };
+    double GetFirstAngle() const { return fFirstAngle; };
+    // The centre of hole i
+    G4ThreeVector GetHolePosition(const int hole) const;
+
+  protected:
+    // The hole whose sector p is in
+    int Sector(const G4ThreeVector &p) const;
+    // A point in the frame of the hole, with its axis on the z axis, and a
+    // direction in the same frame; and back again
+    G4ThreeVector ToHole(const int hole, const G4ThreeVector &p) const;
+    G4ThreeVector AlongHole(const int hole, const G4ThreeVector &v) const;
+    G4ThreeVector FromHole(const int hole, const G4ThreeVector &v) const;
+    // Distance along v from p (in the frame of the hole) into it
+    double HoleDistanceToIn(const G4ThreeVector &p, const G4ThreeVector &v) const;
+    // The first hole hit between tMin and tMax along a piece of a ray that
+    // stays clear of the axis, or kInfinity
+    double RingDistanceToIn(const G4ThreeVector &p, const G4ThreeVector &v,
+                            const double tMin, const double tMax) const;
+
+    int fNHoles;
+    double fHoleRadius;
+    double fHalfLength;
+    double fDistance;
+    double fFirstAngle;
+    double fStep;
+    // Direction of each hole from the axis
+    std::vector<double> fCos;
+    std::vector<double> fSin;
+  };
+
+} // namespace RAT
+
+#endif
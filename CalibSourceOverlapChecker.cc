@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceOverlapChecker.hh>
+
+#include <RAT/Log.hh>
+#include <RAT/string_utilities.hpp>
+
+#include <G4VSolid.hh>
+#include <G4LogicalVolume.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4RotationMatrix.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+#include <utility>
+
+namespace RAT
+{
+  namespace
+  {
+    // Axis-aligned box round a placed solid, in its mother's frame
+    void PlacedBounds(const G4VPhysicalVolume *placement, G4ThreeVector &low, G4ThreeVector &high)
+    {
+      G4ThreeVector pMin, pMax;
+      placement->GetLogicalVolume()->GetSolid()->BoundingLimits(pMin,pMax);
+      const G4RotationMatrix rotation = placement->GetObjectRotationValue();
+      const G4ThreeVector translation = placement->GetObjectTranslation();
+      for(int corner=0; corner<8; corner++){
+        const G4ThreeVector point = rotation*G4ThreeVector(corner & 1 ? pMax.x() : pMin.x(),
+                                                           corner & 2 ? pMax.y() : pMin.y(),
+                                                           corner & 4 ? pMax.z() : pMin.z())+translation;
+        if(corner == 0){
+          low = high = point;
+          continue;
+        }
+        low.set(std::min(low.x(),point.x()),std::min(low.y(),point.y()),std::min(low.z(),point.z()));
+        high.set(std::max(high.x(),point.x()),std::max(high.y(),point.y()),std::max(high.z(),point.z()));
+      }
+    }
+  }
+
+  CalibSourceOverlapChecker::Task
+  CalibSourceOverlapChecker::PrepareTask(G4VPhysicalVolume *placement) const
+  {
+    Task task;
+    task.placement = placement;
+    G4LogicalVolume* motherLog = placement->GetMotherLogical();
+
+    Neighbour mother = { NULL, true, 0, 0., G4ThreeVector() };
+    task.neighbours.push_back(mother);
+
+    // Only siblings whose boxes meet this one can overlap it
+    G4ThreeVector low, high;
+    PlacedBounds(placement,low,high);
+    for(size_t i=0; i<motherLog->GetNoDaughters(); i++){
+      G4VPhysicalVolume* sibling = motherLog->GetDaughter(i);
+      if(sibling == placement || sibling->IsReplicated())
+        continue;
+      G4ThreeVector siblingLow, siblingHigh;
+      PlacedBounds(sibling,siblingLow,siblingHigh);
+      if(siblingLow.x() > high.x()-fTolerance || siblingHigh.x() < low.x()+fTolerance ||
+         siblingLow.y() > high.y()-fTolerance || siblingHigh.y() < low.y()+fTolerance ||
+         siblingLow.z() > high.z()-fTolerance || siblingHigh.z() < low.z()+fTolerance)
+        continue;
+      Neighbour neighbour = { sibling, false, 0, 0., G4ThreeVector() };
+      task.neighbours.push_back(neighbour);
+    }
+
+    const G4VSolid* solid = placement->GetLogicalVolume()->GetSolid();
+    const G4RotationMatrix rotation = placement->GetObjectRotationValue();
+    const G4ThreeVector translation = placement->GetObjectTranslation();
+    task.points.reserve(fNPoints);
+    for(int i=0; i<fNPoints; i++)
+      task.points.push_back(rotation*solid->GetPointOnSurface()+translation);
+    return task;
+  } // PrepareTask
+
+  void CalibSourceOverlapChecker::RunTask(Task &task) const
+  {
+    const G4VSolid* motherSolid = task.placement->GetMotherLogical()->GetSolid();
+    for(size_t n=0; n<task.neighbours.size(); n++){
+      Neighbour &neighbour = task.neighbours[n];
+      const G4VSolid* solid = neighbour.isMother ? motherSolid :
+        neighbour.volume->GetLogicalVolume()->GetSolid();
+      // Points in the sibling's own frame
+      G4RotationMatrix inverseRotation;
+      G4ThreeVector translation;
+      if(!neighbour.isMother){
+        inverseRotation = neighbour.volume->GetObjectRotationValue().inverse();
+        translation = neighbour.volume->GetObjectTranslation();
+      }
+      for(size_t i=0; i<task.points.size(); i++){
+        double depth = 0.;
+        if(neighbour.isMother){
+          if(solid->Inside(task.points[i]) == kOutside)
+            depth = solid->DistanceToIn(task.points[i]);
+        }
+        else{
+          const G4ThreeVector local = inverseRotation*(task.points[i]-translation);
+          if(solid->Inside(local) == kInside)
+            depth = solid->DistanceToOut(local);
+        }
+        if(depth <= fTolerance)
+          continue;
+        neighbour.nPoints++;
+        if(depth > neighbour.depth){
+          neighbour.depth = depth;
+          neighbour.point = task.points[i];
+        }
+      }
+    }
+  } // RunTask
+
+  int CalibSourceOverlapChecker::Check(const std::vector<G4VPhysicalVolume*> &placements,
+                                       const std::string &title) const
+  {
+    if(placements.empty())
+      return 0;
+
+    std::vector<Task> tasks;
+    tasks.reserve(placements.size());
+    for(size_t i=0; i<placements.size(); i++)
+      tasks.push_back(PrepareTask(placements[i]));
+
+    // Hand out the placements to the threads one at a time
+    int nThreads = fNThreads > 0 ? fNThreads : static_cast<int>(std::thread::hardware_concurrency());
+    nThreads = std::max(1,std::min(nThreads,static_cast<int>(tasks.size())));
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for(int t=0; t<nThreads; t++)
+      threads.push_back(std::thread([this,&tasks,&next]() {
+            for(size_t i=next++; i<tasks.size(); i=next++)
+              RunTask(tasks[i]);
+          }));
+    for(size_t t=0; t<threads.size(); t++)
+      threads[t].join();
+
+    // Two siblings that overlap are each found inside the other, so keep
+    // each pair once, seen from the side it goes deeper (task, neighbour)
+    typedef std::pair<const G4VPhysicalVolume*, const G4VPhysicalVolume*> Pair;
+    std::map<Pair, size_t> pairs;
+    std::vector<std::pair<size_t, size_t> > overlaps;
+    for(size_t i=0; i<tasks.size(); i++){
+      for(size_t n=0; n<tasks[i].neighbours.size(); n++){
+        const Neighbour &neighbour = tasks[i].neighbours[n];
+        if(neighbour.nPoints == 0)
+          continue;
+        const G4VPhysicalVolume* placement = tasks[i].placement;
+        const Pair key = neighbour.isMother ? Pair(placement,NULL) :
+          Pair(std::min<const G4VPhysicalVolume*>(placement,neighbour.volume),
+               std::max<const G4VPhysicalVolume*>(placement,neighbour.volume));
+        std::map<Pair, size_t>::const_iterator found = pairs.find(key);
+        if(found == pairs.end()){
+          pairs[key] = overlaps.size();
+          overlaps.push_back(std::make_pair(i,n));
+        }
+        else {
+          std::pair<size_t, size_t> &kept = overlaps[found->second];
+          if(neighbour.depth > tasks[kept.first].neighbours[kept.second].depth)
+            kept = std::make_pair(i,n);
+        }
+      }
+    }
+    const int nOverlaps = overlaps.size();
+    info << "CalibSourceOverlapChecker: " << title << ": checked " << tasks.size()
+         << " placements with " << fNPoints << " points each on " << nThreads
+         << " threads, " << nOverlaps << " overlaps found" << newline;
+
+    for(size_t o=0; o<overlaps.size(); o++){
+      const Task &task = tasks[overlaps[o].first];
+      const Neighbour &neighbour = task.neighbours[overlaps[o].second];
+      const G4ThreeVector &point = neighbour.point;
+      if(neighbour.isMother)
+        warn << "  " << task.placement->GetName() << " protrudes from mother "
+             << task.placement->GetMotherLogical()->GetName();
+      else
+        warn << "  " << task.placement->GetName() << " overlaps "
+             << neighbour.volume->GetName();
+      warn << " by up to " << neighbour.depth/CLHEP::mm << " mm at (" << point.x()/CLHEP::mm
+           << ", " << point.y()/CLHEP::mm << ", " << point.z()/CLHEP::mm << ") mm, "
+           << neighbour.nPoints << "/" << fNPoints << " points" << newline;
+    }
+    return nOverlaps;
+  } // Check
+} // namespace RAT
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceOverlapChecker
+//
+// \brief Sampled overlap check for the placements of a calibration source
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version, replaces G4PVPlacement::CheckOverlaps
+//                  for the calibration source factories. \n
+//
+//
+// \detail Points are sampled on the surface of each placed volume and
+//         tested against the mother (the point must not lie outside it)
+//         and against every sibling whose bounding box meets the volume's
+//         own (the point must not lie inside it). Points closer than the
+//         tolerance to the offending surface are ignored.
+//
+//         Sampling uses the random engine, so it is done serially. The
+//         point tests only use the solids' const navigation methods,
+//         which are safe to share between threads, and the placements are
+//         spread over several threads. Every overlap found is listed in a
+//         single summary once all placements have been checked.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceOverlapChecker__
+#define __RAT_CalibSourceOverlapChecker__
+
+#include <G4ThreeVector.hh>
+
+#include <string>
+#include <vector>
+
+class G4VPhysicalVolume;
+
+namespace RAT
+{
+
+  class CalibSourceOverlapChecker
+  {
+  public:
+    // nThreads of 0 uses one thread per core
+    CalibSourceOverlapChecker(const int nPoints = 1000,
+                              const double tolerance = 0.,
+                              const int nThreads = 0)
+      : fNPoints(nPoints), fTolerance(tolerance), fNThreads(nThreads) { };
+
+    // Check the placements and print a summary; returns the number of
+    // overlaps found (each pair of volumes counts, and is listed, once)
+    int Check(const std::vector<G4VPhysicalVolume*> &placements,
+              const std::string &title) const;
+
+  protected:
+    // A volume that a placement pokes into (a sibling) or out of (its mother)
+    struct Neighbour {
+      G4VPhysicalVolume* volume;
+      bool isMother;
+      int nPoints;
+      double depth;
+      G4ThreeVector point;
+    };
+    struct Task {
+      G4VPhysicalVolume* placement;
+      std::vector<G4ThreeVector> points;  // in the mother's frame
+      std::vector<Neighbour> neighbours;
+    };
+
+    Task PrepareTask(G4VPhysicalVolume *placement) const;
+    void RunTask(Task &task) const;
+
+    int fNPoints;
+    double fTolerance;
+    int fNThreads;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,247 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceParams.hh>
+
+#include <RAT/CalibSourceRegistry.hh>
+#include <RAT/Log.hh>
+
+#include <G4Material.hh>
+
+#include <algorithm>
+#include <functional>
+#include <cstdio>
+
+namespace RAT
+{
+  void CalibSourceParamLoader::Field(const std::string &name, double &value,
+                                     const double unit, const bool optional)
+  {
+    try {
+      value = fTable->GetD(name) * unit;
+    }
+    catch(DBNotFoundError &e) {
+      if(!optional)
+        fMissing.push_back(name);
+    };
+  }
+
+  void CalibSourceParamLoader::Field(const std::string &name, std::vector<double> &value,
+                                     const double unit, const bool optional)
+  {
+    try {
+      value = fTable->GetDArray(name);
+      transform(value.begin(),value.end(),value.begin(),bind2nd(std::multiplies<double>(),unit));
+    }
+    catch(DBNotFoundError &e) {
+      if(!optional)
+        fMissing.push_back(name);
+    };
+  }
+
+  void CalibSourceParamLoader::Field(const std::string &name, int &value, const bool optional)
+  {
+    try {
+      value = fTable->GetI(name);
+    }
+    catch(DBNotFoundError &e) {
+      if(!optional)
+        fMissing.push_back(name);
+    };
+  }
+
+  void CalibSourceParamLoader::Field(const std::string &name, bool &value, const bool optional)
+  {
+    try {
+      value = fTable->GetI(name);
+    }
+    catch(DBNotFoundError &e) {
+      if(!optional)
+        fMissing.push_back(name);
+    };
+  }
+
+  void CalibSourceParamLoader::Field(const std::string &name, std::string &value, const bool optional)
+  {
+    try {
+      value = fTable->GetS(name);
+    }
+    catch(DBNotFoundError &e) {
+      if(!optional)
+        fMissing.push_back(name);
+    };
+  }
+
+  void CalibSourceParamHasher::Add(const void *data, const size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for(size_t i=0; i<size; i++){
+      fHash ^= bytes[i];
+      fHash *= 1099511628211ULL;
+    }
+  }
+
+  // Each field adds its name (with the terminating null, so that names
+  // and values cannot run into each other) and then its value
+  void CalibSourceParamHasher::Add(const std::string &name)
+  {
+    Add(name.c_str(),name.size()+1);
+  }
+
+  void CalibSourceParamHasher::Field(const std::string &name, double &value,
+                                     const double unit, const bool optional)
+  {
+    if(fIgnored.count(name))
+      return;
+    Add(name);
+    Add(&value,sizeof(value));
+  }
+
+  void CalibSourceParamHasher::Field(const std::string &name, std::vector<double> &value,
+                                     const double unit, const bool optional)
+  {
+    if(fIgnored.count(name))
+      return;
+    Add(name);
+    const size_t size = value.size();
+    Add(&size,sizeof(size));
+    if(size > 0)
+      Add(&value[0],size*sizeof(double));
+  }
+
+  void CalibSourceParamHasher::Field(const std::string &name, int &value, const bool optional)
+  {
+    if(fIgnored.count(name))
+      return;
+    Add(name);
+    Add(&value,sizeof(value));
+  }
+
+  void CalibSourceParamHasher::Field(const std::string &name, bool &value, const bool optional)
+  {
+    if(fIgnored.count(name))
+      return;
+    Add(name);
+    const unsigned char byte = value;
+    Add(&byte,1);
+  }
+
+  void CalibSourceParamHasher::Field(const std::string &name, std::string &value, const bool optional)
+  {
+    if(fIgnored.count(name))
+      return;
+    Add(name);
+    Add(value);
+  }
+
+  std::string CalibSourceParamHasher::GetHash() const
+  {
+    char hex[17];
+    snprintf(hex,sizeof(hex),"%016llx",fHash);
+    return hex;
+  }
+
+  CalibSourceParams::CalibSourceParams()
+    : checkOverlaps(false), nativeSolids(false), overlapCheckPoints(1000),
+      overlapCheckTolerance(0.), overlapCheckThreads(0), profile(false), productionCut(0.), maxStep(0.),
+      minKineticEnergy(0.), maxTrackTime(0.), detailLevel("full")
+  {
+  }
+
+  void CalibSourceParams::Load(DBLinkPtr table, const std::string &owner)
+  {
+    this->table = table->GetName();
+    index = table->GetIndex();
+    CalibSourceParamLoader loader(table);
+    Visit(loader);
+
+    // Only derive from a complete set of fields
+    std::vector<std::string> problems;
+    const std::vector<std::string> &missing = loader.GetMissing();
+    for(size_t i=0; i<missing.size(); i++)
+      problems.push_back("field " + missing[i] + " is missing");
+    if(problems.empty()){
+      Derive(problems);
+      Validate(problems);
+    }
+    if(problems.empty())
+      return;
+
+    std::string message = owner + ": Table " + table->GetName() + ", index " + index + ":";
+    for(size_t i=0; i<problems.size(); i++)
+      message += "\n  " + problems[i];
+    Log::Die(message);
+  } // Load
+
+  void CalibSourceParams::Visit(CalibSourceParamVisitor &visitor)
+  {
+    visitor.Field("mother",mother);
+    visitor.Field("check_overlaps",checkOverlaps);
+    visitor.Field("native_solids",nativeSolids,true);
+    visitor.Field("overlap_check_points",overlapCheckPoints,true);
+    visitor.Field("overlap_check_tolerance",overlapCheckTolerance,CLHEP::mm,true);
+    visitor.Field("overlap_check_threads",overlapCheckThreads,true);
+    visitor.Field("profile",profile,true);
+    visitor.Field("production_cut",productionCut,CLHEP::mm,true);
+    visitor.Field("max_step",maxStep,CLHEP::mm,true);
+    visitor.Field("min_kinetic_energy",minKineticEnergy,CLHEP::MeV,true);
+    visitor.Field("max_track_time",maxTrackTime,CLHEP::ns,true);
+    visitor.Field("geometry_cache",geometryCache,true);
+    visitor.Field("detail_level",detailLevel,true);
+  } // Visit
+
+  void CalibSourceParams::Validate(std::vector<std::string> &problems) const
+  {
+    if(overlapCheckPoints <= 0)
+      problems.push_back("overlap_check_points must be positive");
+    if(overlapCheckTolerance < 0.)
+      problems.push_back("overlap_check_tolerance must not be negative");
+    if(productionCut < 0. || maxStep < 0. || minKineticEnergy < 0. || maxTrackTime < 0.)
+      problems.push_back("production_cut, max_step, min_kinetic_energy and max_track_time must not be negative");
+    if(detailLevel != "full" && detailLevel != "reduced" && detailLevel != "envelope-only")
+      problems.push_back("detail_level must be \"full\", \"reduced\" or \"envelope-only\"");
+  } // Validate
+
+  std::string CalibSourceParams::GetHash(const bool sensitive) const
+  {
+    // Visit takes the members by reference, but the hasher only reads them.
+    // The fields that only control how a source is checked or simulated
+    // are left out.
+    CalibSourceParamHasher hasher;
+    const char* settings[] = {"check_overlaps","overlap_check_points","overlap_check_tolerance",
+                              "overlap_check_threads","fast_simulation","response_table",
+                              "profile","geometry_cache"};
+    for(size_t i=0; i<sizeof(settings)/sizeof(settings[0]); i++)
+      hasher.Ignore(settings[i]);
+    // Where the source is placed does not change its parts, so a response
+    // made with the source alone in a world matches the placed source; the
+    // built geometry does depend on the mother, whose material fills the
+    // envelope
+    if(!sensitive){
+      hasher.Ignore("mother");
+      hasher.Ignore("early_abort");
+      hasher.Ignore("accumulate_tag");
+    }
+    const_cast<CalibSourceParams*>(this)->Visit(hasher);
+    return hasher.GetHash();
+  } // GetHash
+
+  CalibSourceParams::DetailLevel CalibSourceParams::GetDetailLevel() const
+  {
+    if(detailLevel == "reduced")
+      return kReducedDetail;
+    if(detailLevel == "envelope-only")
+      return kEnvelopeOnly;
+    return kFullDetail;
+  } // GetDetailLevel
+
+  G4Material* CalibSourceParams::FindMaterial(const std::string &name,
+                                              std::vector<std::string> &problems)
+  {
+    G4Material* material = CalibSourceRegistry::FindMaterial(name);
+    if(material == NULL)
+      problems.push_back("material " + name + " does not exist");
+    return material;
+  } // FindMaterial
+} // namespace RAT
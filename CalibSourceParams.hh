@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceParams
+//
+// \brief Parameters common to the calibration source geometry tables
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version, typed parameters loaded in one pass. \n
+//
+//
+// \detail Each source type derives a struct holding its table fields as
+//         typed members, with units applied. Visit lists every field once,
+//         as (table field, member, unit), and is the only place the field
+//         names appear: CalibSourceParamLoader fills the members from the
+//         table through it, and anything else that needs to walk the
+//         fields (a hash, a cache file) can do the same.
+//
+//         Load reads every field, then computes the derived quantities and
+//         checks them, and stops with a list of every missing or
+//         inconsistent field rather than at the first one.
+//
+//         sample_position is deliberately not a member: it is the one
+//         field that is expected to change between builds of a source.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceParams__
+#define __RAT_CalibSourceParams__
+
+#include <RAT/DB.hh>
+
+#include <string>
+#include <vector>
+#include <set>
+
+class G4Material;
+
+namespace RAT
+{
+
+  // Something that walks the fields of a parameter struct. Optional fields
+  // keep the value they already have when the table does not set them.
+  class CalibSourceParamVisitor
+  {
+  public:
+    virtual ~CalibSourceParamVisitor() { };
+    virtual void Field(const std::string &name, double &value,
+                       const double unit, const bool optional = false) = 0;
+    virtual void Field(const std::string &name, std::vector<double> &value,
+                       const double unit, const bool optional = false) = 0;
+    virtual void Field(const std::string &name, int &value,
+                       const bool optional = false) = 0;
+    virtual void Field(const std::string &name, bool &value,
+                       const bool optional = false) = 0;
+    virtual void Field(const std::string &name, std::string &value,
+                       const bool optional = false) = 0;
+  };
+
+  // Fills the fields from a table, noting every required one that is missing
+  class CalibSourceParamLoader : public CalibSourceParamVisitor
+  {
+  public:
+    CalibSourceParamLoader(DBLinkPtr table) : fTable(table) { };
+    virtual void Field(const std::string &name, double &value,
+                       const double unit, const bool optional = false);
+    virtual void Field(const std::string &name, std::vector<double> &value,
+                       const double unit, const bool optional = false);
+    virtual void Field(const std::string &name, int &value,
+                       const bool optional = false);
+    virtual void Field(const std::string &name, bool &value,
+                       const bool optional = false);
+    virtual void Field(const std::string &name, std::string &value,
+                       const bool optional = false);
+    const std::vector<std::string>& GetMissing() const { return fMissing; };
+  protected:
+    DBLinkPtr fTable;
+    std::vector<std::string> fMissing;
+  };
+
+  // Hash of the field names and values (FNV-1a), so anything derived from
+  // a set of parameters can tell if they have changed
+  class CalibSourceParamHasher : public CalibSourceParamVisitor
+  {
+  public:
+    CalibSourceParamHasher() : fHash(14695981039346656037ULL) { };
+    virtual void Field(const std::string &name, double &value,
+                       const double unit, const bool optional = false);
+    virtual void Field(const std::string &name, std::vector<double> &value,
+                       const double unit, const bool optional = false);
+    virtual void Field(const std::string &name, int &value,
+                       const bool optional = false);
+    virtual void Field(const std::string &name, bool &value,
+                       const bool optional = false);
+    virtual void Field(const std::string &name, std::string &value,
+                       const bool optional = false);
+    // Leave this field out of the hash
+    void Ignore(const std::string &name) { fIgnored.insert(name); };
+    // As 16 hex digits
+    std::string GetHash() const;
+  protected:
+    void Add(const std::string &name);
+    void Add(const void *data, const size_t size);
+    unsigned long long fHash;
+    std::set<std::string> fIgnored;
+  };
+
+  struct CalibSourceParams
+  {
+    CalibSourceParams();
+    virtual ~CalibSourceParams() { };
+
+    // Read every field from the table, derive and check; dies listing all
+    // the problems found, naming owner (the factory) in the message
+    void Load(DBLinkPtr table, const std::string &owner);
+
+    virtual void Visit(CalibSourceParamVisitor &visitor);
+    // Quantities computed from the fields (and the materials they name),
+    // once all are loaded; adds a message for anything that cannot be
+    virtual void Derive(std::vector<std::string> &problems) { };
+    // Add a message for every inconsistent field
+    virtual void Validate(std::vector<std::string> &problems) const;
+
+    // Hash of every field that affects the parts of the source (see
+    // CalibSourceParamHasher), whatever it is placed in; with sensitive,
+    // also of the mother and of the fields that affect how its sensitive
+    // detectors are set up, for the geometry as built
+    std::string GetHash(const bool sensitive = false) const;
+
+    // How much of the source detail_level asks for: every part, the parts
+    // less their small features (whose mass goes to the part they are in
+    // or on), or the envelope alone, filled with the equivalent material
+    enum DetailLevel { kFullDetail, kReducedDetail, kEnvelopeOnly };
+    DetailLevel GetDetailLevel() const;
+
+    // Look up a material by name, adding a problem if it does not exist
+    static G4Material* FindMaterial(const std::string &name,
+                                    std::vector<std::string> &problems);
+
+    std::string table;
+    std::string index;
+    std::string mother;
+    bool checkOverlaps;
+    bool nativeSolids;
+    int overlapCheckPoints;
+    double overlapCheckTolerance;
+    int overlapCheckThreads;
+    // Count the steps and time in each of the source's volumes (see
+    // CalibSourceProfiler)
+    bool profile;
+    // For the source's region; zero leaves the detector's setting
+    double productionCut;
+    double maxStep;
+    double minKineticEnergy;
+    double maxTrackTime;
+    // Directory of built sources to reuse, or empty to always build (see
+    // CalibSourceGeometryCache)
+    std::string geometryCache;
+    // "full", "reduced" or "envelope-only" (see GetDetailLevel)
+    std::string detailLevel;
+  };
+
+} // namespace RAT
+
+#endif
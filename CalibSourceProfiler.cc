@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceProfiler.hh>
+
+#include <RAT/Log.hh>
+
+#include <G4RunManager.hh>
+#include <G4Threading.hh>
+#include <G4AutoLock.hh>
+#include <G4Step.hh>
+#include <G4StepPoint.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4LogicalVolume.hh>
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+namespace RAT
+{
+  namespace
+  {
+    G4Mutex totalsMutex = G4MUTEX_INITIALIZER;
+  }
+
+  std::vector<std::string> CalibSourceProfiler::fPrefixes;
+  std::map<std::string, CalibSourceProfiler::Counters> CalibSourceProfiler::fTotals;
+
+  void CalibSourceProfiler::Profile(const std::string &prefix)
+  {
+    if(std::find(fPrefixes.begin(),fPrefixes.end(),prefix) == fPrefixes.end())
+      fPrefixes.push_back(prefix);
+    Install();
+  } // Profile
+
+  void CalibSourceProfiler::Install()
+  {
+    // The run manager, and so its actions, is per thread
+    G4RunManager* runManager = G4RunManager::GetRunManager();
+    if(runManager == NULL)
+      return;
+    if(dynamic_cast<const CalibSourceProfilerRun*>(runManager->GetUserRunAction()) != NULL)
+      return;
+
+    // Nothing is tracked on the master of a multithreaded run, which only
+    // takes stepping and tracking actions from the action initialization
+    if(G4Threading::IsMultithreadedApplication() && !G4Threading::IsWorkerThread()){
+      runManager->SetUserAction(new CalibSourceProfilerRun(
+        const_cast<G4UserRunAction*>(runManager->GetUserRunAction()),NULL));
+      return;
+    }
+    CalibSourceProfiler* profiler = new CalibSourceProfiler(const_cast<G4UserSteppingAction*>(runManager->GetUserSteppingAction()));
+    runManager->SetUserAction(profiler);
+    runManager->SetUserAction(new CalibSourceProfilerTracking(
+      const_cast<G4UserTrackingAction*>(runManager->GetUserTrackingAction()),profiler));
+    runManager->SetUserAction(new CalibSourceProfilerRun(
+      const_cast<G4UserRunAction*>(runManager->GetUserRunAction()),profiler));
+  } // Install
+
+  CalibSourceProfiler::CalibSourceProfiler(G4UserSteppingAction *action)
+    : fAction(action), fClock(Clock::now()), fLastVolume(NULL), fLastCounters(NULL)
+  {
+  }
+
+  CalibSourceProfiler::~CalibSourceProfiler()
+  {
+    delete fAction;
+  }
+
+  void CalibSourceProfiler::SetSteppingManagerPointer(G4SteppingManager *steppingManager)
+  {
+    G4UserSteppingAction::SetSteppingManagerPointer(steppingManager);
+    if(fAction != NULL)
+      fAction->SetSteppingManagerPointer(steppingManager);
+  } // SetSteppingManagerPointer
+
+  void CalibSourceProfiler::UserSteppingAction(const G4Step *step)
+  {
+    const Clock::time_point now = Clock::now();
+    const G4LogicalVolume* volume = step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume();
+    if(volume != fLastVolume){
+      fLastCounters = &Find(volume);
+      fLastVolume = volume;
+    }
+
+    Counters &counters = *fLastCounters;
+    counters.steps++;
+    if(step->GetPostStepPoint()->GetStepStatus() == fGeomBoundary)
+      counters.boundaries++;
+    const std::vector<const G4Track*>* secondaries = step->GetSecondaryInCurrentStep();
+    if(secondaries != NULL)
+      counters.secondaries += secondaries->size();
+    counters.time += std::chrono::duration<double>(now-fClock).count();
+
+    if(fAction != NULL)
+      fAction->UserSteppingAction(step);
+    StartClock();
+  } // UserSteppingAction
+
+  CalibSourceProfiler::Counters& CalibSourceProfiler::Find(const G4LogicalVolume *volume)
+  {
+    std::map<const G4LogicalVolume*, Counters*>::const_iterator found = fVolumeCounters.find(volume);
+    if(found != fVolumeCounters.end())
+      return *found->second;
+
+    std::string name;
+    for(size_t i=0; i<fPrefixes.size(); i++)
+      if(volume->GetName().compare(0,fPrefixes[i].size(),fPrefixes[i]) == 0)
+        name = volume->GetName();
+    Counters* counters = &fCounters[name];
+    fVolumeCounters[volume] = counters;
+    return *counters;
+  } // Find
+
+  void CalibSourceProfiler::Merge()
+  {
+    G4AutoLock lock(&totalsMutex);
+    for(std::map<std::string, Counters>::const_iterator it = fCounters.begin(); it != fCounters.end(); ++it){
+      Counters &total = fTotals[it->first];
+      total.steps += it->second.steps;
+      total.boundaries += it->second.boundaries;
+      total.secondaries += it->second.secondaries;
+      total.time += it->second.time;
+    }
+    // The volumes are kept, only their counts go
+    for(std::map<std::string, Counters>::iterator it = fCounters.begin(); it != fCounters.end(); ++it)
+      it->second = Counters();
+  } // Merge
+
+  void CalibSourceProfiler::Report()
+  {
+    G4AutoLock lock(&totalsMutex);
+    double runTime = 0.;
+    for(std::map<std::string, Counters>::const_iterator it = fTotals.begin(); it != fTotals.end(); ++it)
+      runTime += it->second.time;
+
+    std::ostringstream report;
+    report << "CalibSourceProfiler: Tracking by volume over the run (time summed over threads)\n"
+           << std::setw(40) << std::left << "  volume" << std::right << std::setw(14) << "steps"
+           << std::setw(14) << "boundaries" << std::setw(14) << "secondaries"
+           << std::setw(12) << "time (s)" << std::setw(9) << "time %" << "\n";
+    // Each source and then its volumes, busiest first, then the rest
+    std::vector<Counters> sources(fPrefixes.size());
+    std::vector<std::pair<std::string, const Counters*> > lines;
+    for(size_t i=0; i<fPrefixes.size(); i++){
+      std::vector<std::pair<double, std::string> > volumes;
+      Counters &source = sources[i];
+      for(std::map<std::string, Counters>::const_iterator it = fTotals.begin(); it != fTotals.end(); ++it)
+        if(!it->first.empty() && it->first.compare(0,fPrefixes[i].size(),fPrefixes[i]) == 0){
+          volumes.push_back(std::make_pair(-it->second.time,it->first));
+          source.steps += it->second.steps;
+          source.boundaries += it->second.boundaries;
+          source.secondaries += it->second.secondaries;
+          source.time += it->second.time;
+        }
+      std::sort(volumes.begin(),volumes.end());
+      lines.push_back(std::make_pair("  " + fPrefixes[i].substr(0,fPrefixes[i].size()-1) + " (all)",&source));
+      for(size_t j=0; j<volumes.size(); j++)
+        lines.push_back(std::make_pair("    " + volumes[j].second,&fTotals[volumes[j].second]));
+    }
+    lines.push_back(std::make_pair("  rest of the detector",&fTotals[""]));
+
+    report << std::fixed;
+    for(size_t i=0; i<lines.size(); i++){
+      const Counters &counters = *lines[i].second;
+      report << std::setw(40) << std::left << lines[i].first << std::right
+             << std::setw(14) << counters.steps << std::setw(14) << counters.boundaries
+             << std::setw(14) << counters.secondaries << std::setw(12) << std::setprecision(3)
+             << counters.time << std::setw(9) << std::setprecision(1)
+             << (runTime > 0. ? 100.*counters.time/runTime : 0.) << "\n";
+    }
+    info << report.str();
+    fTotals.clear();
+  } // Report
+
+  CalibSourceProfilerTracking::~CalibSourceProfilerTracking()
+  {
+    delete fAction;
+  }
+
+  void CalibSourceProfilerTracking::SetTrackingManagerPointer(G4TrackingManager *trackingManager)
+  {
+    G4UserTrackingAction::SetTrackingManagerPointer(trackingManager);
+    if(fAction != NULL)
+      fAction->SetTrackingManagerPointer(trackingManager);
+  } // SetTrackingManagerPointer
+
+  void CalibSourceProfilerTracking::PreUserTrackingAction(const G4Track *track)
+  {
+    if(fAction != NULL)
+      fAction->PreUserTrackingAction(track);
+    fProfiler->StartClock();
+  } // PreUserTrackingAction
+
+  void CalibSourceProfilerTracking::PostUserTrackingAction(const G4Track *track)
+  {
+    if(fAction != NULL)
+      fAction->PostUserTrackingAction(track);
+  } // PostUserTrackingAction
+
+  CalibSourceProfilerRun::~CalibSourceProfilerRun()
+  {
+    delete fAction;
+  }
+
+  G4Run* CalibSourceProfilerRun::GenerateRun()
+  {
+    return fAction != NULL ? fAction->GenerateRun() : NULL;
+  } // GenerateRun
+
+  void CalibSourceProfilerRun::BeginOfRunAction(const G4Run *run)
+  {
+    if(fAction != NULL)
+      fAction->BeginOfRunAction(run);
+  } // BeginOfRunAction
+
+  void CalibSourceProfilerRun::EndOfRunAction(const G4Run *run)
+  {
+    if(fAction != NULL)
+      fAction->EndOfRunAction(run);
+    // The workers' runs end before the master's
+    if(fProfiler != NULL)
+      fProfiler->Merge();
+    if(!G4Threading::IsWorkerThread())
+      CalibSourceProfiler::Report();
+  } // EndOfRunAction
+
+  void CalibSourceProfilerRun::SetMaster(G4bool master)
+  {
+    G4UserRunAction::SetMaster(master);
+    if(fAction != NULL)
+      fAction->SetMaster(master);
+  } // SetMaster
+} // namespace RAT
@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceProfiler
+//
+// \brief Steps, boundary crossings, secondaries and time spent in each
+//        volume of the calibration sources
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Install puts three actions in front of the ones the run
+//         manager already has on this thread; each passes everything on
+//         to the one it replaces:
+//
+//           CalibSourceProfiler          (stepping) counts each step
+//                                        against the logical volume it
+//                                        starts in
+//           CalibSourceProfilerTracking  starts the clock for a track's
+//                                        first step
+//           CalibSourceProfilerRun       merges the thread's counts at the
+//                                        end of a run, and reports them
+//
+//         A step's time is the wall time since the previous step of the
+//         track (or the track's start), leaving out the other actions.
+//         Every volume whose name starts with a profiled prefix ("<index>_"
+//         of a source built with profile set) is counted on its own, and
+//         the rest of the detector together. Each thread keeps its own
+//         counts; at the end of a run they are added to the totals under a
+//         lock, and the master (or the only thread) logs them, busiest
+//         first, grouped by source.
+//
+//         The geometry factories install it while building, and on the
+//         workers while creating the sensitive detectors, i.e. after the
+//         user actions are set.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceProfiler__
+#define __RAT_CalibSourceProfiler__
+
+#include <G4UserSteppingAction.hh>
+#include <G4UserTrackingAction.hh>
+#include <G4UserRunAction.hh>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+
+class G4LogicalVolume;
+
+namespace RAT
+{
+
+  class CalibSourceProfiler : public G4UserSteppingAction
+  {
+  public:
+    // Profile the volumes whose names start with prefix; called while the
+    // geometry is built, and installs the actions on this thread
+    static void Profile(const std::string &prefix);
+    // Install the actions on this thread, unless they already are. On the
+    // master of a multithreaded run only the run action, which reports.
+    static void Install();
+    // Whether any volumes are profiled
+    static bool IsProfiling() { return !fPrefixes.empty(); };
+
+    virtual ~CalibSourceProfiler();
+
+    virtual void SetSteppingManagerPointer(G4SteppingManager *steppingManager);
+    virtual void UserSteppingAction(const G4Step *step);
+
+    // Start timing the next step from now
+    void StartClock() { fClock = Clock::now(); };
+    // Add this thread's counts to the totals and clear them
+    void Merge();
+    // Log the totals and clear them
+    static void Report();
+
+  protected:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Counters
+    {
+      Counters() : steps(0), boundaries(0), secondaries(0), time(0.) { };
+      long long steps;
+      long long boundaries;
+      long long secondaries;
+      // s
+      double time;
+    };
+
+    CalibSourceProfiler(G4UserSteppingAction *action);
+
+    // The counters of a volume: its own in a source, or the shared ones of
+    // the rest of the detector
+    Counters& Find(const G4LogicalVolume *volume);
+
+    // The action this one is in front of, if any; owned
+    G4UserSteppingAction *fAction;
+    Clock::time_point fClock;
+    // This thread's counts by volume name ("" for the rest of the detector)
+    std::map<std::string, Counters> fCounters;
+    std::map<const G4LogicalVolume*, Counters*> fVolumeCounters;
+    // The last volume looked up, as most steps follow one in the same one
+    const G4LogicalVolume *fLastVolume;
+    Counters *fLastCounters;
+
+    // Written while the geometry is built, only read by the workers
+    static std::vector<std::string> fPrefixes;
+    // Summed over the threads, under a lock
+    static std::map<std::string, Counters> fTotals;
+  };
+
+  class CalibSourceProfilerTracking : public G4UserTrackingAction
+  {
+  public:
+    CalibSourceProfilerTracking(G4UserTrackingAction *action, CalibSourceProfiler *profiler)
+      : fAction(action), fProfiler(profiler) { };
+    virtual ~CalibSourceProfilerTracking();
+
+    virtual void SetTrackingManagerPointer(G4TrackingManager *trackingManager);
+    virtual void PreUserTrackingAction(const G4Track *track);
+    virtual void PostUserTrackingAction(const G4Track *track);
+
+  protected:
+    // Owned
+    G4UserTrackingAction *fAction;
+    CalibSourceProfiler *fProfiler;
+  };
+
+  class CalibSourceProfilerRun : public G4UserRunAction
+  {
+  public:
+    CalibSourceProfilerRun(G4UserRunAction *action, CalibSourceProfiler *profiler)
+      : fAction(action), fProfiler(profiler) { };
+    virtual ~CalibSourceProfilerRun();
+
+    virtual G4Run* GenerateRun();
+    virtual void BeginOfRunAction(const G4Run *run);
+    virtual void EndOfRunAction(const G4Run *run);
+    virtual void SetMaster(G4bool master = true);
+
+  protected:
+    // Owned
+    G4UserRunAction *fAction;
+    CalibSourceProfiler *fProfiler;
+  };
+
+} // namespace RAT
+
+#endif
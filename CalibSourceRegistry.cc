@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceRegistry.hh>
+
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4Material.hh>
+
+namespace RAT
+{
+  CalibSourceRegistry::Index<G4LogicalVolume> CalibSourceRegistry::fLogicalVolumes;
+  CalibSourceRegistry::Index<G4Material> CalibSourceRegistry::fMaterials;
+
+  G4LogicalVolume* CalibSourceRegistry::FindLogicalVolume(const std::string &name)
+  {
+    return fLogicalVolumes.Find(*G4LogicalVolumeStore::GetInstance(),name);
+  } // FindLogicalVolume
+
+  G4Material* CalibSourceRegistry::FindMaterial(const std::string &name)
+  {
+    return fMaterials.Find(*G4Material::GetMaterialTable(),name);
+  } // FindMaterial
+
+  void CalibSourceRegistry::Clear()
+  {
+    fLogicalVolumes.Clear();
+    fMaterials.Clear();
+  } // Clear
+
+  template <class T>
+  T* CalibSourceRegistry::Index<T>::Find(const std::vector<T*> &store, const std::string &name)
+  {
+    // Deleting an entry moves the ones after it down
+    if(store.size() < fNIndexed)
+      Clear();
+    Update(store);
+    std::unordered_map<std::string, size_t>::const_iterator position = fPositions.find(name);
+    if(position != fPositions.end() && position->second < store.size() &&
+       store[position->second]->GetName() == name)
+      return store[position->second];
+
+    // Missing or moved: it is only really missing if a fresh index does not
+    // have it either
+    Clear();
+    Update(store);
+    position = fPositions.find(name);
+    return position == fPositions.end() ? NULL : store[position->second];
+  } // Find
+
+  template <class T>
+  void CalibSourceRegistry::Index<T>::Update(const std::vector<T*> &store)
+  {
+    for(; fNIndexed<store.size(); fNIndexed++)
+      if(store[fNIndexed] != NULL)
+        fPositions.insert(std::make_pair(std::string(store[fNIndexed]->GetName()),fNIndexed));
+  } // Update
+} // namespace RAT
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceRegistry
+//
+// \brief Logical volumes and materials of the calibration sources, looked
+//        up by name through an index
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail The factories find their mothers and materials here rather than
+//         by a scan of the G4LogicalVolumeStore or the material table,
+//         which hold the whole detector. Each name maps to its position in
+//         the store, as the first entry with that name, as Geant4's own
+//         lookups find. Entries appended since the last lookup are indexed
+//         when the next one is made, so the index follows the stores
+//         without anything having to register with it.
+//
+//         A hit is checked against the store before it is returned, and a
+//         miss or a store that shrank rebuilds the index, so volumes
+//         deleted or replaced with the geometry are never handed out. Only
+//         names that do not exist cost a scan.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceRegistry__
+#define __RAT_CalibSourceRegistry__
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class G4LogicalVolume;
+class G4Material;
+
+namespace RAT
+{
+
+  class CalibSourceRegistry
+  {
+  public:
+    // NULL if there is no such volume or material
+    static G4LogicalVolume* FindLogicalVolume(const std::string &name);
+    static G4Material* FindMaterial(const std::string &name);
+
+    // Forget both indices, so the next lookups start afresh
+    static void Clear();
+
+  protected:
+    // Positions of the entries of one store, by name
+    template <class T>
+    class Index
+    {
+    public:
+      Index() : fNIndexed(0) { };
+      T* Find(const std::vector<T*> &store, const std::string &name);
+      void Clear() { fPositions.clear(); fNIndexed = 0; };
+    protected:
+      // Index the entries added since the last call
+      void Update(const std::vector<T*> &store);
+
+      std::unordered_map<std::string, size_t> fPositions;
+      size_t fNIndexed;
+    };
+
+    static Index<G4LogicalVolume> fLogicalVolumes;
+    static Index<G4Material> fMaterials;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceResponse.hh>
+
+#include <RAT/Log.hh>
+#include <RAT/string_utilities.hpp>
+
+#include <G4SystemOfUnits.hh>
+#include <Randomize.hh>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <cmath>
+
+namespace RAT
+{
+  void CalibSourceResponse::Load(DBLinkPtr table, const std::string &geometryHash)
+  {
+    try {
+      const std::string tableHash = table->GetS("geometry_hash");
+      Log::Assert(tableHash == geometryHash,"CalibSourceResponse: Table " + table->GetName() + ", index " +
+                  table->GetIndex() + " was made for another source geometry (hash " + tableHash +
+                  ", now " + geometryHash + "). Make it again with calib_source_response.");
+
+      fBetaEdges = table->GetDArray("beta_energy_edges");
+      fBetaTagProbability = table->GetDArray("beta_tag_probability");
+      fBetaTagFraction = table->GetDArray("beta_tag_fraction");
+      fGammaEdges = table->GetDArray("gamma_energy_edges");
+      fGammaTagProbability = table->GetDArray("gamma_tag_probability");
+      fGammaTagFraction = table->GetDArray("gamma_tag_fraction");
+      fGammaTransmission = table->GetDArray("gamma_transmission");
+      fGammaScatterEscape = table->GetDArray("gamma_scatter_escape");
+      fSpectrumBins = table->GetI("spectrum_bins");
+      fGammaScatterEnergy = table->GetDArray("gamma_scatter_energy");
+      fGammaScatterCosTheta = table->GetDArray("gamma_scatter_cos_theta");
+    }
+    catch(DBNotFoundError &e) {
+      Log::Die("CalibSourceResponse: DBNotFoundError. Table " + e.table + ", index " + e.index + ", field " + e.field + ".");
+    };
+    transform(fBetaEdges.begin(),fBetaEdges.end(),fBetaEdges.begin(),bind2nd(std::multiplies<double>(),CLHEP::MeV));
+    transform(fGammaEdges.begin(),fGammaEdges.end(),fGammaEdges.begin(),bind2nd(std::multiplies<double>(),CLHEP::MeV));
+
+    std::vector<std::string> problems;
+    const size_t nBeta = fBetaEdges.size()-1;
+    const size_t nGamma = fGammaEdges.size()-1;
+    if(fBetaEdges.size() < 2 || !std::is_sorted(fBetaEdges.begin(),fBetaEdges.end()))
+      problems.push_back("beta_energy_edges must be at least two increasing energies");
+    else if(fBetaTagProbability.size() != nBeta || fBetaTagFraction.size() != nBeta)
+      problems.push_back("beta_tag_probability and beta_tag_fraction need one entry per beta bin");
+    if(fGammaEdges.size() < 2 || !std::is_sorted(fGammaEdges.begin(),fGammaEdges.end()))
+      problems.push_back("gamma_energy_edges must be at least two increasing energies");
+    else if(fGammaTagProbability.size() != nGamma || fGammaTagFraction.size() != nGamma ||
+            fGammaTransmission.size() != nGamma || fGammaScatterEscape.size() != nGamma)
+      problems.push_back("gamma_tag_probability, gamma_tag_fraction, gamma_transmission and "
+                         "gamma_scatter_escape need one entry per gamma bin");
+    else {
+      for(size_t i=0; i<nGamma; i++)
+        if(fGammaTransmission[i]+fGammaScatterEscape[i] > 1.)
+          problems.push_back("gamma_transmission and gamma_scatter_escape add up to more than one in bin " +
+                             to_string(static_cast<int>(i)));
+      if(fSpectrumBins <= 0 || fGammaScatterEnergy.size() != nGamma*fSpectrumBins ||
+         fGammaScatterCosTheta.size() != nGamma*fSpectrumBins)
+        problems.push_back("gamma_scatter_energy and gamma_scatter_cos_theta need spectrum_bins entries per gamma bin");
+      else {
+        Accumulate(fGammaScatterEnergy,"gamma_scatter_energy",problems);
+        Accumulate(fGammaScatterCosTheta,"gamma_scatter_cos_theta",problems);
+      }
+    }
+    if(problems.empty())
+      return;
+
+    std::string message = "CalibSourceResponse: Table " + table->GetName() + ", index " + table->GetIndex() + ":";
+    for(size_t i=0; i<problems.size(); i++)
+      message += "\n  " + problems[i];
+    Log::Die(message);
+  } // Load
+
+  void CalibSourceResponse::Accumulate(std::vector<double> &spectrum, const std::string &name,
+                                       std::vector<std::string> &problems) const
+  {
+    for(size_t row=0; row*fSpectrumBins<spectrum.size(); row++){
+      std::vector<double>::iterator begin = spectrum.begin()+row*fSpectrumBins;
+      if(*std::min_element(begin,begin+fSpectrumBins) < 0.){
+        problems.push_back(name + " has a negative entry in row " + to_string(static_cast<int>(row)));
+        continue;
+      }
+      std::partial_sum(begin,begin+fSpectrumBins,begin);
+      const double total = *(begin+fSpectrumBins-1);
+      // A bin no scattered gamma escapes from is never sampled
+      if(total > 0.)
+        transform(begin,begin+fSpectrumBins,begin,bind2nd(std::divides<double>(),total));
+    }
+  } // Accumulate
+
+  int CalibSourceResponse::FindBin(const std::vector<double> &edges, const double energy)
+  {
+    if(energy < edges.front() || energy >= edges.back())
+      return -1;
+    return std::upper_bound(edges.begin(),edges.end(),energy)-edges.begin()-1;
+  } // FindBin
+
+  bool CalibSourceResponse::CoversBeta(const double energy) const
+  {
+    return FindBin(fBetaEdges,energy) >= 0;
+  } // CoversBeta
+
+  bool CalibSourceResponse::CoversGamma(const double energy) const
+  {
+    return FindBin(fGammaEdges,energy) >= 0;
+  } // CoversGamma
+
+  double CalibSourceResponse::SampleBetaTag(const double energy) const
+  {
+    const int bin = FindBin(fBetaEdges,energy);
+    if(bin < 0 || G4UniformRand() >= fBetaTagProbability[bin])
+      return 0.;
+    return energy*fBetaTagFraction[bin];
+  } // SampleBetaTag
+
+  double CalibSourceResponse::SampleGammaTag(const double energy) const
+  {
+    const int bin = FindBin(fGammaEdges,energy);
+    if(bin < 0 || G4UniformRand() >= fGammaTagProbability[bin])
+      return 0.;
+    return energy*fGammaTagFraction[bin];
+  } // SampleGammaTag
+
+  bool CalibSourceResponse::SampleGammaEscape(double &energy, G4ThreeVector &direction) const
+  {
+    const int bin = FindBin(fGammaEdges,energy);
+    if(bin < 0)
+      return true;
+    const double chance = G4UniformRand();
+    if(chance < fGammaTransmission[bin])
+      return true;
+    if(chance >= fGammaTransmission[bin]+fGammaScatterEscape[bin])
+      return false;
+
+    energy *= SampleSpectrum(fGammaScatterEnergy,bin,0.,1.);
+    const double cosTheta = SampleSpectrum(fGammaScatterCosTheta,bin,-1.,1.);
+    const double sinTheta = std::sqrt(std::max(0.,1.-cosTheta*cosTheta));
+    const double phi = CLHEP::twopi*G4UniformRand();
+    G4ThreeVector scattered(sinTheta*std::cos(phi),sinTheta*std::sin(phi),cosTheta);
+    direction = scattered.rotateUz(direction);
+    return true;
+  } // SampleGammaEscape
+
+  double CalibSourceResponse::SampleSpectrum(const std::vector<double> &cumulative, const int row,
+                                             const double low, const double high) const
+  {
+    std::vector<double>::const_iterator begin = cumulative.begin()+row*fSpectrumBins;
+    std::vector<double>::const_iterator end = begin+fSpectrumBins;
+    const double chance = G4UniformRand();
+    const int bin = std::min<int>(std::upper_bound(begin,end,chance)-begin,fSpectrumBins-1);
+    const double width = (high-low)/fSpectrumBins;
+    return low+width*(bin+G4UniformRand());
+  } // SampleSpectrum
+} // namespace RAT
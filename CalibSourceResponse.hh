@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceResponse
+//
+// \brief Response of a calibration source capsule to the particles
+//        emitted by its isotope
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Tabulated from the full geometry, in bins of the kinetic energy
+//         a particle starts with at the source:
+//
+//             beta_energy_edges      (MeV) bin edges for e- and e+
+//             beta_tag_probability   chance of depositing energy in the
+//                                    scintillator
+//             beta_tag_fraction      mean fraction of the kinetic energy
+//                                    deposited there when it does
+//             gamma_energy_edges     (MeV) bin edges for gammas
+//             gamma_tag_probability, gamma_tag_fraction   as for betas
+//             gamma_transmission     chance of leaving the capsule without
+//                                    interacting
+//             gamma_scatter_escape   chance of leaving after scattering
+//             spectrum_bins          bins in each row of the two spectra
+//             gamma_scatter_energy   for each gamma bin, spectrum of the
+//                                    fraction of energy kept by a scattered
+//                                    gamma that leaves, over (0,1]
+//             gamma_scatter_cos_theta  and of the cosine of its deflection,
+//                                    over [-1,1]
+//
+//         Betas are absorbed in the capsule. A particle outside the
+//         tabulated energies is not covered by the table.
+//
+//         geometry_hash is the hash of the source parameters the table was
+//         made with (CalibSourceParams::GetHash); a table made for another
+//         geometry is refused. calib_source_response writes these tables.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceResponse__
+#define __RAT_CalibSourceResponse__
+
+#include <RAT/DB.hh>
+
+#include <G4ThreeVector.hh>
+
+#include <string>
+#include <vector>
+
+namespace RAT
+{
+
+  class CalibSourceResponse
+  {
+  public:
+    CalibSourceResponse() : fSpectrumBins(0) { };
+
+    // Read the table, dying with a list of every inconsistent field, or if
+    // it was made for parameters with another hash
+    void Load(DBLinkPtr table, const std::string &geometryHash);
+
+    bool CoversBeta(const double energy) const;
+    bool CoversGamma(const double energy) const;
+    // Energy left in the scintillator by a particle of this energy, zero
+    // if it misses
+    double SampleBetaTag(const double energy) const;
+    double SampleGammaTag(const double energy) const;
+    // Whether a gamma leaves the capsule; if it does, energy and direction
+    // are updated to those it leaves with
+    bool SampleGammaEscape(double &energy, G4ThreeVector &direction) const;
+
+  protected:
+    static int FindBin(const std::vector<double> &edges, const double energy);
+    // Value drawn from row of a spectrum over [low,high]
+    double SampleSpectrum(const std::vector<double> &cumulative, const int row,
+                          const double low, const double high) const;
+    // Turn each row into a cumulative distribution normalised to one
+    void Accumulate(std::vector<double> &spectrum, const std::string &name,
+                    std::vector<std::string> &problems) const;
+
+    std::vector<double> fBetaEdges;
+    std::vector<double> fBetaTagProbability;
+    std::vector<double> fBetaTagFraction;
+    std::vector<double> fGammaEdges;
+    std::vector<double> fGammaTagProbability;
+    std::vector<double> fGammaTagFraction;
+    std::vector<double> fGammaTransmission;
+    std::vector<double> fGammaScatterEscape;
+    int fSpectrumBins;
+    std::vector<double> fGammaScatterEnergy;
+    std::vector<double> fGammaScatterCosTheta;
+  };
+
+} // namespace RAT
+
+#endif
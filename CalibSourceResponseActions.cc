@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceResponseActions.hh>
+#include <RAT/GeoTaggedSourceFactory.hh>
+#include <RAT/GeoUFOFactory.hh>
+#include <RAT/TaggedSourceParams.hh>
+#include <RAT/UFOParams.hh>
+
+#include <RAT/DB.hh>
+#include <RAT/Log.hh>
+
+#include <G4Material.hh>
+#include <G4NistManager.hh>
+#include <G4Box.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4PVPlacement.hh>
+#include <G4ParticleGun.hh>
+#include <G4Electron.hh>
+#include <G4Gamma.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4Event.hh>
+#include <G4Step.hh>
+#include <G4Track.hh>
+#include <G4RunManager.hh>
+#include <G4Threading.hh>
+#include <G4RandomDirection.hh>
+#include <Randomize.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <vector>
+
+namespace RAT
+{
+  G4VPhysicalVolume* CalibSourceResponseDetector::Construct()
+  {
+    // The source goes in the middle of the world, and is simulated in full
+    DBLinkPtr table = DB::Get()->GetLink("GEO",fSettings.index);
+    DB::Get()->SetS("GEO",fSettings.index,"mother","world");
+    DB::Get()->SetDArray("GEO",fSettings.index,"sample_position",std::vector<double>(3,0.));
+    DB::Get()->SetI("GEO",fSettings.index,"fast_simulation",0);
+    DB::Get()->SetI("GEO",fSettings.index,"early_abort",0);
+
+    G4Material* worldMaterial = G4Material::GetMaterial(fWorldMaterial,false);
+    if(worldMaterial == NULL)
+      worldMaterial = G4NistManager::Instance()->FindOrBuildMaterial(fWorldMaterial);
+    Log::Assert(worldMaterial != NULL,"CalibSourceResponseDetector: No material " + fWorldMaterial + ".");
+    G4LogicalVolume* worldLog = new G4LogicalVolume(new G4Box("world_solid",CLHEP::m,CLHEP::m,CLHEP::m),
+                                                    worldMaterial,"world");
+    G4VPhysicalVolume* worldPhys = new G4PVPlacement(0,G4ThreeVector(),worldLog,"world",0,false,0);
+
+    std::string factory;
+    try {
+      factory = table->GetS("factory");
+    }
+    catch(DBNotFoundError &e) {
+      Log::Die("CalibSourceResponseDetector: DBNotFoundError. Table " + e.table + ", index " + e.index + ", field " + e.field + ".");
+    };
+
+    if(factory == "TaggedSource"){
+      Log::Assert(fSettings.mode == CalibSourceResponseSettings::kTagged,
+                  "CalibSourceResponseDetector: The tagged source has no optical response.");
+      GeoTaggedSourceFactory().Construct(table,false);
+      TaggedSourceParams params;
+      params.Load(table,"CalibSourceResponseDetector");
+      fSettings.geometryHash = params.GetHash();
+      // The isotope sits at the sample position
+      fSettings.origin = G4ThreeVector();
+    }
+    else if(factory == "UFO"){
+      Log::Assert(fSettings.mode == CalibSourceResponseSettings::kOptical,
+                  "CalibSourceResponseDetector: The UFO only has an optical response.");
+      GeoUFOFactory().Construct(table,false);
+      UFOParams params;
+      params.Load(table,"CalibSourceResponseDetector");
+      fSettings.geometryHash = params.GetHash();
+      // Just above the LED board
+      fSettings.origin = G4ThreeVector(0.,0.,-params.acrylicHeight/2.+params.acrylicLEDHeight+
+                                       params.electronicsThickness/2.+0.01*CLHEP::mm);
+    }
+    else
+      Log::Die("CalibSourceResponseDetector: No response can be made for factory " + factory + ".");
+    fSettings.axis = G4ThreeVector(0.,0.,1.);
+
+    return worldPhys;
+  } // Construct
+
+  void CalibSourceResponseDetector::ConstructSDandField()
+  {
+    GeoCalibSourceFactory::ConstructSDandField();
+  } // ConstructSDandField
+
+  void CalibSourceResponseEventAction::BeginOfEventAction(const G4Event *event)
+  {
+    fRecord = CalibSourceResponseEvent();
+    fRecord.tagEnergy = 0.;
+    fRecord.escaped = false;
+  } // BeginOfEventAction
+
+  void CalibSourceResponseEventAction::EndOfEventAction(const G4Event *event)
+  {
+    CalibSourceResponseRun* run =
+      static_cast<CalibSourceResponseRun*>(G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+    run->Record(fRecord);
+  } // EndOfEventAction
+
+  CalibSourceResponseGenerator::CalibSourceResponseGenerator(const CalibSourceResponseSettings &settings,
+                                                             CalibSourceResponseEventAction *eventAction)
+    : fSettings(settings), fEventAction(eventAction)
+  {
+    fGun = new G4ParticleGun(1);
+  }
+
+  CalibSourceResponseGenerator::~CalibSourceResponseGenerator()
+  {
+    delete fGun;
+  }
+
+  void CalibSourceResponseGenerator::GeneratePrimaries(G4Event *event)
+  {
+    CalibSourceResponseEvent &record = fEventAction->GetRecord();
+    G4ThreeVector direction = G4RandomDirection();
+    if(fSettings.mode == CalibSourceResponseSettings::kOptical){
+      if(direction.dot(fSettings.axis) < 0.)
+        direction = -direction;
+      record.isGamma = false;
+      record.energy = fSettings.photonEnergy;
+      fGun->SetParticleDefinition(G4OpticalPhoton::Definition());
+      fGun->SetParticlePolarization(direction.orthogonal().unit());
+    }
+    else {
+      record.isGamma = event->GetEventID() % 2;
+      record.energy = fSettings.minEnergy+(fSettings.maxEnergy-fSettings.minEnergy)*G4UniformRand();
+      fGun->SetParticleDefinition(record.isGamma ? G4Gamma::Definition() : G4Electron::Definition());
+    }
+    record.direction = direction;
+
+    fGun->SetParticleEnergy(record.energy);
+    fGun->SetParticleMomentumDirection(direction);
+    fGun->SetParticlePosition(fSettings.origin);
+    fGun->SetParticleTime(0.);
+    fGun->GeneratePrimaryVertex(event);
+  } // GeneratePrimaries
+
+  void CalibSourceResponseStepping::UserSteppingAction(const G4Step *step)
+  {
+    if(fWorld == NULL){
+      G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+      fWorld = store->GetVolume("world");
+      fScintillator = store->GetVolume(fIndex+"_scintillator_log",false);
+    }
+
+    CalibSourceResponseEvent &record = fEventAction->GetRecord();
+    if(fScintillator != NULL &&
+       step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume() == fScintillator)
+      record.tagEnergy += step->GetTotalEnergyDeposit();
+
+    // Nothing outside the source matters
+    const G4StepPoint* post = step->GetPostStepPoint();
+    if(post->GetStepStatus() != fGeomBoundary || post->GetPhysicalVolume() == NULL ||
+       post->GetPhysicalVolume()->GetLogicalVolume() != fWorld)
+      return;
+    G4Track* track = step->GetTrack();
+    if(track->GetParentID() == 0){
+      record.escaped = true;
+      record.escapeEnergy = post->GetKineticEnergy();
+      record.escapeDirection = post->GetMomentumDirection();
+      record.escapeTime = post->GetGlobalTime();
+    }
+    track->SetTrackStatus(fStopAndKill);
+  } // UserSteppingAction
+
+  G4Run* CalibSourceResponseRunAction::GenerateRun()
+  {
+    return new CalibSourceResponseRun(fSettings);
+  } // GenerateRun
+
+  void CalibSourceResponseRunAction::EndOfRunAction(const G4Run *run)
+  {
+    // The master's run holds the sum of the workers'
+    if(G4Threading::IsMasterThread())
+      static_cast<const CalibSourceResponseRun*>(run)->Write();
+  } // EndOfRunAction
+
+  void CalibSourceResponseActionInitialization::Build() const
+  {
+    CalibSourceResponseEventAction* eventAction = new CalibSourceResponseEventAction();
+    SetUserAction(eventAction);
+    SetUserAction(new CalibSourceResponseGenerator(fSettings,eventAction));
+    SetUserAction(new CalibSourceResponseStepping(fSettings.index,eventAction));
+    SetUserAction(new CalibSourceResponseRunAction(fSettings));
+  } // Build
+
+  void CalibSourceResponseActionInitialization::BuildForMaster() const
+  {
+    SetUserAction(new CalibSourceResponseRunAction(fSettings));
+  } // BuildForMaster
+} // namespace RAT
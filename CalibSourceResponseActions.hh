@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////
+// \file CalibSourceResponseActions.hh
+//
+// \brief Geometry and user actions of calib_source_response
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail The geometry is a single calibration source, built by its own
+//         factory from the loaded table, in an otherwise empty world. The
+//         source's envelope is the world's only daughter, so a particle
+//         has left the source when it steps into the world; it is not
+//         tracked any further.
+//
+//         Each event emits one particle from the settings' origin in a
+//         random direction: alternately an e- and a gamma with an energy
+//         drawn evenly over the tabulated range (tagged), or an optical
+//         photon heading into the upper hemisphere of the source axis
+//         (optical, the UFO's LED).
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceResponseActions__
+#define __RAT_CalibSourceResponseActions__
+
+#include <RAT/CalibSourceResponseRun.hh>
+
+#include <G4VUserDetectorConstruction.hh>
+#include <G4VUserPrimaryGeneratorAction.hh>
+#include <G4VUserActionInitialization.hh>
+#include <G4UserSteppingAction.hh>
+#include <G4UserEventAction.hh>
+#include <G4UserRunAction.hh>
+
+#include <string>
+
+class G4ParticleGun;
+class G4LogicalVolume;
+
+namespace RAT
+{
+
+  class CalibSourceResponseDetector : public G4VUserDetectorConstruction
+  {
+  public:
+    // Builds the source table[index]; fills in the origin, axis and
+    // geometry hash of the settings
+    CalibSourceResponseDetector(CalibSourceResponseSettings &settings,
+                                const std::string &worldMaterial)
+      : fSettings(settings), fWorldMaterial(worldMaterial) { };
+    virtual G4VPhysicalVolume* Construct();
+    // The source's detectors, fast models and profiler on each worker
+    virtual void ConstructSDandField();
+  protected:
+    CalibSourceResponseSettings &fSettings;
+    std::string fWorldMaterial;
+  };
+
+  class CalibSourceResponseEventAction : public G4UserEventAction
+  {
+  public:
+    CalibSourceResponseEventAction() { };
+    virtual void BeginOfEventAction(const G4Event *event);
+    virtual void EndOfEventAction(const G4Event *event);
+    CalibSourceResponseEvent& GetRecord() { return fRecord; };
+  protected:
+    CalibSourceResponseEvent fRecord;
+  };
+
+  class CalibSourceResponseGenerator : public G4VUserPrimaryGeneratorAction
+  {
+  public:
+    CalibSourceResponseGenerator(const CalibSourceResponseSettings &settings,
+                                 CalibSourceResponseEventAction *eventAction);
+    virtual ~CalibSourceResponseGenerator();
+    virtual void GeneratePrimaries(G4Event *event);
+  protected:
+    const CalibSourceResponseSettings &fSettings;
+    CalibSourceResponseEventAction *fEventAction;
+    G4ParticleGun *fGun;
+  };
+
+  class CalibSourceResponseStepping : public G4UserSteppingAction
+  {
+  public:
+    CalibSourceResponseStepping(const std::string &index,
+                                CalibSourceResponseEventAction *eventAction)
+      : fIndex(index), fEventAction(eventAction), fWorld(NULL), fScintillator(NULL) { };
+    virtual void UserSteppingAction(const G4Step *step);
+  protected:
+    std::string fIndex;
+    CalibSourceResponseEventAction *fEventAction;
+    // Looked up on the first step, once the geometry exists
+    G4LogicalVolume *fWorld;
+    G4LogicalVolume *fScintillator;
+  };
+
+  class CalibSourceResponseRunAction : public G4UserRunAction
+  {
+  public:
+    CalibSourceResponseRunAction(const CalibSourceResponseSettings &settings)
+      : fSettings(settings) { };
+    virtual G4Run* GenerateRun();
+    virtual void EndOfRunAction(const G4Run *run);
+  protected:
+    const CalibSourceResponseSettings &fSettings;
+  };
+
+  class CalibSourceResponseActionInitialization : public G4VUserActionInitialization
+  {
+  public:
+    CalibSourceResponseActionInitialization(const CalibSourceResponseSettings &settings)
+      : fSettings(settings) { };
+    virtual void Build() const;
+    virtual void BuildForMaster() const;
+  protected:
+    const CalibSourceResponseSettings &fSettings;
+  };
+
+} // namespace RAT
+
+#endif
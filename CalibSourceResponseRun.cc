@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceResponseRun.hh>
+
+#include <RAT/Log.hh>
+
+#include <G4SystemOfUnits.hh>
+
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+
+namespace RAT
+{
+  namespace
+  {
+    // Bin of value in [low,high) split into n, or -1 outside it
+    int FindBin(const double value, const double low, const double high, const int n)
+    {
+      if(value < low || value >= high)
+        return -1;
+      return std::min(n-1,static_cast<int>((value-low)/(high-low)*n));
+    }
+  }
+
+  CalibSourceResponseRun::CalibSourceResponseRun(const CalibSourceResponseSettings &settings)
+    : fSettings(settings), fPhotonsEmitted(0.), fPhotonsEscaped(0.)
+  {
+    const size_t nEnergy = settings.energyBins;
+    const size_t nSpectrum = settings.energyBins*settings.spectrumBins;
+    fBetaEmitted.assign(nEnergy,0.);
+    fBetaTagged.assign(nEnergy,0.);
+    fBetaTagFraction.assign(nEnergy,0.);
+    fGammaEmitted.assign(nEnergy,0.);
+    fGammaTagged.assign(nEnergy,0.);
+    fGammaTagFraction.assign(nEnergy,0.);
+    fGammaTransmitted.assign(nEnergy,0.);
+    fGammaScatterEscaped.assign(nEnergy,0.);
+    fGammaScatterEnergy.assign(nSpectrum,0.);
+    fGammaScatterCosTheta.assign(nSpectrum,0.);
+    fPhotonCosTheta.assign(settings.spectrumBins,0.);
+    fPhotonTime.assign(settings.timeBins,0.);
+  }
+
+  void CalibSourceResponseRun::Record(const CalibSourceResponseEvent &event)
+  {
+    const int nSpectrum = fSettings.spectrumBins;
+    if(fSettings.mode == CalibSourceResponseSettings::kOptical){
+      fPhotonsEmitted++;
+      if(!event.escaped)
+        return;
+      fPhotonsEscaped++;
+      const int cosBin = FindBin(event.escapeDirection.dot(fSettings.axis),-1.,1.+1e-12,nSpectrum);
+      if(cosBin >= 0)
+        fPhotonCosTheta[cosBin]++;
+      // Late photons go in the last bin
+      fPhotonTime[std::max(0,FindBin(std::min(event.escapeTime,fSettings.maxTime*(1.-1e-12)),
+                                     0.,fSettings.maxTime,fSettings.timeBins))]++;
+      return;
+    }
+
+    const int bin = FindBin(event.energy,fSettings.minEnergy,fSettings.maxEnergy,fSettings.energyBins);
+    if(bin < 0)
+      return;
+    const bool tagged = event.tagEnergy > 0.;
+    if(!event.isGamma){
+      fBetaEmitted[bin]++;
+      if(tagged){
+        fBetaTagged[bin]++;
+        fBetaTagFraction[bin] += event.tagEnergy/event.energy;
+      }
+      return;
+    }
+
+    fGammaEmitted[bin]++;
+    if(tagged){
+      fGammaTagged[bin]++;
+      fGammaTagFraction[bin] += event.tagEnergy/event.energy;
+    }
+    if(!event.escaped)
+      return;
+    const double cosTheta = event.escapeDirection.dot(event.direction);
+    if(event.escapeEnergy >= event.energy && cosTheta > 1.-1e-9){
+      fGammaTransmitted[bin]++;
+      return;
+    }
+    fGammaScatterEscaped[bin]++;
+    const int energyBin = FindBin(event.escapeEnergy/event.energy,0.,1.+1e-12,nSpectrum);
+    const int cosBin = FindBin(cosTheta,-1.,1.+1e-12,nSpectrum);
+    if(energyBin >= 0)
+      fGammaScatterEnergy[bin*nSpectrum+energyBin]++;
+    if(cosBin >= 0)
+      fGammaScatterCosTheta[bin*nSpectrum+cosBin]++;
+  } // Record
+
+  void CalibSourceResponseRun::Merge(const G4Run *run)
+  {
+    const CalibSourceResponseRun* other = static_cast<const CalibSourceResponseRun*>(run);
+    std::vector<double>* mine[] = {&fBetaEmitted,&fBetaTagged,&fBetaTagFraction,&fGammaEmitted,
+                                   &fGammaTagged,&fGammaTagFraction,&fGammaTransmitted,
+                                   &fGammaScatterEscaped,&fGammaScatterEnergy,&fGammaScatterCosTheta,
+                                   &fPhotonCosTheta,&fPhotonTime};
+    const std::vector<double>* theirs[] = {&other->fBetaEmitted,&other->fBetaTagged,&other->fBetaTagFraction,
+                                           &other->fGammaEmitted,&other->fGammaTagged,&other->fGammaTagFraction,
+                                           &other->fGammaTransmitted,&other->fGammaScatterEscaped,
+                                           &other->fGammaScatterEnergy,&other->fGammaScatterCosTheta,
+                                           &other->fPhotonCosTheta,&other->fPhotonTime};
+    for(size_t i=0; i<sizeof(mine)/sizeof(mine[0]); i++)
+      for(size_t j=0; j<mine[i]->size(); j++)
+        (*mine[i])[j] += (*theirs[i])[j];
+    fPhotonsEmitted += other->fPhotonsEmitted;
+    fPhotonsEscaped += other->fPhotonsEscaped;
+    G4Run::Merge(run);
+  } // Merge
+
+  void CalibSourceResponseRun::Write() const
+  {
+    std::ofstream out(fSettings.outputFile.c_str());
+    Log::Assert(out.good(),"CalibSourceResponseRun: Cannot write " + fSettings.outputFile + ".");
+    if(fSettings.mode == CalibSourceResponseSettings::kOptical)
+      WriteOptical(out);
+    else
+      WriteTagged(out);
+    info << "CalibSourceResponseRun: Wrote the response of " << fSettings.index << " from "
+         << GetNumberOfEvent() << " events to " << fSettings.outputFile << newline;
+  } // Write
+
+  void CalibSourceResponseRun::WriteTagged(std::ostream &out) const
+  {
+    std::vector<double> edges(fSettings.energyBins+1);
+    for(int i=0; i<=fSettings.energyBins; i++)
+      edges[i] = (fSettings.minEnergy+(fSettings.maxEnergy-fSettings.minEnergy)*i/fSettings.energyBins)/CLHEP::MeV;
+
+    out << "{\n"
+        << "type: \"CALIB_SOURCE_RESPONSE\",\n"
+        << "version: 1,\n"
+        << "index: \"" << fSettings.index << "\",\n"
+        << "run_range: [0, 0],\n"
+        << "pass: 0,\n"
+        << "comment: \"made by calib_source_response from " << GetNumberOfEvent() << " events\",\n"
+        << "timestamp: \"\",\n\n"
+        << "geometry_hash: \"" << fSettings.geometryHash << "\",\n\n";
+    WriteArray(out,"beta_energy_edges",edges);
+    WriteArray(out,"beta_tag_probability",PerEmitted(fBetaTagged,fBetaEmitted));
+    WriteArray(out,"beta_tag_fraction",PerEmitted(fBetaTagFraction,fBetaTagged));
+    WriteArray(out,"gamma_energy_edges",edges);
+    WriteArray(out,"gamma_tag_probability",PerEmitted(fGammaTagged,fGammaEmitted));
+    WriteArray(out,"gamma_tag_fraction",PerEmitted(fGammaTagFraction,fGammaTagged));
+    WriteArray(out,"gamma_transmission",PerEmitted(fGammaTransmitted,fGammaEmitted));
+    WriteArray(out,"gamma_scatter_escape",PerEmitted(fGammaScatterEscaped,fGammaEmitted));
+    out << "spectrum_bins: " << fSettings.spectrumBins << ",\n";
+    // The spectra are normalised when they are read
+    WriteArray(out,"gamma_scatter_energy",fGammaScatterEnergy);
+    WriteArray(out,"gamma_scatter_cos_theta",fGammaScatterCosTheta);
+    out << "}\n";
+  } // WriteTagged
+
+  void CalibSourceResponseRun::WriteOptical(std::ostream &out) const
+  {
+    std::vector<double> cosTheta(fPhotonCosTheta), time(fPhotonTime);
+    for(size_t i=0; i<cosTheta.size(); i++)
+      cosTheta[i] /= std::max(fPhotonsEscaped,1.);
+    for(size_t i=0; i<time.size(); i++)
+      time[i] /= std::max(fPhotonsEscaped,1.);
+
+    out << "{\n"
+        << "type: \"CALIB_SOURCE_OPTICAL_RESPONSE\",\n"
+        << "version: 1,\n"
+        << "index: \"" << fSettings.index << "\",\n"
+        << "run_range: [0, 0],\n"
+        << "pass: 0,\n"
+        << "comment: \"made by calib_source_response from " << GetNumberOfEvent() << " photons\",\n"
+        << "timestamp: \"\",\n\n"
+        << "geometry_hash: \"" << fSettings.geometryHash << "\",\n\n"
+        << "photon_energy: " << fSettings.photonEnergy/CLHEP::eV << ", // eV\n"
+        << "escape_probability: " << fPhotonsEscaped/std::max(fPhotonsEmitted,1.) << ",\n"
+        << "spectrum_bins: " << fSettings.spectrumBins << ",\n";
+    // Over [-1,1], to the source's z axis
+    WriteArray(out,"cos_theta_spectrum",cosTheta);
+    out << "time_max: " << fSettings.maxTime/CLHEP::ns << ", // ns\n"
+        << "time_bins: " << fSettings.timeBins << ",\n";
+    WriteArray(out,"time_spectrum",time);
+    out << "}\n";
+  } // WriteOptical
+
+  void CalibSourceResponseRun::WriteArray(std::ostream &out, const std::string &name,
+                                          const std::vector<double> &values)
+  {
+    out << name << ": [";
+    for(size_t i=0; i<values.size(); i++)
+      out << (i ? ", " : "") << values[i];
+    out << "],\n";
+  } // WriteArray
+
+  std::vector<double> CalibSourceResponseRun::PerEmitted(const std::vector<double> &counts,
+                                                         const std::vector<double> &emitted)
+  {
+    std::vector<double> fractions(counts.size(),0.);
+    for(size_t i=0; i<counts.size(); i++)
+      if(emitted[i] > 0.)
+        fractions[i] = counts[i]/emitted[i];
+    return fractions;
+  } // PerEmitted
+} // namespace RAT
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceResponseRun
+//
+// \brief Response of a calibration source accumulated over a run of
+//        calib_source_response
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Each event is one particle emitted in the source, and its fate
+//         is added to the histograms of its energy bin. Each worker thread
+//         fills its own run and the master merges them, then writes the
+//         totals as a RATDB table:
+//
+//           Tagged  CALIB_SOURCE_RESPONSE, the table CalibSourceResponse
+//                   reads (betas and gammas from the isotope)
+//           Optical CALIB_SOURCE_OPTICAL_RESPONSE: fraction of the LED's
+//                   photons that leave the source, and the spectra of
+//                   their direction (cosine to the source axis) and time
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceResponseRun__
+#define __RAT_CalibSourceResponseRun__
+
+#include <G4Run.hh>
+#include <G4ThreeVector.hh>
+
+#include <string>
+#include <vector>
+
+namespace RAT
+{
+
+  // What calib_source_response is making, shared by all its threads
+  struct CalibSourceResponseSettings
+  {
+    enum Mode { kTagged, kOptical };
+
+    Mode mode;
+    std::string index;
+    // Of the source parameters the response is for
+    std::string geometryHash;
+    std::string outputFile;
+    // Where particles start in the world, and (optical) about which axis
+    G4ThreeVector origin;
+    G4ThreeVector axis;
+    // Tagged: range and bins of the starting energy
+    double minEnergy;
+    double maxEnergy;
+    int energyBins;
+    // Bins of each spectrum
+    int spectrumBins;
+    // Optical: photon energy, and range and bins of the escape time
+    double photonEnergy;
+    double maxTime;
+    int timeBins;
+  };
+
+  // How one emitted particle ended up
+  struct CalibSourceResponseEvent
+  {
+    bool isGamma;
+    double energy;
+    G4ThreeVector direction;
+    // In the scintillator, from the particle and everything it made
+    double tagEnergy;
+    bool escaped;
+    double escapeEnergy;
+    G4ThreeVector escapeDirection;
+    double escapeTime;
+  };
+
+  class CalibSourceResponseRun : public G4Run
+  {
+  public:
+    CalibSourceResponseRun(const CalibSourceResponseSettings &settings);
+
+    void Record(const CalibSourceResponseEvent &event);
+    virtual void Merge(const G4Run *run);
+    // Write the table to the settings' output file
+    void Write() const;
+
+  protected:
+    void WriteTagged(std::ostream &out) const;
+    void WriteOptical(std::ostream &out) const;
+    static void WriteArray(std::ostream &out, const std::string &name,
+                           const std::vector<double> &values);
+    // Counts per energy bin, divided by the particles emitted in the bin
+    static std::vector<double> PerEmitted(const std::vector<double> &counts,
+                                          const std::vector<double> &emitted);
+
+    const CalibSourceResponseSettings &fSettings;
+
+    // Tagged, per energy bin (and spectrum bin)
+    std::vector<double> fBetaEmitted;
+    std::vector<double> fBetaTagged;
+    std::vector<double> fBetaTagFraction;
+    std::vector<double> fGammaEmitted;
+    std::vector<double> fGammaTagged;
+    std::vector<double> fGammaTagFraction;
+    std::vector<double> fGammaTransmitted;
+    std::vector<double> fGammaScatterEscaped;
+    std::vector<double> fGammaScatterEnergy;
+    std::vector<double> fGammaScatterCosTheta;
+
+    // Optical
+    double fPhotonsEmitted;
+    double fPhotonsEscaped;
+    std::vector<double> fPhotonCosTheta;
+    std::vector<double> fPhotonTime;
+  };
+
+} // namespace RAT
+
+#endif
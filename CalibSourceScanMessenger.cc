@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceScanMessenger.hh>
+#include <RAT/GeoCalibSourceFactory.hh>
+
+#include <RAT/DB.hh>
+#include <RAT/Log.hh>
+#include <RAT/string_utilities.hpp>
+
+#include <G4UIcommand.hh>
+#include <G4UIparameter.hh>
+#include <G4UIdirectory.hh>
+#include <G4RunManager.hh>
+#include <G4Run.hh>
+#include <G4ThreeVector.hh>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace RAT
+{
+  CalibSourceScanMessenger::CalibSourceScanMessenger()
+  {
+    fDirectory = new G4UIdirectory("/rat/calib/");
+    fDirectory->SetGuidance("Calibration source control");
+
+    fScanCmd = new G4UIcommand("/rat/calib/scan",this);
+    fScanCmd->SetGuidance("Run a calibration source through its scan_positions, one run per position");
+    G4UIparameter *indexParam = new G4UIparameter("index",'s',false);
+    indexParam->SetGuidance("Index of the source's geometry table");
+    fScanCmd->SetParameter(indexParam);
+    G4UIparameter *eventsParam = new G4UIparameter("events",'i',false);
+    eventsParam->SetGuidance("Number of events at each position");
+    eventsParam->SetParameterRange("events > 0");
+    fScanCmd->SetParameter(eventsParam);
+    fScanCmd->AvailableForStates(G4State_Idle);
+  }
+
+  CalibSourceScanMessenger::~CalibSourceScanMessenger()
+  {
+    delete fScanCmd;
+    delete fDirectory;
+  }
+
+  void CalibSourceScanMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+  {
+    if(command == fScanCmd){
+      std::istringstream values(newValue);
+      std::string index;
+      int nEvents = 0;
+      values >> index >> nEvents;
+      Scan(index,nEvents);
+    }
+  }
+
+  void CalibSourceScanMessenger::Scan(const std::string &index, const int nEvents)
+  {
+    DBLinkPtr table = GeoCalibSourceFactory::GetSourceTable(index);
+    const std::string tableName = table->GetName();
+    std::vector<double> positions, start;
+    // The table ships without points, so a scan must be given its own
+    try {
+      positions = table->GetDArray("scan_positions");
+    }
+    catch(DBNotFoundError &e) {
+      Log::Die("CalibSourceScanMessenger: " + index + " has no scan_positions; set them before /rat/calib/scan.");
+    };
+    try {
+      start = table->GetDArray("sample_position");
+    }
+    catch(DBNotFoundError &e) {
+      Log::Die("CalibSourceScanMessenger: DBNotFoundError. Table " + e.table + ", index " + e.index + ", field " + e.field + ".");
+    };
+    Log::Assert(!positions.empty() && positions.size() % 3 == 0,
+                "CalibSourceScanMessenger: scan_positions of " + index + " is not a list of (x, y, z) points.");
+    Log::Assert(start.size() == 3,"CalibSourceScanMessenger: sample_position does not have three components.");
+    std::string outputFile = index + "_scan.ratdb";
+    try {
+      outputFile = table->GetS("scan_output");
+    }
+    catch(DBNotFoundError &e) {
+    };
+    std::ofstream output(outputFile.c_str());
+    Log::Assert(output.good(),"CalibSourceScanMessenger: Cannot write " + outputFile + ".");
+
+    G4RunManager* runManager = G4RunManager::GetRunManager();
+    const int nPoints = positions.size()/3;
+    for(int point=0; point<nPoints; point++){
+      const G4ThreeVector position(positions[3*point]*CLHEP::mm,positions[3*point+1]*CLHEP::mm,
+                                   positions[3*point+2]*CLHEP::mm);
+      GeoCalibSourceFactory::MoveSource(index,position);
+      DB::Get()->SetI(tableName,index,"scan_point",point);
+      runManager->BeamOn(nEvents);
+      const int runID = runManager->GetCurrentRun()->GetRunID();
+      WritePoint(output,index,runID,point,position,nEvents);
+      Log::Assert(output.good(),"CalibSourceScanMessenger: Cannot write " + outputFile + ".");
+      info << "CalibSourceScanMessenger: " << index << " scan point " << point << " at ("
+           << position.x()/CLHEP::mm << ", " << position.y()/CLHEP::mm << ", "
+           << position.z()/CLHEP::mm << ") mm was run " << runID << newline;
+    }
+    info << "CalibSourceScanMessenger: Wrote the scan points of " << index << " to " << outputFile << newline;
+
+    GeoCalibSourceFactory::MoveSource(index,G4ThreeVector(start[0]*CLHEP::mm,start[1]*CLHEP::mm,
+                                                          start[2]*CLHEP::mm));
+  } // Scan
+
+  void CalibSourceScanMessenger::WritePoint(std::ostream &out, const std::string &index, const int runID,
+                                            const int point, const G4ThreeVector &position, const int nEvents)
+  {
+    out << "{\n"
+        << "type: \"CALIB_SOURCE_SCAN\",\n"
+        << "version: 1,\n"
+        << "index: \"" << index << "\",\n"
+        << "run_range: [" << runID << ", " << runID << "],\n"
+        << "pass: 0,\n"
+        << "comment: \"made by /rat/calib/scan\",\n"
+        << "timestamp: \"\",\n\n"
+        << "scan_point: " << point << ",\n"
+        << "sample_position: [" << position.x()/CLHEP::mm << ", " << position.y()/CLHEP::mm << ", "
+        << position.z()/CLHEP::mm << "], // mm\n"
+        << "events: " << nEvents << ",\n"
+        << "}\n\n";
+    out.flush();
+  } // WritePoint
+} // namespace RAT
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceScanMessenger
+//
+// \brief Runs a calibration source through a list of positions
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail The command
+//
+//             /rat/calib/scan <index> <events per position>
+//
+//         moves the source built from the table with that index to each
+//         point in its scan_positions field (x, y, z triples in mm) in
+//         turn, and runs the given number of events at each. The geometry
+//         is built once and the source is moved with
+//         GeoCalibSourceFactory::MoveSource, so a scan needs a single job.
+//
+//         Each point is its own run. Before the run the table's
+//         sample_position is set to the point and its scan_point field to
+//         the point's number (from 0). After the run the point is
+//         recorded with the run it went into: a CALIB_SOURCE_SCAN table
+//         whose run_range is that run alone, holding scan_point,
+//         sample_position (mm) and the number of events, is written to the
+//         file in the table's optional scan_output field (default
+//         <index>_scan.ratdb). Loaded with the run's output, it tells which
+//         point each run was taken at. After the scan the source goes back
+//         to where it started.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceScanMessenger__
+#define __RAT_CalibSourceScanMessenger__
+
+#include <G4UImessenger.hh>
+#include <G4ThreeVector.hh>
+
+#include <ostream>
+#include <string>
+
+class G4UIcommand;
+class G4UIdirectory;
+
+namespace RAT
+{
+
+  class CalibSourceScanMessenger : public G4UImessenger
+  {
+  public:
+    CalibSourceScanMessenger();
+    virtual ~CalibSourceScanMessenger();
+    virtual void SetNewValue(G4UIcommand *command, G4String newValue);
+  protected:
+    void Scan(const std::string &index, const int nEvents);
+    // The run-level record of one point, as a CALIB_SOURCE_SCAN table
+    // for that run alone
+    static void WritePoint(std::ostream &out, const std::string &index, const int runID,
+                           const int point, const G4ThreeVector &position, const int nEvents);
+
+    G4UIdirectory *fDirectory;
+    G4UIcommand *fScanCmd;
+  };
+
+} // namespace RAT
+
+#endif
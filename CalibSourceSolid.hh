@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceSolid
+//
+// \brief A Geant4 solid whose volume is known when it is built
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Boolean solids, multi-unions and (in older Geant4 releases)
+//         polycones estimate their volume by sampling random points the
+//         first time GetCubicVolume is called, which is slow and differs
+//         from one estimate to the next. The calibration source factories
+//         build those solids as CalibSourceSolid<G4SubtractionSolid> etc.
+//         instead and set the volume they worked out from the parameters
+//         (see CalibSourceVolume), so GetCubicVolume, and so the mass of
+//         the logical volume, is returned straight away. A negative volume
+//         (the default) leaves it to the solid as before.
+//
+//         It is the solid in every other way, entity type included.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceSolid__
+#define __RAT_CalibSourceSolid__
+
+#include <G4Types.hh>
+
+namespace RAT
+{
+
+  template<class Solid>
+  class CalibSourceSolid : public Solid
+  {
+  public:
+    using Solid::Solid;
+
+    // The volume GetCubicVolume returns, or negative to estimate it as usual
+    void SetCubicVolume(const double volume) { fAnalyticVolume = volume; };
+    // The volume set, or negative if none was
+    double GetAnalyticVolume() const { return fAnalyticVolume; };
+    virtual G4double GetCubicVolume()
+    {
+      return fAnalyticVolume >= 0. ? fAnalyticVolume : Solid::GetCubicVolume();
+    };
+
+  protected:
+    double fAnalyticVolume = -1.;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceSolidCache.hh>
+#include <RAT/CalibSourceSolid.hh>
+#include <RAT/CalibSourceHoleRing.hh>
+#include <RAT/CalibSourceStoreWatch.hh>
+
+#include <G4Tubs.hh>
+#include <G4Cons.hh>
+#include <G4Box.hh>
+#include <G4Polycone.hh>
+
+
+namespace RAT
+{
+  namespace
+  {
+    // The type, then the bytes of each value, so that shapes only match
+    // if every dimension is exactly the same
+    class Key
+    {
+    public:
+      Key(const std::string &type) : fKey(type) { fKey += '\0'; };
+      Key& operator<<(const double value)
+      {
+        fKey.append(reinterpret_cast<const char*>(&value),sizeof(value));
+        return *this;
+      };
+      Key& operator<<(const int value)
+      {
+        fKey.append(reinterpret_cast<const char*>(&value),sizeof(value));
+        return *this;
+      };
+      const std::string& Get() const { return fKey; };
+    protected:
+      std::string fKey;
+    };
+  }
+
+  std::map<std::string, G4VSolid*> CalibSourceSolidCache::fSolids;
+  unsigned long CalibSourceSolidCache::fGeneration = 0;
+  int CalibSourceSolidCache::fNShared = 0;
+
+  G4Tubs* CalibSourceSolidCache::Tubs(const std::string &name,
+                                      const double rInner,
+                                      const double rOuter,
+                                      const double halfLength,
+                                      const double startPhi,
+                                      const double deltaPhi)
+  {
+    const std::string key = (Key("G4Tubs") << rInner << rOuter << halfLength << startPhi << deltaPhi).Get();
+    G4VSolid* solid = Find(key);
+    if(solid != NULL)
+      return static_cast<G4Tubs*>(solid);
+    G4Tubs* tubs = new G4Tubs(name,rInner,rOuter,halfLength,startPhi,deltaPhi);
+    Add(key,tubs);
+    return tubs;
+  } // Tubs
+
+  G4Cons* CalibSourceSolidCache::Cons(const std::string &name,
+                                      const double rInnerLow,
+                                      const double rOuterLow,
+                                      const double rInnerHigh,
+                                      const double rOuterHigh,
+                                      const double halfLength,
+                                      const double startPhi,
+                                      const double deltaPhi)
+  {
+    const std::string key = (Key("G4Cons") << rInnerLow << rOuterLow << rInnerHigh << rOuterHigh
+                             << halfLength << startPhi << deltaPhi).Get();
+    G4VSolid* solid = Find(key);
+    if(solid != NULL)
+      return static_cast<G4Cons*>(solid);
+    G4Cons* cons = new G4Cons(name,rInnerLow,rOuterLow,rInnerHigh,rOuterHigh,halfLength,startPhi,deltaPhi);
+    Add(key,cons);
+    return cons;
+  } // Cons
+
+  G4Box* CalibSourceSolidCache::Box(const std::string &name,
+                                    const double halfX,
+                                    const double halfY,
+                                    const double halfZ)
+  {
+    const std::string key = (Key("G4Box") << halfX << halfY << halfZ).Get();
+    G4VSolid* solid = Find(key);
+    if(solid != NULL)
+      return static_cast<G4Box*>(solid);
+    G4Box* box = new G4Box(name,halfX,halfY,halfZ);
+    Add(key,box);
+    return box;
+  } // Box
+
+  G4VSolid* CalibSourceSolidCache::Polycone(const std::string &name,
+                                            const std::vector<double> &zPlanes,
+                                            const std::vector<double> &rInner,
+                                            const std::vector<double> &rOuter,
+                                            const double volume)
+  {
+    Key key("G4Polycone");
+    key << static_cast<int>(zPlanes.size());
+    for(size_t i=0; i<zPlanes.size(); i++)
+      key << zPlanes[i] << rInner[i] << rOuter[i];
+    G4VSolid* solid = Find(key.Get());
+    if(solid != NULL)
+      return solid;
+    CalibSourceSolid<G4Polycone>* polycone = new CalibSourceSolid<G4Polycone>(name,0.,CLHEP::twopi,zPlanes.size(),
+                                                                              &zPlanes[0],&rInner[0],&rOuter[0]);
+    polycone->SetCubicVolume(volume);
+    Add(key.Get(),polycone);
+    return polycone;
+  } // Polycone
+
+  CalibSourceHoleRing* CalibSourceSolidCache::HoleRing(const std::string &name,
+                                                       const int nHoles,
+                                                       const double holeRadius,
+                                                       const double halfLength,
+                                                       const double distance,
+                                                       const double firstAngle)
+  {
+    const std::string key = (Key("CalibSourceHoleRing") << nHoles << holeRadius << halfLength
+                             << distance << firstAngle).Get();
+    G4VSolid* solid = Find(key);
+    if(solid != NULL)
+      return static_cast<CalibSourceHoleRing*>(solid);
+    CalibSourceHoleRing* ring = new CalibSourceHoleRing(name,nHoles,holeRadius,halfLength,distance,firstAngle);
+    Add(key,ring);
+    return ring;
+  } // HoleRing
+
+  void CalibSourceSolidCache::Clear()
+  {
+    fSolids.clear();
+  } // Clear
+
+  G4VSolid* CalibSourceSolidCache::Find(const std::string &key)
+  {
+    // The solids went with the store when it was last cleaned
+    const unsigned long generation = CalibSourceStoreWatch::GetGeneration();
+    if(generation != fGeneration){
+      fSolids.clear();
+      fGeneration = generation;
+      return NULL;
+    }
+    std::map<std::string, G4VSolid*>::const_iterator entry = fSolids.find(key);
+    if(entry == fSolids.end())
+      return NULL;
+    fNShared++;
+    return entry->second;
+  } // Find
+
+  void CalibSourceSolidCache::Add(const std::string &key, G4VSolid *solid)
+  {
+    fSolids[key] = solid;
+  } // Add
+} // namespace RAT
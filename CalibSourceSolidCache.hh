@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceSolidCache
+//
+// \brief The primitive solids of the calibration sources, each shape
+//        made once
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail The factories ask here for their tubes, cones, boxes, polycones
+//         and hole rings instead of constructing them. A solid is kept
+//         under its type and the exact values of its dimensions, and a
+//         later request for the same shape, from any factory or any
+//         instance of a source, gets the same solid back. Geant4 then sets
+//         up (and voxelizes and draws) each shape once. A shared solid
+//         keeps the name of the part it was first made for.
+//
+//         Solids belong to the G4SolidStore, which deletes them when the
+//         geometry is cleaned. The cache forgets them all as soon as it
+//         sees the store has been cleaned (see CalibSourceStoreWatch), so
+//         a rebuilt geometry makes its solids afresh; until then a lookup
+//         is one map search. A cached solid must not be deleted on its
+//         own.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceSolidCache__
+#define __RAT_CalibSourceSolidCache__
+
+#include <G4Types.hh>
+
+#include <string>
+#include <vector>
+#include <map>
+
+class G4VSolid;
+class G4Tubs;
+class G4Cons;
+class G4Box;
+
+namespace RAT
+{
+
+  class CalibSourceHoleRing;
+
+  class CalibSourceSolidCache
+  {
+  public:
+    static G4Tubs* Tubs(const std::string &name,
+                        const double rInner,
+                        const double rOuter,
+                        const double halfLength,
+                        const double startPhi,
+                        const double deltaPhi);
+    static G4Cons* Cons(const std::string &name,
+                        const double rInnerLow,
+                        const double rOuterLow,
+                        const double rInnerHigh,
+                        const double rOuterHigh,
+                        const double halfLength,
+                        const double startPhi,
+                        const double deltaPhi);
+    static G4Box* Box(const std::string &name,
+                      const double halfX,
+                      const double halfY,
+                      const double halfZ);
+    // Full circle polycone, as a CalibSourceSolid with the volume given
+    static G4VSolid* Polycone(const std::string &name,
+                              const std::vector<double> &zPlanes,
+                              const std::vector<double> &rInner,
+                              const std::vector<double> &rOuter,
+                              const double volume);
+    static CalibSourceHoleRing* HoleRing(const std::string &name,
+                                         const int nHoles,
+                                         const double holeRadius,
+                                         const double halfLength,
+                                         const double distance,
+                                         const double firstAngle);
+
+    // Number of requests answered with an existing solid
+    static int GetNShared() { return fNShared; };
+    // Forget every solid, so the next requests make new ones
+    static void Clear();
+
+  protected:
+    // The solid made for key in this generation of the geometry
+    static G4VSolid* Find(const std::string &key);
+    static void Add(const std::string &key, G4VSolid *solid);
+
+    static std::map<std::string, G4VSolid*> fSolids;
+    // Of the geometry the solids were made for (see CalibSourceStoreWatch)
+    static unsigned long fGeneration;
+    static int fNShared;
+  };
+
+} // namespace RAT
+
+#endif
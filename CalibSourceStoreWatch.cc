@@ -0,0 +1,34 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceStoreWatch.hh>
+
+#include <G4Box.hh>
+#include <G4SystemOfUnits.hh>
+
+namespace RAT
+{
+  namespace
+  {
+    // Plain values, as the store (and so the sentinel) may be cleaned at
+    // exit, once other statics have gone
+    bool watching = false;
+    unsigned long generation = 0;
+
+    // Deleted only along with the whole store
+    class Sentinel : public G4Box
+    {
+    public:
+      Sentinel() : G4Box("calib_source_store_sentinel",CLHEP::mm,CLHEP::mm,CLHEP::mm) { watching = true; };
+      virtual ~Sentinel() { watching = false; generation++; };
+    };
+  }
+
+  unsigned long CalibSourceStoreWatch::GetGeneration()
+  {
+    if(!watching)
+      new Sentinel();
+    return generation;
+  } // GetGeneration
+} // namespace RAT
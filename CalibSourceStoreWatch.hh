@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceStoreWatch
+//
+// \brief Tells the calibration source caches when the geometry has been
+//        cleaned away
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Anything kept from one build of the geometry to the next is
+//         stamped with GetGeneration, and is stale once the generation has
+//         moved on. The watch puts a small solid of its own in the
+//         G4SolidStore; Geant4 deletes it with every other solid when the
+//         store is cleaned for a rebuild, and that counts as a new
+//         generation. Deleting single solids does not.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceStoreWatch__
+#define __RAT_CalibSourceStoreWatch__
+
+namespace RAT
+{
+
+  class CalibSourceStoreWatch
+  {
+  public:
+    // How many times the G4SolidStore has been cleaned since the first
+    // call
+    static unsigned long GetGeneration();
+  };
+
+} // namespace RAT
+
+#endif
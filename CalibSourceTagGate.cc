@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceTagGate.hh>
+
+#include <G4Step.hh>
+#include <Randomize.hh>
+
+namespace RAT
+{
+  CalibSourceTagGate::CalibSourceTagGate(const std::string &name, G4VSensitiveDetector *detector,
+                                         G4Region *region, const double energyThreshold,
+                                         const double efficiency, const bool accumulateOnly)
+    : G4VSensitiveDetector(name), fDetector(detector), fRegion(region),
+      fEnergyThreshold(energyThreshold), fEfficiency(efficiency), fAccumulateOnly(accumulateOnly),
+      fEnergy(0.), fDecided(false), fFired(false)
+  {
+  }
+
+  void CalibSourceTagGate::Initialize(G4HCofThisEvent *hitCollections)
+  {
+    fEnergy = 0.;
+    fDecided = false;
+    fFired = false;
+  } // Initialize
+
+  G4bool CalibSourceTagGate::ProcessHits(G4Step *step, G4TouchableHistory *history)
+  {
+    const double energy = step->GetTotalEnergyDeposit();
+    fEnergy += energy;
+    if(!fAccumulateOnly)
+      return fDetector->Hit(step);
+    if(fDecided)
+      return false;
+
+    // The threshold is on the whole event's deposit, which is never below
+    // what CalibPMTSD compares with, so no event it would tag is lost
+    if(fEnergy <= 0. || fEnergy < fEnergyThreshold)
+      return false;
+    fDecided = true;
+    fFired = G4UniformRand() < fEfficiency;
+    if(!fFired)
+      return false;
+    // One hit at the step that crosses the threshold, carrying the sum
+    step->SetTotalEnergyDeposit(fEnergy);
+    const G4bool hit = fDetector->Hit(step);
+    step->SetTotalEnergyDeposit(energy);
+    return hit;
+  } // ProcessHits
+
+  G4bool CalibSourceTagGate::Fires()
+  {
+    if(!fDecided && fEnergy > 0. && fEnergy >= fEnergyThreshold){
+      fDecided = true;
+      fFired = G4UniformRand() < fEfficiency;
+    }
+    return fFired;
+  } // Fires
+} // namespace RAT
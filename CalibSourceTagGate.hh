@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceTagGate
+//
+// \brief Sensitive detector in front of a tagged source's CalibPMTSD that
+//        decides whether the tag fires
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//     17/10/2026 : Accumulate only mode. \n
+//
+//
+// \detail The energy deposited in the scintillator (including tags from
+//         the fast model) is summed over the event. Once the sum reaches
+//         the threshold the efficiency is drawn, once per event, to decide
+//         whether the tag fires. The CalibPMTSD behind a gate is built with
+//         an efficiency of 1, so the efficiency is applied only once.
+//
+//         By default every step is passed on to CalibPMTSD unchanged.
+//         Accumulate only keeps just the running sum: a tag that fires
+//         reaches CalibPMTSD as one step, the one that crosses the
+//         threshold, carrying the whole sum. Other steps cost an addition
+//         and make no hits. Each thread has its own detectors, so the sum
+//         needs no locking.
+//
+//         CalibSourceEarlyAbort asks every gate once the tracks in the
+//         sources are done.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceTagGate__
+#define __RAT_CalibSourceTagGate__
+
+#include <G4VSensitiveDetector.hh>
+
+#include <string>
+
+class G4Region;
+
+namespace RAT
+{
+
+  class CalibSourceTagGate : public G4VSensitiveDetector
+  {
+  public:
+    // The gate of a source in region, in front of detector
+    CalibSourceTagGate(const std::string &name, G4VSensitiveDetector *detector,
+                       G4Region *region, const double energyThreshold,
+                       const double efficiency, const bool accumulateOnly = false);
+    virtual ~CalibSourceTagGate() { };
+
+    virtual void Initialize(G4HCofThisEvent *hitCollections);
+    virtual G4bool ProcessHits(G4Step *step, G4TouchableHistory *history);
+
+    // Whether the tag fires this event, on the energy so far
+    G4bool Fires();
+    // The region of the source, in which the tag is decided
+    G4Region* GetRegion() const { return fRegion; };
+
+  protected:
+    G4VSensitiveDetector *fDetector;
+    G4Region *fRegion;
+    double fEnergyThreshold;
+    double fEfficiency;
+    G4bool fAccumulateOnly;
+    // Deposited in the scintillator so far this event, and the tag once
+    // the threshold has been reached
+    double fEnergy;
+    G4bool fDecided;
+    G4bool fFired;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,350 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceVolume.hh>
+
+#include <G4VSolid.hh>
+#include <G4Tubs.hh>
+#include <G4Cons.hh>
+#include <G4Polycone.hh>
+#include <G4DisplacedSolid.hh>
+#include <G4MultiUnion.hh>
+#include <G4GeometryTolerance.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace RAT
+{
+  namespace
+  {
+    // 16 point Gauss-Legendre abscissae and weights on [-1,1], one of each
+    // symmetric pair
+    const double kAbscissae[8] = {0.0950125098376374,0.2816035507792589,0.4580167776572274,
+                                  0.6178762444026438,0.7554044083550030,0.8656312023878318,
+                                  0.9445750230732326,0.9894009349916499};
+    const double kWeights[8] = {0.1894506104550685,0.1826034150449236,0.1691565193950025,
+                                0.1495959888165767,0.1246289712555339,0.0951585116824928,
+                                0.0622535239386479,0.0271524594117541};
+  }
+
+  double CalibSourceVolume::Axial(const std::vector<double> &zPlanes,
+                                  const std::vector<double> &rInner,
+                                  const std::vector<double> &rOuter)
+  {
+    // A frustum per section between planes
+    double volume = 0.;
+    for(size_t i=0; i+1<zPlanes.size(); i++)
+      volume += std::fabs(zPlanes[i+1]-zPlanes[i])*CLHEP::pi/3.*
+        (rOuter[i]*rOuter[i]+rOuter[i]*rOuter[i+1]+rOuter[i+1]*rOuter[i+1]-
+         rInner[i]*rInner[i]-rInner[i]*rInner[i+1]-rInner[i+1]*rInner[i+1]);
+    return volume;
+  } // Axial
+
+  double CalibSourceVolume::Coaxial(const G4VSolid *solid)
+  {
+    Node root;
+    if(!Build(solid,0.,root))
+      return -1.;
+    std::vector<double> planes;
+    Planes(root,planes);
+    if(planes.empty())
+      return 0.;
+    const std::vector<double> slabs = Slabs(root,*std::min_element(planes.begin(),planes.end()),
+                                            *std::max_element(planes.begin(),planes.end()),
+                                            std::vector<double>());
+
+    // The area of each section is quadratic in z across a slab
+    double volume = 0.;
+    for(size_t k=0; k+1<slabs.size(); k++){
+      const double zMid = (slabs[k]+slabs[k+1])/2.;
+      const double z[3] = {slabs[k],zMid,slabs[k+1]};
+      double area[3] = {0.,0.,0.};
+      for(int i=0; i<3; i++){
+        const Intervals section = Section(root,zMid,z[i]);
+        for(size_t j=0; j<section.size(); j++)
+          area[i] += CLHEP::pi*(section[j].second*section[j].second-section[j].first*section[j].first);
+      }
+      volume += (slabs[k+1]-slabs[k])*(area[0]+4.*area[1]+area[2])/6.;
+    }
+    return volume;
+  } // Coaxial
+
+  double CalibSourceVolume::CoaxialHole(const G4VSolid *solid,
+                                        const double holeRadius,
+                                        const double holeDistance,
+                                        const double zLow,
+                                        const double zHigh)
+  {
+    Node root;
+    if(!Build(solid,0.,root))
+      return -1.;
+    // The overlap with an annulus edge changes form where the edge meets
+    // the near or far side of the hole
+    std::vector<double> radii;
+    radii.push_back(holeDistance-holeRadius);
+    radii.push_back(holeDistance+holeRadius);
+    const std::vector<double> slabs = Slabs(root,zLow,zHigh,radii);
+
+    double volume = 0.;
+    for(size_t k=0; k+1<slabs.size(); k++){
+      const double zMid = (slabs[k]+slabs[k+1])/2.;
+      const double halfLength = (slabs[k+1]-slabs[k])/2.;
+      for(int i=0; i<16; i++){
+        const double z = zMid+(i < 8 ? -kAbscissae[i] : kAbscissae[i-8])*halfLength;
+        const Intervals section = Section(root,zMid,z);
+        double area = 0.;
+        for(size_t j=0; j<section.size(); j++)
+          area += LensArea(section[j].second,holeRadius,holeDistance)-
+            LensArea(section[j].first,holeRadius,holeDistance);
+        volume += kWeights[i%8]*halfLength*area;
+      }
+    }
+    return volume;
+  } // CoaxialHole
+
+  double CalibSourceVolume::LensArea(const double radius,
+                                     const double holeRadius,
+                                     const double holeDistance)
+  {
+    if(radius <= 0. || holeRadius <= 0. || holeDistance >= radius+holeRadius)
+      return 0.;
+    if(holeDistance <= std::fabs(radius-holeRadius))
+      return CLHEP::pi*std::min(radius,holeRadius)*std::min(radius,holeRadius);
+    // A circular segment of each disc, cut off by the common chord
+    const double cosAlpha = (holeDistance*holeDistance+radius*radius-holeRadius*holeRadius)/
+      (2.*holeDistance*radius);
+    const double cosBeta = (holeDistance*holeDistance+holeRadius*holeRadius-radius*radius)/
+      (2.*holeDistance*holeRadius);
+    const double alpha = std::acos(std::max(-1.,std::min(1.,cosAlpha)));
+    const double beta = std::acos(std::max(-1.,std::min(1.,cosBeta)));
+    return radius*radius*(alpha-std::sin(alpha)*std::cos(alpha))+
+      holeRadius*holeRadius*(beta-std::sin(beta)*std::cos(beta));
+  } // LensArea
+
+  double CalibSourceVolume::SquareDiscArea(const double halfWidth, const double radius)
+  {
+    if(radius <= halfWidth)
+      return CLHEP::pi*radius*radius;
+    if(radius >= std::sqrt(2.)*halfWidth)
+      return 4.*halfWidth*halfWidth;
+    // The disc less the four segments beyond the sides
+    const double segment = radius*radius*std::acos(halfWidth/radius)-
+      halfWidth*std::sqrt(radius*radius-halfWidth*halfWidth);
+    return CLHEP::pi*radius*radius-4.*segment;
+  } // SquareDiscArea
+
+  bool CalibSourceVolume::Build(const G4VSolid *solid, const double zShift, Node &node)
+  {
+    const double angleTolerance = G4GeometryTolerance::GetInstance()->GetAngularTolerance();
+    const G4String type = solid->GetEntityType();
+    if(type == "G4Tubs"){
+      const G4Tubs* tubs = static_cast<const G4Tubs*>(solid);
+      if(tubs->GetDeltaPhiAngle() < CLHEP::twopi-angleTolerance)
+        return false;
+      node = Frustum(zShift-tubs->GetZHalfLength(),zShift+tubs->GetZHalfLength(),
+                     tubs->GetInnerRadius(),tubs->GetInnerRadius(),
+                     tubs->GetOuterRadius(),tubs->GetOuterRadius());
+      return true;
+    }
+    if(type == "G4Cons"){
+      const G4Cons* cons = static_cast<const G4Cons*>(solid);
+      if(cons->GetDeltaPhiAngle() < CLHEP::twopi-angleTolerance)
+        return false;
+      node = Frustum(zShift-cons->GetZHalfLength(),zShift+cons->GetZHalfLength(),
+                     cons->GetInnerRadiusMinusZ(),cons->GetInnerRadiusPlusZ(),
+                     cons->GetOuterRadiusMinusZ(),cons->GetOuterRadiusPlusZ());
+      return true;
+    }
+    if(type == "G4Polycone"){
+      const G4PolyconeHistorical* original = static_cast<const G4Polycone*>(solid)->GetOriginalParameters();
+      if(original == NULL || original->Opening_angle < CLHEP::twopi-angleTolerance)
+        return false;
+      node = Node();
+      for(int i=0; i+1<original->Num_z_planes; i++)
+        if(original->Z_values[i+1] != original->Z_values[i])
+          node.children.push_back(Frustum(zShift+original->Z_values[i],zShift+original->Z_values[i+1],
+                                          original->Rmin[i],original->Rmin[i+1],
+                                          original->Rmax[i],original->Rmax[i+1]));
+      return true;
+    }
+    if(type == "G4UnionSolid" || type == "G4SubtractionSolid" || type == "G4IntersectionSolid"){
+      node = Node();
+      node.operation = type == "G4UnionSolid" ? Node::kUnion :
+        type == "G4SubtractionSolid" ? Node::kSubtraction : Node::kIntersection;
+      node.children.resize(2);
+      return Build(solid->GetConstituentSolid(0),zShift,node.children[0]) &&
+        Build(solid->GetConstituentSolid(1),zShift,node.children[1]);
+    }
+    if(type == "G4DisplacedSolid"){
+      const G4DisplacedSolid* displaced = static_cast<const G4DisplacedSolid*>(solid);
+      const G4ThreeVector translation = displaced->GetObjectTranslation();
+      return OnAxis(displaced->GetObjectRotation(),translation) &&
+        Build(displaced->GetConstituentMovedSolid(),zShift+translation.z(),node);
+    }
+    if(type == "G4MultiUnion"){
+      const G4MultiUnion* multiUnion = static_cast<const G4MultiUnion*>(solid);
+      node = Node();
+      node.children.resize(multiUnion->GetNumberOfSolids());
+      for(int i=0; i<multiUnion->GetNumberOfSolids(); i++){
+        const G4Transform3D &transform = multiUnion->GetTransformation(i);
+        const G4ThreeVector translation = transform.getTranslation();
+        if(!OnAxis(transform.getRotation(),translation) ||
+           !Build(multiUnion->GetSolid(i),zShift+translation.z(),node.children[i]))
+          return false;
+      }
+      return true;
+    }
+    return false;
+  } // Build
+
+  CalibSourceVolume::Node CalibSourceVolume::Frustum(double z0, double z1, double rInner0, double rInner1,
+                                                     double rOuter0, double rOuter1)
+  {
+    if(z1 < z0){
+      std::swap(z0,z1);
+      std::swap(rInner0,rInner1);
+      std::swap(rOuter0,rOuter1);
+    }
+    Node frustum;
+    frustum.operation = Node::kFrustum;
+    frustum.zLow = z0;
+    frustum.zHigh = z1;
+    frustum.rInnerLow = rInner0;
+    frustum.rInnerHigh = rInner1;
+    frustum.rOuterLow = rOuter0;
+    frustum.rOuterHigh = rOuter1;
+    return frustum;
+  } // Frustum
+
+  bool CalibSourceVolume::OnAxis(const G4RotationMatrix &rotation, const G4ThreeVector &translation)
+  {
+    // Turning a round part about its axis leaves it as it is
+    return (rotation*G4ThreeVector(0.,0.,1.)).z() > 1.-1e-12 &&
+      translation.perp() <= G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+  } // OnAxis
+
+  std::vector<double> CalibSourceVolume::Slabs(const Node &root, const double zLow, const double zHigh,
+                                               const std::vector<double> &radii)
+  {
+    std::vector<double> planes;
+    Planes(root,planes);
+    planes.push_back(zLow);
+    planes.push_back(zHigh);
+    std::sort(planes.begin(),planes.end());
+    planes.erase(std::unique(planes.begin(),planes.end()),planes.end());
+    planes.erase(std::remove_if(planes.begin(),planes.end(),
+                                [&](const double z) { return z < zLow || z > zHigh; }),planes.end());
+
+    std::vector<double> slabs(planes);
+    for(size_t k=0; k+1<planes.size(); k++){
+      std::vector<std::pair<double, double> > edges;
+      Edges(root,(planes[k]+planes[k+1])/2.,edges);
+      for(size_t i=0; i<radii.size(); i++)
+        edges.push_back(std::make_pair(radii[i],0.));
+      for(size_t i=0; i<edges.size(); i++)
+        for(size_t j=i+1; j<edges.size(); j++){
+          if(edges[i].second == edges[j].second)
+            continue;
+          const double z = (edges[j].first-edges[i].first)/(edges[i].second-edges[j].second);
+          if(z > planes[k] && z < planes[k+1])
+            slabs.push_back(z);
+        }
+    }
+    std::sort(slabs.begin(),slabs.end());
+    slabs.erase(std::unique(slabs.begin(),slabs.end()),slabs.end());
+    return slabs;
+  } // Slabs
+
+  void CalibSourceVolume::Planes(const Node &node, std::vector<double> &planes)
+  {
+    if(node.operation == Node::kFrustum){
+      planes.push_back(node.zLow);
+      planes.push_back(node.zHigh);
+      return;
+    }
+    for(size_t i=0; i<node.children.size(); i++)
+      Planes(node.children[i],planes);
+  } // Planes
+
+  void CalibSourceVolume::Edges(const Node &node, const double zMid,
+                                std::vector<std::pair<double, double> > &edges)
+  {
+    if(node.operation != Node::kFrustum){
+      for(size_t i=0; i<node.children.size(); i++)
+        Edges(node.children[i],zMid,edges);
+      return;
+    }
+    if(zMid <= node.zLow || zMid >= node.zHigh)
+      return;
+    const double length = node.zHigh-node.zLow;
+    const double innerSlope = (node.rInnerHigh-node.rInnerLow)/length;
+    const double outerSlope = (node.rOuterHigh-node.rOuterLow)/length;
+    edges.push_back(std::make_pair(node.rInnerLow-innerSlope*node.zLow,innerSlope));
+    edges.push_back(std::make_pair(node.rOuterLow-outerSlope*node.zLow,outerSlope));
+  } // Edges
+
+  CalibSourceVolume::Intervals CalibSourceVolume::Section(const Node &node, const double zMid,
+                                                          const double z)
+  {
+    Intervals section;
+    if(node.operation == Node::kFrustum){
+      if(zMid <= node.zLow || zMid >= node.zHigh)
+        return section;
+      const double f = (z-node.zLow)/(node.zHigh-node.zLow);
+      const double rInner = std::max(0.,node.rInnerLow+f*(node.rInnerHigh-node.rInnerLow));
+      const double rOuter = node.rOuterLow+f*(node.rOuterHigh-node.rOuterLow);
+      if(rOuter > rInner)
+        section.push_back(std::make_pair(rInner,rOuter));
+      return section;
+    }
+    if(node.children.empty())
+      return section;
+    section = Section(node.children[0],zMid,z);
+    for(size_t i=1; i<node.children.size(); i++)
+      section = Combine(section,Section(node.children[i],zMid,z),node.operation);
+    return section;
+  } // Section
+
+  CalibSourceVolume::Intervals CalibSourceVolume::Combine(const Intervals &a, const Intervals &b,
+                                                          const Node::Operation operation)
+  {
+    // Decide each piece between consecutive edges by its middle
+    std::vector<double> edges;
+    for(size_t i=0; i<a.size(); i++){
+      edges.push_back(a[i].first);
+      edges.push_back(a[i].second);
+    }
+    for(size_t i=0; i<b.size(); i++){
+      edges.push_back(b[i].first);
+      edges.push_back(b[i].second);
+    }
+    std::sort(edges.begin(),edges.end());
+    edges.erase(std::unique(edges.begin(),edges.end()),edges.end());
+
+    Intervals result;
+    for(size_t i=0; i+1<edges.size(); i++){
+      const double r = (edges[i]+edges[i+1])/2.;
+      const bool inA = Contains(a,r);
+      const bool inB = Contains(b,r);
+      const bool in = operation == Node::kUnion ? inA || inB :
+        operation == Node::kSubtraction ? inA && !inB : inA && inB;
+      if(!in)
+        continue;
+      if(!result.empty() && result.back().second == edges[i])
+        result.back().second = edges[i+1];
+      else
+        result.push_back(std::make_pair(edges[i],edges[i+1]));
+    }
+    return result;
+  } // Combine
+
+  bool CalibSourceVolume::Contains(const Intervals &intervals, const double r)
+  {
+    for(size_t i=0; i<intervals.size(); i++)
+      if(intervals[i].first < r && r < intervals[i].second)
+        return true;
+    return false;
+  } // Contains
+} // namespace RAT
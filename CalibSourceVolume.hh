@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::CalibSourceVolume
+//
+// \brief Exact volumes of the solids the calibration source factories
+//        build
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version. \n
+//
+//
+// \detail Most parts of the sources are coaxial: full circle tubes, cones
+//         and polycones on a common z axis, shifted along it and combined
+//         by union, subtraction and intersection (plain, multi-union or
+//         displaced). Coaxial walks such a solid and cuts it into slabs at
+//         every plane of its parts and wherever two of their radii cross.
+//         Within a slab every cross section is the same set of annuli with
+//         edges linear in z, so its area is quadratic in z and Simpson's
+//         rule gives the slab's volume exactly.
+//
+//         Holes drilled parallel to the axis (screw holes round a flange)
+//         are taken out with CoaxialHole, which adds up the lens shaped
+//         overlap of the hole with each annulus; it is exact over
+//         cylindrical sections and integrated to 16 point Gauss-Legendre
+//         over conical ones. Parts with corners (boxes) are left to the
+//         factories, which know how they meet and use SquareDiscArea.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_CalibSourceVolume__
+#define __RAT_CalibSourceVolume__
+
+#include <G4ThreeVector.hh>
+#include <G4RotationMatrix.hh>
+
+#include <vector>
+#include <utility>
+
+class G4VSolid;
+
+namespace RAT
+{
+
+  class CalibSourceVolume
+  {
+  public:
+    // Volume of the solid of revolution through the given planes, as for a
+    // polycone
+    static double Axial(const std::vector<double> &zPlanes,
+                        const std::vector<double> &rInner,
+                        const std::vector<double> &rOuter);
+    // Volume of a coaxial solid, or negative if the solid is not one
+    static double Coaxial(const G4VSolid *solid);
+    // Volume a coaxial solid shares with a cylinder of radius holeRadius
+    // parallel to its axis at holeDistance from it, between zLow and
+    // zHigh; negative if the solid is not coaxial
+    static double CoaxialHole(const G4VSolid *solid,
+                              const double holeRadius,
+                              const double holeDistance,
+                              const double zLow,
+                              const double zHigh);
+    // Area a disc of radius radius on the axis shares with one of radius
+    // holeRadius at holeDistance from it
+    static double LensArea(const double radius,
+                           const double holeRadius,
+                           const double holeDistance);
+    // Area a square of half width halfWidth and a disc of radius radius
+    // share, both centred on the axis
+    static double SquareDiscArea(const double halfWidth, const double radius);
+
+  protected:
+    // A coaxial solid: a frustum shell, or the parts combined
+    struct Node
+    {
+      enum Operation { kFrustum, kUnion, kSubtraction, kIntersection };
+      Node() : operation(kUnion), zLow(0.), zHigh(0.), rInnerLow(0.), rInnerHigh(0.),
+               rOuterLow(0.), rOuterHigh(0.) { };
+      Operation operation;
+      std::vector<Node> children;
+      double zLow;
+      double zHigh;
+      double rInnerLow;
+      double rInnerHigh;
+      double rOuterLow;
+      double rOuterHigh;
+    };
+    // Radial intervals of a cross section, in order
+    typedef std::vector<std::pair<double, double> > Intervals;
+
+    static bool Build(const G4VSolid *solid, const double zShift, Node &node);
+    static Node Frustum(double z0, double z1, double rInner0, double rInner1,
+                        double rOuter0, double rOuter1);
+    static bool OnAxis(const G4RotationMatrix &rotation, const G4ThreeVector &translation);
+    // The planes at which the solid's cross section can change shape
+    // between zLow and zHigh, including where its radii cross each other
+    // or any of radii
+    static std::vector<double> Slabs(const Node &root, const double zLow, const double zHigh,
+                                     const std::vector<double> &radii);
+    static void Planes(const Node &node, std::vector<double> &planes);
+    // Each edge of the frusta across the slab through zMid, as r = a + b z
+    static void Edges(const Node &node, const double zMid,
+                      std::vector<std::pair<double, double> > &edges);
+    // The cross section at z of the slab through zMid
+    static Intervals Section(const Node &node, const double zMid, const double z);
+    static Intervals Combine(const Intervals &a, const Intervals &b,
+                             const Node::Operation operation);
+    static bool Contains(const Intervals &intervals, const double r);
+  };
+
+} // namespace RAT
+
+#endif
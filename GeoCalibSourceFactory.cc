@@ -0,0 +1,1050 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/GeoCalibSourceFactory.hh>
+#include <RAT/BoltCircleParameterisation.hh>
+#include <RAT/CalibSourceScanMessenger.hh>
+#include <RAT/CalibPMTSD.hh>
+#include <RAT/CalibSourceFastModel.hh>
+#include <RAT/CalibSourceResponse.hh>
+#include <RAT/CalibSourceTagGate.hh>
+#include <RAT/CalibSourceEarlyAbort.hh>
+#include <RAT/CalibSourceProfiler.hh>
+#include <RAT/CalibSourceSolid.hh>
+#include <RAT/CalibSourceVolume.hh>
+#include <RAT/CalibSourceGeometryCache.hh>
+#include <RAT/CalibSourceHoleRing.hh>
+#include <RAT/CalibSourceSolidCache.hh>
+
+#include <RAT/DB.hh>
+#include <RAT/Log.hh>
+#include <RAT/string_utilities.hpp>
+
+#include <G4Material.hh>
+
+#include <G4ThreeVector.hh>
+#include <G4RotationMatrix.hh>
+
+#include <G4Tubs.hh>
+#include <G4Cons.hh>
+#include <G4Box.hh>
+#include <G4Polycone.hh>
+#include <G4UnionSolid.hh>
+#include <G4SubtractionSolid.hh>
+#include <G4MultiUnion.hh>
+#include <G4DisplacedSolid.hh>
+#include <G4LogicalVolume.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4PVParameterised.hh>
+#include <G4GeometryTolerance.hh>
+#include <G4GeometryManager.hh>
+#include <G4PhysicalVolumeStore.hh>
+#include <G4SDManager.hh>
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
+#include <G4ProductionCuts.hh>
+#include <G4ProductionCutsTable.hh>
+#include <G4UserLimits.hh>
+
+#include <G4VisAttributes.hh>
+#include <G4Color.hh>
+#include <G4VVisManager.hh>
+#include <G4UImanager.hh>
+#include <G4UIbatch.hh>
+
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+namespace RAT
+{
+  namespace
+  {
+    // Keep the volume on the solid: the one given, or else the exact one if
+    // the solid is coaxial
+    template<class Solid>
+    G4VSolid* WithVolume(CalibSourceSolid<Solid> *solid, const double volume)
+    {
+      solid->SetCubicVolume(volume >= 0. ? volume : CalibSourceVolume::Coaxial(solid));
+      return solid;
+    }
+
+    const char* const kDetailLevelNames[] = { "full", "reduced", "envelope-only" };
+
+    // Raise whenever a change to the code the factories share alters what
+    // they build (see GetGeometryVersion)
+    const int kGeometryVersion = 1;
+  }
+
+  std::map<std::string, G4VisAttributes*> GeoCalibSourceFactory::fVisAttributes;
+  std::map<std::string, GeoCalibSourceFactory::PlacedSource> GeoCalibSourceFactory::fPlacedSources;
+  CalibSourceScanMessenger* GeoCalibSourceFactory::fScanMessenger = NULL;
+  std::vector<GeoCalibSourceFactory::SensitiveVolume> GeoCalibSourceFactory::fSensitiveVolumes;
+  std::vector<GeoCalibSourceFactory::FastSimulatedSource> GeoCalibSourceFactory::fFastSimulatedSources;
+  unsigned long GeoCalibSourceFactory::fGeneration = 0;
+  std::map<const G4Material*, std::map<G4Material*, double> > GeoCalibSourceFactory::fMixtures;
+
+  GeoCalibSourceFactory::GeoCalibSourceFactory(const std::string &name, const int geometryVersion)
+    : GeoFactory(name)
+  {
+    fGeometryVersion = name + "-" + to_string(kGeometryVersion) + "." + to_string(geometryVersion);
+    // One set of commands for all the calibration sources
+    if(fScanMessenger == NULL)
+      fScanMessenger = new CalibSourceScanMessenger();
+  }
+
+  void GeoCalibSourceFactory::SetColor(DBLinkPtr table, G4String colorName, G4LogicalVolume *logicalVolume)
+  {
+    // Set the color of a logical volume, noting it for a cached build
+    fNotes[logicalVolume].push_back("colour " + colorName);
+    if(IsBatchMode(table))
+      return;
+
+    const std::string key = table->GetName() + "[" + table->GetIndex() + "]." + colorName;
+    std::map<std::string, G4VisAttributes*>::const_iterator found = fVisAttributes.find(key);
+    if(found != fVisAttributes.end()){
+      logicalVolume->SetVisAttributes(found->second);
+      return;
+    }
+
+    G4VisAttributes *vis = new G4VisAttributes();
+    try {
+      const std::vector<double> &color = table->GetDArray(colorName);
+      Log::Assert(color.size() == 3 || color.size() == 4, "GeoCalibSourceFactory: Color entry " + colorName + " does not have 3 (RGB) or 4 (RGBA) components");
+      if(color.size() == 3) // RGB
+        vis->SetColour(G4Colour(color[0], color[1], color[2]));
+      else if(color.size() == 4) // RGBA
+        vis->SetColour(G4Colour(color[0], color[1], color[2], color[3]));
+    }
+    catch(DBNotFoundError &e){
+      Log::Die("GeoCalibSourceFactory: DBNotFoundError. Table " + e.table + ", index " + e.index + ", field " + e.field +".");
+    };
+
+    fVisAttributes[key] = vis;
+    logicalVolume->SetVisAttributes(vis);
+  } // SetColor
+
+  void GeoCalibSourceFactory::AddSensitiveVolume(G4LogicalVolume *logicalVolume,
+                                                 const std::string &detectorName,
+                                                 const int lcn,
+                                                 const double energyThreshold,
+                                                 const double efficiency,
+                                                 const bool earlyAbort,
+                                                 const bool accumulateOnly)
+  {
+    SensitiveVolume sensitive;
+    sensitive.volume = logicalVolume;
+    sensitive.detectorName = detectorName;
+    sensitive.lcn = lcn;
+    sensitive.energyThreshold = energyThreshold;
+    sensitive.efficiency = efficiency;
+    sensitive.earlyAbort = earlyAbort;
+    sensitive.accumulateOnly = accumulateOnly;
+    sensitive.region = fSource.region;
+    fSensitiveVolumes.push_back(sensitive);
+
+    std::ostringstream note;
+    note << std::setprecision(17) << "sensitive " << detectorName << " " << lcn << " "
+         << energyThreshold << " " << efficiency << " " << earlyAbort << " " << accumulateOnly;
+    fNotes[logicalVolume].push_back(note.str());
+
+    // For this thread now, as there may be no ConstructSDandField to do it
+    ConstructSensitiveDetector(sensitive);
+  } // AddSensitiveVolume
+
+  void GeoCalibSourceFactory::AddFastSimulation(const std::string &prefix,
+                                                DBLinkPtr responseTable,
+                                                const std::string &geometryHash,
+                                                const std::string &detectorName)
+  {
+    FastSimulatedSource source;
+    source.name = prefix+"fast_model";
+    source.region = fSource.region;
+    // Read once here, and only read by the workers' models
+    source.response = new CalibSourceResponse();
+    source.response->Load(responseTable,geometryHash);
+    source.detectorName = TagDetectorName(detectorName);
+    fFastSimulatedSources.push_back(source);
+
+    ConstructFastModel(source);
+  } // AddFastSimulation
+
+  void GeoCalibSourceFactory::ConstructSDandField()
+  {
+    ForgetEarlierBuilds();
+    // The models look up their detectors, so these come first
+    for(size_t i=0; i<fSensitiveVolumes.size(); i++)
+      ConstructSensitiveDetector(fSensitiveVolumes[i]);
+    for(size_t i=0; i<fFastSimulatedSources.size(); i++)
+      ConstructFastModel(fFastSimulatedSources[i]);
+    if(CalibSourceProfiler::IsProfiling())
+      CalibSourceProfiler::Install();
+  } // ConstructSDandField
+
+  void GeoCalibSourceFactory::ConstructFastModel(const FastSimulatedSource &source)
+  {
+    // The region's fast simulation manager is per thread, and is created
+    // along with the first model
+    if(source.region->GetFastSimulationManager() == NULL)
+      new CalibSourceFastModel(source.name,source.region,*source.response,source.detectorName);
+  } // ConstructFastModel
+
+  void GeoCalibSourceFactory::ConstructSensitiveDetector(const SensitiveVolume &sensitive)
+  {
+    // The SD manager and a logical volume's detector are both per thread;
+    // a thread that already has the detector keeps it
+    G4SDManager* sDManager = G4SDManager::GetSDMpointer();
+    G4VSensitiveDetector* pmtSD = sDManager->FindSensitiveDetector(sensitive.detectorName,false);
+    const bool gated = sensitive.earlyAbort || sensitive.accumulateOnly;
+    if(pmtSD == NULL){
+      // A gate applies the efficiency itself
+      pmtSD = new CalibPMTSD(sensitive.detectorName,sensitive.lcn,sensitive.energyThreshold,
+                             gated ? 1. : sensitive.efficiency);
+      sDManager->AddNewDetector(pmtSD);
+    }
+    if(!gated){
+      sensitive.volume->SetSensitiveDetector(pmtSD);
+      return;
+    }
+
+    G4VSensitiveDetector* gateSD = sDManager->FindSensitiveDetector(TagDetectorName(sensitive.detectorName),false);
+    if(gateSD == NULL){
+      CalibSourceTagGate* gate = new CalibSourceTagGate(TagDetectorName(sensitive.detectorName),pmtSD,
+                                                        sensitive.region,sensitive.energyThreshold,
+                                                        sensitive.efficiency,sensitive.accumulateOnly);
+      sDManager->AddNewDetector(gate);
+      if(sensitive.earlyAbort)
+        CalibSourceEarlyAbort::Install(gate);
+      gateSD = gate;
+    }
+    sensitive.volume->SetSensitiveDetector(gateSD);
+  } // ConstructSensitiveDetector
+
+  std::string GeoCalibSourceFactory::TagDetectorName(const std::string &detectorName)
+  {
+    for(size_t i=0; i<fSensitiveVolumes.size(); i++)
+      if(fSensitiveVolumes[i].detectorName == detectorName &&
+         (fSensitiveVolumes[i].earlyAbort || fSensitiveVolumes[i].accumulateOnly))
+        return detectorName+"_gate";
+    return detectorName;
+  } // TagDetectorName
+
+  bool GeoCalibSourceFactory::IsBatchMode(DBLinkPtr table)
+  {
+    // The table can say, for the jobs the guess below gets wrong
+    try {
+      return table->GetI("vis_attributes") == 0;
+    }
+    catch(DBNotFoundError &e) {
+    };
+    // Otherwise batch if there is no viewer and no session to open one
+    // from. A macro runs in a G4UIbatch session, so "rat macro.mac" is
+    // batch, as is a macro executed from an interactive session.
+    if(G4VVisManager::GetConcreteInstance() != NULL)
+      return false;
+    G4UIsession* session = G4UImanager::GetUIpointer()->GetSession();
+    return session == NULL || dynamic_cast<G4UIbatch*>(session) != NULL;
+  } // IsBatchMode
+
+  G4PVPlacement* GeoCalibSourceFactory::G4PVPlacementWithCheck(
+                                                               G4Transform3D& Transform3D,
+                                                               G4LogicalVolume* pCurrentLogical,
+                                                               const G4String& pName,
+                                                               G4LogicalVolume* pMotherLogical,
+                                                               G4bool pMany,
+                                                               G4int pCopyNo,
+                                                               G4bool pSurfChk)
+  {
+    G4PVPlacement* placement = new G4PVPlacement(Transform3D, pCurrentLogical, pName, pMotherLogical, pMany, pCopyNo, false);
+    // The envelope has no shape yet, so the check waits for PlaceEnvelope
+    if(pSurfChk)
+      fPendingOverlapChecks.push_back(placement);
+    return placement;
+  } // G4PVPlacementWithCheck
+
+  G4LogicalVolume* GeoCalibSourceFactory::BuildEnvelope(const CalibSourceParams &params,
+                                                        const std::string &prefix,
+                                                        G4LogicalVolume *motherLog)
+  {
+    ForgetEarlierBuilds();
+    fSource = PlacedSource();
+    fSource.table = params.table;
+    fSource.index = params.index;
+    fSource.checkOverlaps = params.checkOverlaps;
+    fSource.detailLevel = params.GetDetailLevel();
+    fSource.overlapChecker = CalibSourceOverlapChecker(params.overlapCheckPoints,params.overlapCheckTolerance,
+                                                       params.overlapCheckThreads);
+    if(params.profile)
+      CalibSourceProfiler::Profile(prefix);
+
+    // The final shape is only known once every part has been placed
+    G4VSolid* placeholderSolid = new G4Box(prefix+"envelope_solid",CLHEP::mm,CLHEP::mm,CLHEP::mm);
+    G4LogicalVolume* envelopeLog = new G4LogicalVolume(placeholderSolid,motherLog->GetMaterial(),
+                                                       prefix+"envelope_log");
+    envelopeLog->SetVisAttributes(G4VisAttributes::Invisible);
+    fPendingOverlapChecks.clear();
+    fNotes.clear();
+    fCacheDirectory.clear();
+    fCacheHash.clear();
+    fMergedFeatures.clear();
+
+    // Everything in the envelope is in the source's region, which is kept
+    // by the region store and so reused when the source is built again
+    G4RegionStore* regionStore = G4RegionStore::GetInstance();
+    fSource.region = regionStore->GetRegion(prefix+"region",false);
+    if(fSource.region == NULL)
+      fSource.region = new G4Region(prefix+"region");
+    fSource.region->AddRootLogicalVolume(envelopeLog);
+    // What the table does not set is shared with the mother's region: a
+    // region must have cuts, and sharing rather than copying them keeps any
+    // later change the physics list makes. Regions only reach the volumes
+    // below their roots when a run starts, so a mother that is not a root
+    // itself gets the world's.
+    G4Region* motherRegion = motherLog->GetRegion();
+    if(motherRegion == NULL)
+      motherRegion = regionStore->GetRegion("DefaultRegionForTheWorld",false);
+    if(params.productionCut > 0.){
+      G4ProductionCuts* cuts = new G4ProductionCuts();
+      cuts->SetProductionCut(params.productionCut);
+      fSource.region->SetProductionCuts(cuts);
+    }
+    else {
+      G4ProductionCuts* cuts = motherRegion != NULL ? motherRegion->GetProductionCuts() : NULL;
+      if(cuts == NULL)
+        cuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+      fSource.region->SetProductionCuts(cuts);
+    }
+    if(params.maxStep > 0. || params.minKineticEnergy > 0. || params.maxTrackTime > 0.)
+      fSource.region->SetUserLimits(new G4UserLimits(params.maxStep > 0. ? params.maxStep : DBL_MAX,DBL_MAX,
+                                                     params.maxTrackTime > 0. ? params.maxTrackTime : DBL_MAX,
+                                                     params.minKineticEnergy));
+    else if(motherRegion != NULL)
+      fSource.region->SetUserLimits(motherRegion->GetUserLimits());
+    return envelopeLog;
+  } // BuildEnvelope
+
+  void GeoCalibSourceFactory::ForgetEarlierBuilds()
+  {
+    const unsigned long generation = CalibSourceStoreWatch::GetGeneration();
+    if(generation == fGeneration)
+      return;
+    // The responses are left to any fast model still holding one
+    fPlacedSources.clear();
+    fSensitiveVolumes.clear();
+    fFastSimulatedSources.clear();
+    fGeneration = generation;
+  } // ForgetEarlierBuilds
+
+  bool GeoCalibSourceFactory::LoadParts(DBLinkPtr table,
+                                        const CalibSourceParams &params,
+                                        G4LogicalVolume *envelopeLog,
+                                        G4bool pSurfChk)
+  {
+    // The mixtures of a reduced source are made while it is built, so a
+    // stored one could not find its materials again
+    if(params.geometryCache.empty() || params.GetDetailLevel() != CalibSourceParams::kFullDetail)
+      return false;
+    const CalibSourceGeometryCache cache(params.geometryCache,params.index,params.GetHash(true),fGeometryVersion);
+    CalibSourceGeometryCache::Notes notes;
+    std::vector<G4VPhysicalVolume*> placements;
+    if(!cache.Read(envelopeLog,notes,placements)){
+      // Built in full, and stored once placed
+      fCacheDirectory = params.geometryCache;
+      fCacheHash = params.GetHash(true);
+      return false;
+    }
+    info << "GeoCalibSourceFactory: Read the parts of " << params.index << " from "
+         << cache.GetPath() << newline;
+
+    // The placements were checked when they were stored, but the checks
+    // may not have been asked for then
+    if(pSurfChk)
+      fPendingOverlapChecks.insert(fPendingOverlapChecks.end(),placements.begin(),placements.end());
+    for(CalibSourceGeometryCache::Notes::const_iterator it = notes.begin(); it != notes.end(); ++it){
+      G4LogicalVolume* logicalVolume = const_cast<G4LogicalVolume*>(it->first);
+      for(size_t i=0; i<it->second.size(); i++){
+        std::istringstream note(it->second[i]);
+        std::string action;
+        note >> action;
+        if(action == "colour"){
+          std::string colorName;
+          note >> colorName;
+          SetColor(table,colorName,logicalVolume);
+        }
+        else if(action == "sensitive"){
+          std::string detectorName;
+          int lcn;
+          double energyThreshold, efficiency;
+          bool earlyAbort, accumulateOnly;
+          note >> detectorName >> lcn >> energyThreshold >> efficiency >> earlyAbort >> accumulateOnly;
+          Log::Assert(!note.fail(),"GeoCalibSourceFactory: Bad sensitive volume " + logicalVolume->GetName() +
+                      " in " + cache.GetPath() + ".");
+          AddSensitiveVolume(logicalVolume,detectorName,lcn,energyThreshold,efficiency,earlyAbort,accumulateOnly);
+        }
+      }
+    }
+    return true;
+  } // LoadParts
+
+  G4VPhysicalVolume* GeoCalibSourceFactory::PlaceEnvelope(G4LogicalVolume *envelopeLog,
+                                                          const G4ThreeVector &position,
+                                                          G4LogicalVolume *motherLog,
+                                                          const std::string &prefix,
+                                                          G4bool pSurfChk)
+  {
+    Log::Assert(envelopeLog->GetNoDaughters() > 0,
+                "GeoCalibSourceFactory: Envelope " + envelopeLog->GetName() + " contains no parts.");
+    G4VSolid* placeholderSolid = envelopeLog->GetSolid();
+    envelopeLog->SetSolid(BuildEnvelopeSolid(envelopeLog,prefix+"envelope_solid"));
+    delete placeholderSolid;
+    ApplyMergedFeatures();
+    if(fSource.detailLevel == CalibSourceParams::kEnvelopeOnly)
+      FillEnvelope(envelopeLog);
+
+    G4Transform3D envelopeTransform(G4RotationMatrix(),position);
+    G4PVPlacement* envelopePhys = G4PVPlacementWithCheck(envelopeTransform,envelopeLog,
+                                                         prefix+"envelope_phys",motherLog,
+                                                         false,0,pSurfChk);
+
+    // Check everything at once and only then give up if anything overlaps
+    const int nOverlaps = fSource.overlapChecker.Check(fPendingOverlapChecks,prefix+"envelope");
+    fPendingOverlapChecks.clear();
+    Log::Assert(nOverlaps == 0,"GeoCalibSourceFactory: " + to_string(nOverlaps) +
+                " overlaps detected in " + envelopeLog->GetName() + ". See log for details.");
+    ReportMaterialBudget(envelopeLog,motherLog->GetMaterial(),prefix,fSource.detailLevel);
+
+    // Only parts that were built, and passed their checks, are stored
+    if(!fCacheDirectory.empty()){
+      const CalibSourceGeometryCache cache(fCacheDirectory,fSource.index,fCacheHash,fGeometryVersion);
+      if(cache.Write(envelopeLog,fNotes))
+        info << "GeoCalibSourceFactory: Stored the parts of " << fSource.index << " in "
+             << cache.GetPath() << newline;
+      else
+        warn << "GeoCalibSourceFactory: Could not store the parts of " << fSource.index << " in "
+             << cache.GetPath() << newline;
+    }
+
+    fSource.envelope = envelopePhys;
+    fPlacedSources[fSource.index] = fSource;
+    return envelopePhys;
+  } // PlaceEnvelope
+
+  bool GeoCalibSourceFactory::IsPlaced(const std::string &index)
+  {
+    ForgetEarlierBuilds();
+    return fPlacedSources.find(index) != fPlacedSources.end();
+  } // IsPlaced
+
+  DBLinkPtr GeoCalibSourceFactory::GetSourceTable(const std::string &index)
+  {
+    ForgetEarlierBuilds();
+    std::map<std::string, PlacedSource>::const_iterator found = fPlacedSources.find(index);
+    Log::Assert(found != fPlacedSources.end(),
+                "GeoCalibSourceFactory: No calibration source '" + index + "' has been built.");
+    return DB::Get()->GetLink(found->second.table,index);
+  } // GetSourceTable
+
+  void GeoCalibSourceFactory::MoveSource(const std::string &index, const G4ThreeVector &position)
+  {
+    ForgetEarlierBuilds();
+    std::map<std::string, PlacedSource>::const_iterator found = fPlacedSources.find(index);
+    Log::Assert(found != fPlacedSources.end(),
+                "GeoCalibSourceFactory: No calibration source '" + index + "' has been built.");
+    const PlacedSource &source = found->second;
+
+    // The envelope is from this build, so its mother has a placement in
+    // the store
+    G4PhysicalVolumeStore* store = G4PhysicalVolumeStore::GetInstance();
+    const G4LogicalVolume* motherLog = source.envelope->GetMotherLogical();
+    G4VPhysicalVolume* motherPhys = NULL;
+    for(size_t i=0; i<store->size() && motherPhys == NULL; i++)
+      if((*store)[i]->GetLogicalVolume() == motherLog)
+        motherPhys = (*store)[i];
+    Log::Assert(motherPhys != NULL,
+                "GeoCalibSourceFactory: The mother of calibration source '" + index + "' is not placed.");
+
+    // Only the mother's optimisation depends on where the envelope is
+    G4GeometryManager* geometryManager = G4GeometryManager::GetInstance();
+    geometryManager->OpenGeometry(motherPhys);
+    source.envelope->SetTranslation(position);
+    geometryManager->CloseGeometry(true,false,motherPhys);
+
+    if(source.checkOverlaps){
+      const int nOverlaps = source.overlapChecker.Check(std::vector<G4VPhysicalVolume*>(1,source.envelope),
+                                                        index+"_envelope");
+      Log::Assert(nOverlaps == 0,"GeoCalibSourceFactory: Calibration source '" + index +
+                  "' overlaps at its new position. See log for details.");
+    }
+
+    // Keep the table in step, for the generators that read the position
+    std::vector<double> samplePosition(3);
+    samplePosition[0] = position.x()/CLHEP::mm;
+    samplePosition[1] = position.y()/CLHEP::mm;
+    samplePosition[2] = position.z()/CLHEP::mm;
+    DB::Get()->SetDArray(source.table,index,"sample_position",samplePosition);
+  } // MoveSource
+
+  G4VSolid* GeoCalibSourceFactory::BuildAxialSolid(const std::string &name,
+                                                   const std::vector<double> &zPlanes,
+                                                   const std::vector<double> &rInner,
+                                                   const std::vector<double> &rOuter,
+                                                   const bool native)
+  {
+    Log::Assert(zPlanes.size() >= 2 && rInner.size() == zPlanes.size() && rOuter.size() == zPlanes.size(),
+                "GeoCalibSourceFactory: Profile for " + name + " needs at least two planes with both radii.");
+    const double volume = CalibSourceVolume::Axial(zPlanes,rInner,rOuter);
+    if(native)
+      return CalibSourceSolidCache::Polycone(name,zPlanes,rInner,rOuter,volume);
+
+    // One tube or cone per section between planes; a repeated plane is a step
+    std::vector<G4VSolid*> sections;
+    std::vector<G4ThreeVector> translations;
+    for(size_t i=0; i+1<zPlanes.size(); i++){
+      const double halfLength = (zPlanes[i+1]-zPlanes[i])/2.;
+      if(halfLength <= 0.)
+        continue;
+      const std::string sectionName = name+"_"+to_string(static_cast<int>(sections.size()));
+      if(rInner[i] == rInner[i+1] && rOuter[i] == rOuter[i+1])
+        sections.push_back(CalibSourceSolidCache::Tubs(sectionName,rInner[i],rOuter[i],halfLength,0.,CLHEP::twopi));
+      else
+        sections.push_back(CalibSourceSolidCache::Cons(sectionName,rInner[i],rOuter[i],rInner[i+1],rOuter[i+1],
+                                                       halfLength,0.,CLHEP::twopi));
+      translations.push_back(G4ThreeVector(0.,0.,zPlanes[i]+halfLength));
+    }
+    return BuildUnion(name,sections,translations,false,volume);
+  } // BuildAxialSolid
+
+  G4VSolid* GeoCalibSourceFactory::BuildUnion(const std::string &name,
+                                              const std::vector<G4VSolid*> &parts,
+                                              const std::vector<G4ThreeVector> &translations,
+                                              const bool native,
+                                              const double volume)
+  {
+    Log::Assert(!parts.empty() && parts.size() == translations.size(),
+                "GeoCalibSourceFactory: Union " + name + " needs one translation per part.");
+    if(parts.size() == 1 && translations[0] == G4ThreeVector())
+      return parts[0];
+    if(native){
+      CalibSourceSolid<G4MultiUnion>* multiUnion = new CalibSourceSolid<G4MultiUnion>(name);
+      for(size_t i=0; i<parts.size(); i++)
+        multiUnion->AddNode(*parts[i],G4Transform3D(G4RotationMatrix(),translations[i]));
+      multiUnion->Voxelize();
+      return WithVolume(multiUnion,volume);
+    }
+
+    // The first part is the reference for each subsequent one, so shift the
+    // chain back into the frame of the parts at the end. Only the outermost
+    // solid needs its volume.
+    const bool displaced = translations[0] != G4ThreeVector();
+    G4VSolid* chain = parts[0];
+    for(size_t i=1; i<parts.size(); i++){
+      if(i+1 < parts.size() || displaced)
+        chain = new G4UnionSolid(name,chain,parts[i],0,translations[i]-translations[0]);
+      else
+        chain = WithVolume(new CalibSourceSolid<G4UnionSolid>(name,chain,parts[i],0,
+                                                              translations[i]-translations[0]),volume);
+    }
+    if(!displaced)
+      return chain;
+    return WithVolume(new CalibSourceSolid<G4DisplacedSolid>(name,chain,0,translations[0]),volume);
+  } // BuildUnion
+
+  G4VSolid* GeoCalibSourceFactory::BuildHolePattern(const std::string &name,
+                                                    G4VSolid *holeSolid,
+                                                    const int nHoles,
+                                                    G4ThreeVector holeTranslation,
+                                                    const bool native)
+  {
+    // The holes add up as long as they do not touch
+    const double volume = nHoles == 1 || holeTranslation.perp()*std::sin(CLHEP::pi/nHoles) > BoundingRadius(holeSolid) ?
+      nHoles*holeSolid->GetCubicVolume() : -1.;
+    std::vector<G4VSolid*> holes(nHoles,holeSolid);
+    std::vector<G4ThreeVector> translations;
+    for(int i=0; i<nHoles; i++){
+      holeTranslation = holeTranslation.rotateZ(CLHEP::twopi/double(nHoles));
+      translations.push_back(holeTranslation);
+    }
+    return BuildUnion(name,holes,translations,native,volume);
+  } // BuildHolePattern
+
+  G4VSolid* GeoCalibSourceFactory::BuildHoleRing(const std::string &name,
+                                                 G4Tubs *holeSolid,
+                                                 const int nHoles,
+                                                 const G4ThreeVector &holeTranslation,
+                                                 const bool native)
+  {
+    Log::Assert(holeSolid->GetInnerRadius() == 0. && holeSolid->GetDeltaPhiAngle() >= CLHEP::twopi,
+                "GeoCalibSourceFactory: Holes in " + name + " must be solid cylinders.");
+    const double holeRadius = holeSolid->GetOuterRadius();
+    const double distance = holeTranslation.perp();
+    if(nHoles == 1 || distance*std::sin(CLHEP::pi/nHoles) > holeRadius)
+      return CalibSourceSolidCache::HoleRing(name,nHoles,holeRadius,holeSolid->GetZHalfLength(),
+                                             distance,holeTranslation.phi());
+    // Holes that meet are left to the general union
+    return BuildHolePattern(name,holeSolid,nHoles,G4ThreeVector(holeTranslation.x(),holeTranslation.y(),0.),
+                            native);
+  } // BuildHoleRing
+
+  G4VSolid* GeoCalibSourceFactory::Subtract(const std::string &name,
+                                            G4VSolid *solid,
+                                            G4VSolid *hole,
+                                            const G4ThreeVector &translation,
+                                            const double volume)
+  {
+    if(translation == G4ThreeVector())
+      return WithVolume(new CalibSourceSolid<G4SubtractionSolid>(name,solid,hole),volume);
+    return WithVolume(new CalibSourceSolid<G4SubtractionSolid>(name,solid,hole,0,translation),volume);
+  } // Subtract
+
+  G4VSolid* GeoCalibSourceFactory::Unite(const std::string &name,
+                                         G4VSolid *solid,
+                                         G4VSolid *part,
+                                         const G4ThreeVector &translation,
+                                         const double volume)
+  {
+    if(translation == G4ThreeVector())
+      return WithVolume(new CalibSourceSolid<G4UnionSolid>(name,solid,part),volume);
+    return WithVolume(new CalibSourceSolid<G4UnionSolid>(name,solid,part,0,translation),volume);
+  } // Unite
+
+  G4VSolid* GeoCalibSourceFactory::SubtractHolePattern(const std::string &name,
+                                                       G4VSolid *solid,
+                                                       const std::string &holesName,
+                                                       G4Tubs *holeSolid,
+                                                       const int nHoles,
+                                                       const G4ThreeVector &holeTranslation,
+                                                       const bool native)
+  {
+    G4VSolid* holesSolid = BuildHoleRing(holesName,holeSolid,nHoles,holeTranslation,native);
+    const double holesVolume = HolePatternVolume(solid,holeSolid,nHoles,holeTranslation);
+    const double volume = holesVolume >= 0. ? CalibSourceVolume::Coaxial(solid)-holesVolume : -1.;
+    return Subtract(name,solid,holesSolid,G4ThreeVector(0.,0.,holeTranslation.z()),volume);
+  } // SubtractHolePattern
+
+  double GeoCalibSourceFactory::HolePatternVolume(G4VSolid *solid,
+                                                  G4Tubs *holeSolid,
+                                                  const int nHoles,
+                                                  const G4ThreeVector &holeTranslation)
+  {
+    // The solid is round, so each hole takes out as much as the first
+    const double holeRadius = holeSolid->GetOuterRadius();
+    const double overlap = CalibSourceVolume::CoaxialHole(solid,holeRadius,holeTranslation.perp(),
+                                                          holeTranslation.z()-holeSolid->GetZHalfLength(),
+                                                          holeTranslation.z()+holeSolid->GetZHalfLength());
+    const bool apart = nHoles == 1 || holeTranslation.perp()*std::sin(CLHEP::pi/nHoles) > holeRadius;
+    return overlap >= 0. && apart ? nHoles*overlap : -1.;
+  } // HolePatternVolume
+
+  void GeoCalibSourceFactory::MergeFeature(G4LogicalVolume *target,
+                                           G4Material *material,
+                                           const double volume,
+                                           const bool inside)
+  {
+    Log::Assert(volume >= 0.,"GeoCalibSourceFactory: Feature merged into " + target->GetName() +
+                " has no volume.");
+    std::map<G4Material*, double> &masses = fMergedFeatures[target];
+    if(material != NULL)
+      masses[material] += volume*material->GetDensity();
+    // Where the feature was, the target is now solid
+    if(inside)
+      masses[target->GetMaterial()] -= volume*target->GetMaterial()->GetDensity();
+  } // MergeFeature
+
+  void GeoCalibSourceFactory::ApplyMergedFeatures()
+  {
+    for(std::map<G4LogicalVolume*, std::map<G4Material*, double> >::iterator it = fMergedFeatures.begin();
+        it != fMergedFeatures.end(); ++it){
+      G4LogicalVolume* target = it->first;
+      G4Material* material = target->GetMaterial();
+      const double ownVolume = OwnVolume(target);
+      std::map<G4Material*, double> masses = it->second;
+      masses[material] += ownVolume*material->GetDensity();
+      target->SetMaterial(BuildMixture(target->GetName()+"_material",masses,ownVolume,material,true));
+    }
+    fMergedFeatures.clear();
+  } // ApplyMergedFeatures
+
+  void GeoCalibSourceFactory::FillEnvelope(G4LogicalVolume *envelopeLog)
+  {
+    std::map<G4Material*, double> masses;
+    AddMasses(envelopeLog,1,masses);
+    // The medium is not scintillator, whatever the parts were
+    G4Material* mixture = BuildMixture(envelopeLog->GetName()+"_material",masses,
+                                       envelopeLog->GetSolid()->GetCubicVolume(),
+                                       envelopeLog->GetMaterial(),false);
+
+    // Nothing below the envelope is placed any more
+    std::set<const G4LogicalVolume*> removed;
+    std::vector<const G4LogicalVolume*> pending(1,envelopeLog);
+    while(!pending.empty()){
+      const G4LogicalVolume* volume = pending.back();
+      pending.pop_back();
+      for(size_t i=0; i<volume->GetNoDaughters(); i++)
+        if(removed.insert(volume->GetDaughter(i)->GetLogicalVolume()).second)
+          pending.push_back(volume->GetDaughter(i)->GetLogicalVolume());
+    }
+    for(size_t i=fSensitiveVolumes.size(); i-- > 0;)
+      if(removed.count(fSensitiveVolumes[i].volume) > 0){
+        warn << "GeoCalibSourceFactory: " << fSensitiveVolumes[i].volume->GetName()
+             << " is filled in at envelope detail and is not sensitive" << newline;
+        fSensitiveVolumes.erase(fSensitiveVolumes.begin()+i);
+      }
+    while(envelopeLog->GetNoDaughters() > 0){
+      G4VPhysicalVolume* daughter = envelopeLog->GetDaughter(0);
+      envelopeLog->RemoveDaughter(daughter);
+      delete daughter;
+    }
+    fPendingOverlapChecks.clear();
+    envelopeLog->SetMaterial(mixture);
+  } // FillEnvelope
+
+  G4Material* GeoCalibSourceFactory::BuildMixture(const std::string &name,
+                                                  const std::map<G4Material*, double> &masses,
+                                                  const double volume,
+                                                  const G4Material *like,
+                                                  const bool optical)
+  {
+    // Break mixtures down, so that each mixture holds plain materials
+    std::map<G4Material*, double> components;
+    for(std::map<G4Material*, double>::const_iterator it = masses.begin(); it != masses.end(); ++it){
+      std::map<const G4Material*, std::map<G4Material*, double> >::const_iterator mixture = fMixtures.find(it->first);
+      if(mixture == fMixtures.end()){
+        components[it->first] += it->second;
+        continue;
+      }
+      double mixtureMass = 0.;
+      for(std::map<G4Material*, double>::const_iterator part = mixture->second.begin();
+          part != mixture->second.end(); ++part)
+        mixtureMass += part->second;
+      for(std::map<G4Material*, double>::const_iterator part = mixture->second.begin();
+          part != mixture->second.end(); ++part)
+        components[part->first] += it->second*part->second/mixtureMass;
+    }
+
+    // Features may take out what they were in, but never more than was there
+    double totalMass = 0.;
+    for(std::map<G4Material*, double>::const_iterator it = components.begin(); it != components.end(); ++it)
+      totalMass += std::max(it->second,0.);
+    Log::Assert(volume > 0. && totalMass > 0.,"GeoCalibSourceFactory: Nothing is left to fill " + name + ".");
+    for(std::map<G4Material*, double>::iterator it = components.begin(); it != components.end();){
+      Log::Assert(it->second > -1e-9*totalMass,"GeoCalibSourceFactory: The features merged into " + name +
+                  " take out more " + it->first->GetName() + " than it holds.");
+      if(it->second <= 0.)
+        components.erase(it++);
+      else
+        ++it;
+    }
+
+    G4Material* mixture = new G4Material(name,totalMass/volume,static_cast<int>(components.size()),
+                                         like->GetState(),like->GetTemperature(),like->GetPressure());
+    for(std::map<G4Material*, double>::const_iterator it = components.begin(); it != components.end(); ++it)
+      mixture->AddMaterial(it->first,it->second/totalMass);
+    if(optical)
+      mixture->SetMaterialPropertiesTable(like->GetMaterialPropertiesTable());
+    fMixtures[mixture] = components;
+    return mixture;
+  } // BuildMixture
+
+  double GeoCalibSourceFactory::OwnVolume(const G4LogicalVolume *volume)
+  {
+    double ownVolume = volume->GetSolid()->GetCubicVolume();
+    for(size_t i=0; i<volume->GetNoDaughters(); i++){
+      const G4VPhysicalVolume* daughter = volume->GetDaughter(i);
+      ownVolume -= daughter->GetMultiplicity()*daughter->GetLogicalVolume()->GetSolid()->GetCubicVolume();
+    }
+    return ownVolume;
+  } // OwnVolume
+
+  void GeoCalibSourceFactory::AddMasses(const G4LogicalVolume *volume,
+                                        const int copies,
+                                        std::map<G4Material*, double> &masses)
+  {
+    masses[volume->GetMaterial()] += copies*OwnVolume(volume)*volume->GetMaterial()->GetDensity();
+    for(size_t i=0; i<volume->GetNoDaughters(); i++){
+      const G4VPhysicalVolume* daughter = volume->GetDaughter(i);
+      AddMasses(daughter->GetLogicalVolume(),copies*daughter->GetMultiplicity(),masses);
+    }
+  } // AddMasses
+
+  G4VSolid* GeoCalibSourceFactory::BuildCylinderHull(const std::string &name,
+                                                     const std::vector<double> &zLow,
+                                                     const std::vector<double> &zHigh,
+                                                     const std::vector<double> &radius,
+                                                     const bool native)
+  {
+    Log::Assert(!zLow.empty() && zHigh.size() == zLow.size() && radius.size() == zLow.size(),
+                "GeoCalibSourceFactory: Hull " + name + " needs a z range and radius per cylinder.");
+    std::vector<double> edges(zLow);
+    edges.insert(edges.end(),zHigh.begin(),zHigh.end());
+    std::sort(edges.begin(),edges.end());
+    edges.erase(std::unique(edges.begin(),edges.end()),edges.end());
+
+    // Each section between edges is as wide as the widest cylinder over it
+    std::vector<double> zPlanes, rOuter;
+    for(size_t k=0; k+1<edges.size(); k++){
+      double sectionRadius = 0.;
+      for(size_t i=0; i<zLow.size(); i++)
+        if(zLow[i] <= edges[k] && zHigh[i] >= edges[k+1])
+          sectionRadius = std::max(sectionRadius,radius[i]);
+      Log::Assert(sectionRadius > 0.,"GeoCalibSourceFactory: Cylinders in hull " + name + " leave a gap.");
+      if(k > 0 && sectionRadius == rOuter.back()){
+        zPlanes.back() = edges[k+1];
+        continue;
+      }
+      zPlanes.push_back(edges[k]);
+      zPlanes.push_back(edges[k+1]);
+      rOuter.push_back(sectionRadius);
+      rOuter.push_back(sectionRadius);
+    }
+    return BuildAxialSolid(name,zPlanes,std::vector<double>(zPlanes.size(),0.),rOuter,native);
+  } // BuildCylinderHull
+
+  G4VPhysicalVolume* GeoCalibSourceFactory::PlaceBoltCircle(const std::string &name,
+                                                            G4LogicalVolume *cellLog,
+                                                            const int nCells,
+                                                            const G4ThreeVector &firstPosition,
+                                                            G4LogicalVolume *motherLog,
+                                                            const bool native,
+                                                            G4bool pSurfChk)
+  {
+    // The copies are not checked against each other, so make sure they
+    // cannot touch
+    const double cellRadius = BoundingRadius(cellLog->GetSolid());
+    Log::Assert(nCells > 0 && (nCells == 1 || firstPosition.perp()*std::sin(CLHEP::pi/nCells) > cellRadius),
+                "GeoCalibSourceFactory: " + to_string(nCells) + " copies of " + cellLog->GetName() +
+                " do not fit on their circle.");
+
+    // The ring has exactly the shape of the copies, so the parameterised
+    // volume is its only daughter and the mother sees a single volume
+    G4VSolid* ringSolid = BuildHolePattern(name+"_ring_solid",cellLog->GetSolid(),nCells,
+                                           firstPosition,native);
+    G4LogicalVolume* ringLog = new G4LogicalVolume(ringSolid,motherLog->GetMaterial(),
+                                                   name+"_ring_log");
+    ringLog->SetVisAttributes(G4VisAttributes::Invisible);
+    G4Transform3D ringTransform;
+    G4PVPlacementWithCheck(ringTransform,ringLog,name+"_ring_phys",motherLog,false,0,pSurfChk);
+
+    return new G4PVParameterised(name+"_phys",cellLog,ringLog,kUndefined,nCells,
+                                 new BoltCircleParameterisation(nCells,firstPosition));
+  } // PlaceBoltCircle
+
+  G4VSolid* GeoCalibSourceFactory::BuildEnvelopeSolid(G4LogicalVolume *envelopeLog,
+                                                      const std::string &name)
+  {
+    // Find the z range of each part and its bounding radius about the
+    // envelope axis
+    const size_t nParts = envelopeLog->GetNoDaughters();
+    std::vector<double> zLow(nParts), zHigh(nParts), radius(nParts), zEdges;
+    for(size_t i=0; i<nParts; i++){
+      const G4VPhysicalVolume* part = envelopeLog->GetDaughter(i);
+      const G4VSolid* solid = part->GetLogicalVolume()->GetSolid();
+      const G4RotationMatrix rotation = part->GetObjectRotationValue();
+      const G4ThreeVector translation = part->GetObjectTranslation();
+      G4ThreeVector pMin, pMax;
+      solid->BoundingLimits(pMin,pMax);
+      zLow[i] = kInfinity;
+      zHigh[i] = -kInfinity;
+      for(int corner=0; corner<8; corner++){
+        const G4ThreeVector point(corner & 1 ? pMax.x() : pMin.x(),
+                                  corner & 2 ? pMax.y() : pMin.y(),
+                                  corner & 4 ? pMax.z() : pMin.z());
+        const double z = (rotation*point+translation).z();
+        zLow[i] = std::min(zLow[i],z);
+        zHigh[i] = std::max(zHigh[i],z);
+      }
+      radius[i] = BoundingRadius(solid,G4Transform3D(rotation,translation));
+      zEdges.push_back(zLow[i]);
+      zEdges.push_back(zHigh[i]);
+    }
+
+    // Cut the z range into slabs at every part boundary; edges that only
+    // differ by rounding are treated as the same plane
+    const double tolerance = G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+    std::sort(zEdges.begin(),zEdges.end());
+    std::vector<double> planes(1,zEdges.front());
+    for(size_t i=1; i<zEdges.size(); i++)
+      if(zEdges[i]-planes.back() > tolerance)
+        planes.push_back(zEdges[i]);
+
+    // Each slab is as wide as the widest part that overlaps it
+    const size_t nSlabs = planes.size()-1;
+    std::vector<double> slabRadius(nSlabs,0.);
+    for(size_t k=0; k<nSlabs; k++)
+      for(size_t i=0; i<nParts; i++)
+        if(zLow[i] < planes[k+1]-tolerance && zHigh[i] > planes[k]+tolerance)
+          slabRadius[k] = std::max(slabRadius[k],radius[i]);
+    // A gap between parts is bridged with the narrower of its neighbours
+    for(size_t k=0; k<nSlabs; k++){
+      if(slabRadius[k] > 0.)
+        continue;
+      double below = 0., above = 0.;
+      for(size_t j=k; j-- > 0;)
+        if(slabRadius[j] > 0.){ below = slabRadius[j]; break; }
+      for(size_t j=k+1; j<nSlabs; j++)
+        if(slabRadius[j] > 0.){ above = slabRadius[j]; break; }
+      slabRadius[k] = (below > 0. && above > 0.) ? std::min(below,above) : std::max(below,above);
+    }
+
+    // Stack the slabs into a polycone, merging neighbours of equal radius
+    std::vector<double> zPlanes, rInner, rOuter;
+    for(size_t k=0; k<nSlabs; k++){
+      if(k > 0 && slabRadius[k] == slabRadius[k-1]){
+        zPlanes.back() = planes[k+1];
+        continue;
+      }
+      zPlanes.push_back(planes[k]);
+      zPlanes.push_back(planes[k+1]);
+      rOuter.push_back(slabRadius[k]);
+      rOuter.push_back(slabRadius[k]);
+    }
+    rInner.assign(zPlanes.size(),0.);
+    return WithVolume(new CalibSourceSolid<G4Polycone>(name,0.,CLHEP::twopi,zPlanes.size(),
+                                                       &zPlanes[0],&rInner[0],&rOuter[0]),
+                      CalibSourceVolume::Axial(zPlanes,rInner,rOuter));
+  } // BuildEnvelopeSolid
+
+  void GeoCalibSourceFactory::ReportMaterialBudget(G4LogicalVolume *envelopeLog,
+                                                   const G4Material *medium,
+                                                   const std::string &prefix,
+                                                   const CalibSourceParams::DetailLevel detailLevel)
+  {
+    // Every volume in the envelope with its number of copies, in the order
+    // they are met going down the tree; a filled envelope is a part itself
+    std::vector<G4LogicalVolume*> volumes;
+    std::map<G4LogicalVolume*, int> copies;
+    std::vector<std::pair<G4LogicalVolume*, int> > pending(1,std::make_pair(envelopeLog,1));
+    while(!pending.empty()){
+      G4LogicalVolume* volume = pending.back().first;
+      const int nCopies = pending.back().second;
+      pending.pop_back();
+      if(volume != envelopeLog || volume->GetMaterial() != medium){
+        if(copies.find(volume) == copies.end())
+          volumes.push_back(volume);
+        copies[volume] += nCopies;
+      }
+      for(size_t i=volume->GetNoDaughters(); i-- > 0;){
+        const G4VPhysicalVolume* daughter = volume->GetDaughter(i);
+        pending.push_back(std::make_pair(daughter->GetLogicalVolume(),nCopies*daughter->GetMultiplicity()));
+      }
+    }
+
+    std::ostringstream report;
+    report << "GeoCalibSourceFactory: Material budget of " << prefix.substr(0,prefix.size()-1) << " ("
+           << kDetailLevelNames[detailLevel] << " detail)\n"
+           << std::setw(36) << std::left << "  volume" << std::setw(28) << "material" << std::right
+           << std::setw(8) << "copies" << std::setw(16) << "volume (cm3)" << std::setw(14) << "mass (g)" << "\n";
+    report << std::fixed << std::setprecision(3);
+    std::vector<std::string> materials;
+    std::map<std::string, std::pair<double, double> > byMaterial;
+    double totalVolume = 0., totalMass = 0.;
+    for(size_t i=0; i<volumes.size(); i++){
+      // The mother's material filling the gaps is not part of the source
+      G4LogicalVolume* volume = volumes[i];
+      const G4Material* material = volume->GetMaterial();
+      if(material == medium)
+        continue;
+      const double partVolume = copies[volume]*OwnVolume(volume);
+      // A mixture counts as what it holds, at their own densities
+      std::map<G4Material*, double> components;
+      std::map<const G4Material*, std::map<G4Material*, double> >::const_iterator mixture = fMixtures.find(material);
+      if(mixture != fMixtures.end())
+        components = mixture->second;
+      else
+        components[const_cast<G4Material*>(material)] = 1.;
+      double componentsMass = 0.;
+      for(std::map<G4Material*, double>::const_iterator it = components.begin(); it != components.end(); ++it)
+        componentsMass += it->second;
+      double partMass = 0.;
+      for(std::map<G4Material*, double>::const_iterator it = components.begin(); it != components.end(); ++it){
+        if(it->first == medium)
+          continue;
+        const double mass = partVolume*material->GetDensity()*it->second/componentsMass;
+        const double volumeAtDensity = mass/it->first->GetDensity();
+        if(byMaterial.find(it->first->GetName()) == byMaterial.end())
+          materials.push_back(it->first->GetName());
+        byMaterial[it->first->GetName()].first += volumeAtDensity;
+        byMaterial[it->first->GetName()].second += mass;
+        totalVolume += volumeAtDensity;
+        partMass += mass;
+      }
+      report << std::setw(36) << std::left << "  " + volume->GetName() << std::setw(28) << material->GetName()
+             << std::right << std::setw(8) << copies[volume] << std::setw(16) << partVolume/CLHEP::cm3
+             << std::setw(14) << partMass/CLHEP::g << "\n";
+      totalMass += partMass;
+    }
+    for(size_t i=0; i<materials.size(); i++)
+      report << std::setw(36) << std::left << "  all" << std::setw(28) << materials[i] << std::right
+             << std::setw(8) << "" << std::setw(16) << byMaterial[materials[i]].first/CLHEP::cm3
+             << std::setw(14) << byMaterial[materials[i]].second/CLHEP::g << "\n";
+    report << std::setw(36) << std::left << "  total" << std::setw(28) << "" << std::right
+           << std::setw(8) << "" << std::setw(16) << totalVolume/CLHEP::cm3
+           << std::setw(14) << totalMass/CLHEP::g << "\n";
+    info << report.str();
+  } // ReportMaterialBudget
+
+  double GeoCalibSourceFactory::BoundingRadius(const G4VSolid *solid)
+  {
+    // Radius about the solid's own z axis that contains it. Boolean and
+    // composite solids are opened up, so that round parts (all built over
+    // the full circle) are not bounded by the corners of their bounding box
+    const G4String type = solid->GetEntityType();
+    if(type == "G4SubtractionSolid" || type == "G4IntersectionSolid")
+      return BoundingRadius(solid->GetConstituentSolid(0));
+    if(type == "G4UnionSolid")
+      return std::max(BoundingRadius(solid->GetConstituentSolid(0)),
+                      BoundingRadius(solid->GetConstituentSolid(1)));
+    if(type == "G4DisplacedSolid"){
+      const G4DisplacedSolid* displaced = static_cast<const G4DisplacedSolid*>(solid);
+      return BoundingRadius(displaced->GetConstituentMovedSolid(),
+                            G4Transform3D(displaced->GetObjectRotation(),
+                                          displaced->GetObjectTranslation()));
+    }
+    if(type == "CalibSourceHoleRing"){
+      const CalibSourceHoleRing* ring = static_cast<const CalibSourceHoleRing*>(solid);
+      return ring->GetDistance()+ring->GetHoleRadius();
+    }
+    if(type == "G4MultiUnion"){
+      const G4MultiUnion* multiUnion = static_cast<const G4MultiUnion*>(solid);
+      double radius = 0.;
+      for(int i=0; i<multiUnion->GetNumberOfSolids(); i++)
+        radius = std::max(radius,BoundingRadius(multiUnion->GetSolid(i),
+                                                multiUnion->GetTransformation(i)));
+      return radius;
+    }
+
+    G4ThreeVector pMin, pMax;
+    solid->BoundingLimits(pMin,pMax);
+    if(type == "G4Tubs" || type == "G4Cons" || type == "G4Polycone" || type == "G4GenericPolycone")
+      return std::max(std::max(pMax.x(),-pMin.x()),std::max(pMax.y(),-pMin.y()));
+    return std::sqrt(std::max(pMax.x()*pMax.x(),pMin.x()*pMin.x())+
+                     std::max(pMax.y()*pMax.y(),pMin.y()*pMin.y()));
+  } // BoundingRadius
+
+  double GeoCalibSourceFactory::BoundingRadius(const G4VSolid *solid,
+                                               const G4Transform3D &transform)
+  {
+    // A solid that keeps its z axis is bounded by its own radius plus its
+    // offset from the axis; anything tilted falls back to its box corners
+    const G4RotationMatrix rotation = transform.getRotation();
+    const G4ThreeVector translation = transform.getTranslation();
+    if((rotation*G4ThreeVector(0.,0.,1.)).z() > 1.-1e-12)
+      return translation.perp()+BoundingRadius(solid);
+
+    G4ThreeVector pMin, pMax;
+    solid->BoundingLimits(pMin,pMax);
+    double radius = 0.;
+    for(int corner=0; corner<8; corner++){
+      const G4ThreeVector point(corner & 1 ? pMax.x() : pMin.x(),
+                                corner & 2 ? pMax.y() : pMin.y(),
+                                corner & 4 ? pMax.z() : pMin.z());
+      radius = std::max(radius,(rotation*point+translation).perp());
+    }
+    return radius;
+  } // BoundingRadius
+} // namespace RAT
@@ -0,0 +1,363 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::GeoCalibSourceFactory
+//
+// \brief Common base for the calibration source geometry factories
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version, envelope volume for each source. \n
+//
+//
+// \detail The tagged source, UFO and source connector factories place
+//         their parts in an envelope volume filled with the mother's
+//         material, the root of the source's own region, and only the
+//         envelope is placed in the mother (normally inner_av). A factory
+//         loads its table with LoadParams, calls BuildEnvelope and then
+//         LoadParts, builds the parts with the helpers below if nothing
+//         was read back, and ends with PlaceEnvelope. Sensitive detectors
+//         and fast models are made while building; a multithreaded
+//         application must also call ConstructSDandField from its detector
+//         construction so each worker gets its own.
+//
+//         Optional fields every source table may set:
+//
+//           vis_attributes      0 for no colours; by default none in batch
+//           check_overlaps      sampled overlap checks, tuned by
+//                               overlap_check_points, overlap_check_tolerance
+//                               (mm) and overlap_check_threads (0 = cores)
+//           profile             steps and time per volume after each run
+//           geometry_cache      directory to store the built parts in and
+//                               read them back from (full detail only)
+//           detail_level        "full"; "reduced", with screws, o-rings and
+//                               holes merged into the parts they are in; or
+//                               "envelope-only", one mixture of equal mass
+//           production_cut      (mm) and max_step (mm), min_kinetic_energy
+//                               (MeV), max_track_time (ns) for the region;
+//                               0 shares the mother region's cut or limits
+//           native_solids       polycones and hole rings (1) or the
+//                               original boolean chains (0)
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_GeoCalibSourceFactory__
+#define __RAT_GeoCalibSourceFactory__
+
+#include <RAT/GeoFactory.hh>
+#include <RAT/CalibSourceOverlapChecker.hh>
+#include <RAT/CalibSourceParams.hh>
+#include <RAT/CalibSourceGeometryCache.hh>
+#include <RAT/CalibSourceStoreWatch.hh>
+#include <G4PVPlacement.hh>
+
+#include <string>
+#include <vector>
+#include <map>
+
+class G4VSolid;
+class G4Tubs;
+class G4Material;
+class G4VisAttributes;
+class G4Region;
+
+namespace RAT
+{
+
+  class CalibSourceScanMessenger;
+  class CalibSourceResponse;
+
+  class GeoCalibSourceFactory : public GeoFactory
+  {
+  public:
+    // geometryVersion is that of the derived factory: raise it whenever a
+    // change to it alters what it builds
+    GeoCalibSourceFactory(const std::string &name, const int geometryVersion);
+    virtual ~GeoCalibSourceFactory() { };
+    // The factory's name and the versions of the shared and derived code,
+    // which stored parts must have been built by (see
+    // CalibSourceGeometryCache)
+    const std::string& GetGeometryVersion() const { return fGeometryVersion; };
+    // Move the source built from the table with this index to position in
+    // its mother, and set sample_position in the table to match. Must be
+    // called between runs.
+    static void MoveSource(const std::string &index, const G4ThreeVector &position);
+    // Whether a source with this index has been built
+    static bool IsPlaced(const std::string &index);
+    // The table the source with this index was built from
+    static DBLinkPtr GetSourceTable(const std::string &index);
+    // Create this thread's sensitive detectors for every sensitive volume
+    // of the sources built so far, and its profiling actions
+    static void ConstructSDandField();
+  protected:
+    // The parameters of a table, loaded and checked on first use and
+    // reused until the geometry is cleaned for a rebuild, so that the
+    // rebuilt source sees any change made to the table in the meantime
+    template<class Params>
+    const Params& LoadParams(DBLinkPtr table, const std::string &owner);
+    // Make the volume a CalibPMTSD with these settings, on every thread.
+    // With earlyAbort or accumulateOnly the detector is behind a
+    // CalibSourceTagGate: with earlyAbort events in which it cannot fire
+    // are aborted once the source is done, and with accumulateOnly it is
+    // only given the step that fires the tag.
+    void AddSensitiveVolume(G4LogicalVolume *logicalVolume,
+                            const std::string &detectorName,
+                            const int lcn,
+                            const double energyThreshold,
+                            const double efficiency,
+                            const bool earlyAbort = false,
+                            const bool accumulateOnly = false);
+    // Use the response table for what is emitted in the envelope's region
+    // instead of tracking it, tagging with the sensitive detector
+    // detectorName. The table must have been made from parameters with
+    // this hash.
+    void AddFastSimulation(const std::string &prefix,
+                           DBLinkPtr responseTable,
+                           const std::string &geometryHash,
+                           const std::string &detectorName);
+    // Give the logical volume the colour in the table's colorName field.
+    // Each colour field of a table is read and allocated once and then
+    // shared; in batch mode (vis_attributes 0 in the table, or without it
+    // no vis driver and no interactive session to attach one) no vis
+    // attributes are set at all.
+    void SetColor(DBLinkPtr table, G4String colorName,
+                  G4LogicalVolume *logicalVolume);
+    // Place a volume; the overlap check (if requested) is deferred until
+    // the envelope it lives in has its final shape
+    G4PVPlacement* G4PVPlacementWithCheck(G4Transform3D &Transform3D,
+                                          G4LogicalVolume *pCurrentLogical,
+                                          const G4String &pName,
+                                          G4LogicalVolume *pMotherLogical,
+                                          G4bool pMany,
+                                          G4int pCopyNo,
+                                          G4bool pSurfChk = false);
+    // Create the (as yet unshaped) envelope, filled with the mother's
+    // material, as the root of the source's region; take the overlap check
+    // settings and the region's cuts and limits from the parameters
+    G4LogicalVolume* BuildEnvelope(const CalibSourceParams &params,
+                                   const std::string &prefix,
+                                   G4LogicalVolume *motherLog);
+    // Fill the envelope with the parts of a source built before from the
+    // same parameters, if the table names a geometry_cache directory and
+    // it holds them (see CalibSourceGeometryCache), restoring the colours
+    // and sensitive volumes and queuing the overlap checks. If it does not,
+    // the parts built instead are stored there by PlaceEnvelope.
+    bool LoadParts(DBLinkPtr table,
+                   const CalibSourceParams &params,
+                   G4LogicalVolume *envelopeLog,
+                   G4bool pSurfChk = false);
+    // Shape the envelope around its daughters, place it at position in the
+    // mother and run the deferred overlap checks together
+    G4VPhysicalVolume* PlaceEnvelope(G4LogicalVolume *envelopeLog,
+                                     const G4ThreeVector &position,
+                                     G4LogicalVolume *motherLog,
+                                     const std::string &prefix,
+                                     G4bool pSurfChk = false);
+    // Solid of revolution through the given planes: a polycone, or the
+    // equivalent chain of tube and cone unions when native is false
+    G4VSolid* BuildAxialSolid(const std::string &name,
+                              const std::vector<double> &zPlanes,
+                              const std::vector<double> &rInner,
+                              const std::vector<double> &rOuter,
+                              const bool native = true);
+    // Union of solids at the given translations, in the frame of the parts:
+    // a multi-union, or a chain of unions when native is false. Its volume
+    // is worked out if the parts are coaxial, otherwise volume is used.
+    G4VSolid* BuildUnion(const std::string &name,
+                         const std::vector<G4VSolid*> &parts,
+                         const std::vector<G4ThreeVector> &translations,
+                         const bool native = true,
+                         const double volume = -1.);
+    // Ring of identical holes, ready to be removed with one subtraction. The
+    // first hole is rotated by one step before it is placed.
+    G4VSolid* BuildHolePattern(const std::string &name,
+                               G4VSolid *holeSolid,
+                               const int nHoles,
+                               G4ThreeVector holeTranslation,
+                               const bool native = true);
+    // Ring of identical cylindrical holes, the first at holeTranslation but
+    // all at z = 0 in the frame of the ring: a CalibSourceHoleRing, or a
+    // union from BuildHolePattern if the holes meet
+    G4VSolid* BuildHoleRing(const std::string &name,
+                            G4Tubs *holeSolid,
+                            const int nHoles,
+                            const G4ThreeVector &holeTranslation,
+                            const bool native = true);
+    // The solid less hole, placed at translation in its frame. The volume
+    // left is worked out if both are coaxial, otherwise volume is used.
+    G4VSolid* Subtract(const std::string &name,
+                       G4VSolid *solid,
+                       G4VSolid *hole,
+                       const G4ThreeVector &translation = G4ThreeVector(),
+                       const double volume = -1.);
+    // The solid and part together, as for Subtract
+    G4VSolid* Unite(const std::string &name,
+                    G4VSolid *solid,
+                    G4VSolid *part,
+                    const G4ThreeVector &translation = G4ThreeVector(),
+                    const double volume = -1.);
+    // A coaxial solid less a ring of holes drilled parallel to its axis,
+    // built by BuildHoleRing as holesName, with the volume left worked out
+    G4VSolid* SubtractHolePattern(const std::string &name,
+                                  G4VSolid *solid,
+                                  const std::string &holesName,
+                                  G4Tubs *holeSolid,
+                                  const int nHoles,
+                                  const G4ThreeVector &holeTranslation,
+                                  const bool native = true);
+    // The volume SubtractHolePattern would take out of the solid, or -1 if
+    // it cannot be worked out
+    double HolePatternVolume(G4VSolid *solid,
+                             G4Tubs *holeSolid,
+                             const int nHoles,
+                             const G4ThreeVector &holeTranslation);
+    // Below full detail, a feature of this volume made of material (NULL
+    // for a hole) that is left out of target. With inside the feature lay
+    // within target's outline, which target's own material now fills.
+    // PlaceEnvelope gives target a mixture of the same mass.
+    void MergeFeature(G4LogicalVolume *target,
+                      G4Material *material,
+                      const double volume,
+                      const bool inside);
+    // Outline of coaxial cylinders, each given by its z range and radius.
+    // Together the cylinders must cover their z range without a gap.
+    G4VSolid* BuildCylinderHull(const std::string &name,
+                                const std::vector<double> &zLow,
+                                const std::vector<double> &zHigh,
+                                const std::vector<double> &radius,
+                                const bool native = true);
+    // Place nCells copies of cellLog round a circle in the mother, starting
+    // one step round from firstPosition (as BuildHolePattern does). The
+    // copies are parameterised inside a ring volume filled with the mother's
+    // material, so the mother has one daughter and one overlap check.
+    G4VPhysicalVolume* PlaceBoltCircle(const std::string &name,
+                                       G4LogicalVolume *cellLog,
+                                       const int nCells,
+                                       const G4ThreeVector &firstPosition,
+                                       G4LogicalVolume *motherLog,
+                                       const bool native = true,
+                                       G4bool pSurfChk = false);
+  private:
+    // What MoveSource needs to know about a placed envelope
+    struct PlacedSource
+    {
+      PlacedSource() : envelope(NULL), region(NULL), checkOverlaps(false),
+                       detailLevel(CalibSourceParams::kFullDetail) { };
+      G4VPhysicalVolume* envelope;
+      G4Region* region;
+      std::string table;
+      std::string index;
+      bool checkOverlaps;
+      CalibSourceParams::DetailLevel detailLevel;
+      CalibSourceOverlapChecker overlapChecker;
+    };
+
+    // A volume to make sensitive, and the settings of its CalibPMTSD
+    struct SensitiveVolume
+    {
+      G4LogicalVolume* volume;
+      std::string detectorName;
+      int lcn;
+      double energyThreshold;
+      double efficiency;
+      // How it is gated, and the region of its source
+      bool earlyAbort;
+      bool accumulateOnly;
+      G4Region* region;
+    };
+
+    // An envelope region and the response table of its fast model
+    struct FastSimulatedSource
+    {
+      std::string name;
+      G4Region* region;
+      CalibSourceResponse* response;
+      std::string detectorName;
+    };
+
+    static void ConstructSensitiveDetector(const SensitiveVolume &sensitive);
+    // What the source's tags go to: the detector, or the gate in front of it
+    static std::string TagDetectorName(const std::string &detectorName);
+    static void ConstructFastModel(const FastSimulatedSource &source);
+
+    G4VSolid* BuildEnvelopeSolid(G4LogicalVolume *envelopeLog,
+                                 const std::string &name);
+    // Give each volume with merged features its mixture
+    void ApplyMergedFeatures();
+    // Replace everything in the shaped envelope with one mixture of the
+    // same mass, medium included
+    void FillEnvelope(G4LogicalVolume *envelopeLog);
+    // The masses, filling volume, as one material with the state of like
+    // (and its optical properties if optical). Mixtures among the masses
+    // are broken down into what they were made of.
+    static G4Material* BuildMixture(const std::string &name,
+                                    const std::map<G4Material*, double> &masses,
+                                    const double volume,
+                                    const G4Material *like,
+                                    const bool optical);
+    // What a volume's own material fills, less its daughters
+    static double OwnVolume(const G4LogicalVolume *volume);
+    // Add the mass of each material in the volume and all it contains
+    static void AddMasses(const G4LogicalVolume *volume,
+                          const int copies,
+                          std::map<G4Material*, double> &masses);
+    // Log the volume and mass of each part in the envelope, and the totals
+    // by material, leaving out the medium it is filled with
+    static void ReportMaterialBudget(G4LogicalVolume *envelopeLog,
+                                     const G4Material *medium,
+                                     const std::string &prefix,
+                                     const CalibSourceParams::DetailLevel detailLevel);
+    static double BoundingRadius(const G4VSolid *solid);
+    static double BoundingRadius(const G4VSolid *solid,
+                                 const G4Transform3D &transform);
+
+    // Whether vis attributes are of no use for the source in table
+    static bool IsBatchMode(DBLinkPtr table);
+    // Drop the sources, sensitive volumes and fast models of an earlier
+    // build of the geometry, whose volumes have since been deleted
+    static void ForgetEarlierBuilds();
+
+    std::vector<G4VPhysicalVolume*> fPendingOverlapChecks;
+    // What SetColor and AddSensitiveVolume did to each volume of the source
+    // being built, and where to store its parts once they are placed (empty
+    // if they are not to be)
+    CalibSourceGeometryCache::Notes fNotes;
+    std::string fCacheDirectory;
+    std::string fCacheHash;
+    std::string fGeometryVersion;
+    // Mass by material that MergeFeature moved into each volume
+    std::map<G4LogicalVolume*, std::map<G4Material*, double> > fMergedFeatures;
+    // Shared by all the factories, keyed by table name, index and field
+    static std::map<std::string, G4VisAttributes*> fVisAttributes;
+    // The source being built, and every source built so far by index
+    PlacedSource fSource;
+    static std::map<std::string, PlacedSource> fPlacedSources;
+    static CalibSourceScanMessenger* fScanMessenger;
+    // Written while the geometry is built, only read by the workers
+    static std::vector<SensitiveVolume> fSensitiveVolumes;
+    static std::vector<FastSimulatedSource> fFastSimulatedSources;
+    // The build of the geometry the three lists above belong to (see
+    // CalibSourceStoreWatch)
+    static unsigned long fGeneration;
+    // What each mixture made below full detail holds, by mass
+    static std::map<const G4Material*, std::map<G4Material*, double> > fMixtures;
+  };
+
+  template<class Params>
+  const Params& GeoCalibSourceFactory::LoadParams(DBLinkPtr table, const std::string &owner)
+  {
+    // Each with the generation of the geometry it was loaded for
+    static std::map<std::string, std::pair<unsigned long, Params> > loaded;
+    const unsigned long generation = CalibSourceStoreWatch::GetGeneration();
+    const std::string key = table->GetName() + "[" + table->GetIndex() + "]";
+    typename std::map<std::string, std::pair<unsigned long, Params> >::iterator found = loaded.find(key);
+    if(found == loaded.end())
+      found = loaded.insert(std::make_pair(key,std::make_pair(generation,Params()))).first;
+    else if(found->second.first != generation)
+      found->second = std::make_pair(generation,Params());
+    else
+      return found->second.second;
+    found->second.second.Load(table,owner);
+    return found->second.second;
+  } // LoadParams
+
+} // namespace RAT
+
+#endif
@@ -26,29 +26,20 @@
 #ifndef __RAT_GeoSourceConnectorFactory__
 #define __RAT_GeoSourceConnectorFactory__
 
-#include <RAT/GeoFactory.hh>
+#include <RAT/GeoCalibSourceFactory.hh>
 #include <G4PVPlacement.hh>
 
 namespace RAT
 {
-  class GeoSourceConnectorFactory : public GeoFactory
+  class GeoSourceConnectorFactory : public GeoCalibSourceFactory
   {
   public:
-    GeoSourceConnectorFactory() : GeoFactory("SourceConnector") {};
+    GeoSourceConnectorFactory() : GeoCalibSourceFactory("SourceConnector",1) {};
     virtual ~GeoSourceConnectorFactory() { };
     virtual void Construct(DBLinkPtr table, const bool checkOverlaps);
   private:
-    void SetColor(DBLinkPtr table, G4String colorName,
-                  G4LogicalVolume *logicalVolume);
     std::vector<double> MultiplyVectorByUnit(std::vector<double> v,
                                              const double unit);
-    G4PVPlacement* G4PVPlacementWithCheck(G4Transform3D &Transform3D,
-                                          G4LogicalVolume *pCurrentLogical,
-                                          const G4String &pName,
-                                          G4LogicalVolume *pMotherLogical,
-                                          G4bool pMany,
-                                          G4int pCopyNo,
-                                          G4bool pSurfChk = false);
   };
 
 } // namespace RAT
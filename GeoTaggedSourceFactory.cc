@@ -3,15 +3,17 @@
 ////////////////////////////////////////////////////////////////////////
 
 #include <RAT/GeoTaggedSourceFactory.hh>
+#include <RAT/TaggedSourceParams.hh>
+#include <RAT/CalibSourceVolume.hh>
+#include <RAT/CalibSourceSolidCache.hh>
+#include <RAT/CalibSourceRegistry.hh>
 
 #include <RAT/DB.hh>
 #include <RAT/Log.hh>
-#include <RAT/Detector.hh>
 #include <RAT/Materials.hh>
 #include <RAT/string_utilities.hpp>
 #include <RAT/EnvelopeConstructor.hh>
 #include <RAT/PMTConstructorParams.hh>
-#include <RAT/CalibPMTSD.hh>
 #include <RAT/ChannelEfficiency.hh>
 
 #include <G4Material.hh>
@@ -20,64 +22,24 @@
 #include <G4RotationMatrix.hh>
 
 #include <G4Tubs.hh>
-#include <G4Cons.hh>
 #include <G4Box.hh>
-#include <G4SubtractionSolid.hh>
-#include <G4UnionSolid.hh>
 #include <G4LogicalVolume.hh>
 #include <G4VPhysicalVolume.hh>
-#include <G4SDManager.hh>
 
 #include <G4VisAttributes.hh>
-#include <G4Color.hh>
 
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cmath>
 
 namespace RAT
 {
-  void GeoTaggedSourceFactory::SetColor(DBLinkPtr table, G4String colorName, G4LogicalVolume *logicalVolume)
-  {
-    // Set the color of a logical volume
-
-    G4VisAttributes *vis = new G4VisAttributes();
-    try {
-      const std::vector<double> &color = table->GetDArray(colorName);
-      Log::Assert(color.size() == 3 || color.size() == 4, "GeoTaggedSourceFactory: Color entry " + colorName + " does not have 3 (RGB) or 4 (RGBA) components");
-      if(color.size() == 3) // RGB
-        vis->SetColour(G4Colour(color[0], color[1], color[2]));
-      else if(color.size() == 4) // RGBA
-        vis->SetColour(G4Colour(color[0], color[1], color[2], color[3]));
-    }
-    catch(DBNotFoundError &e){
-      Log::Die("GeoTaggedSourceFactory: DBNotFoundError. Table " + e.table + ", index " + e.index + ", field " + e.field +".");
-    };
-
-    logicalVolume->SetVisAttributes(vis);
-  } // SetColour
-
   std::vector<double> GeoTaggedSourceFactory::MultiplyVectorByUnit(std::vector<double> v, const double unit) {
     transform(v.begin(),v.end(),v.begin(),bind2nd(std::multiplies<double>(),unit));
     return v;
   } // MultiplyVectorByUnit
 
-  G4PVPlacement* GeoTaggedSourceFactory::G4PVPlacementWithCheck(
-                                                                G4Transform3D& Transform3D,
-                                                                G4LogicalVolume* pCurrentLogical,
-                                                                const G4String& pName,
-                                                                G4LogicalVolume* pMotherLogical,
-                                                                G4bool pMany,
-                                                                G4int pCopyNo,
-                                                                G4bool pSurfChk)
-  {
-    G4PVPlacement* placement = new G4PVPlacement(Transform3D, pCurrentLogical, pName, pMotherLogical, pMany, pCopyNo, false);
-    Log::Assert(!pSurfChk || !placement->CheckOverlaps(),
-                "GeoTaggedSourceFactory: Overlap detected when placing volume " +
-                pName + ". See log for details.");
-    return placement;
-  } // G4PVPlacementWithCheck
-
 
   void GeoTaggedSourceFactory::Construct(DBLinkPtr table,
                                          const bool checkOverlaps)
@@ -92,17 +54,22 @@ namespace RAT
     DBLinkPtr pmtTable = DB::Get()->GetLink("PMT","Co60PMT");
 
     try { // To catch DBNotFoundError
+      // All the other parameters, read and checked once per table
+      const TaggedSourceParams &params =
+        LoadParams<TaggedSourceParams>(table,"GeoTaggedSourceFactory");
+
       // Check for overlap when placing volumes?
-      const bool pSurfChk = table->GetI("check_overlaps");
+      const bool pSurfChk = params.checkOverlaps;
+      // Below full detail the screws, nuts, o-rings and holes are left out
+      // and their mass merged into the parts they are in (see MergeFeature)
+      const bool reduced = params.GetDetailLevel() != CalibSourceParams::kFullDetail;
 
       const std::string index = table->GetIndex(); //Use table index as prefix
       const std::string prefix = index + "_";      // for volume names
 
       // Get the mother volume name and ensure it exists
-      const std::string motherName = table->GetS("mother");
-      //  G4LogicalVolume* const motherLog = FindMother(motherName);
-      G4LogicalVolume * const motherLog = Detector::FindLogicalVolume(motherName);
-      G4Material* motherMaterial = motherLog->GetMaterial();
+      const std::string motherName = params.mother;
+      G4LogicalVolume * const motherLog = CalibSourceRegistry::FindLogicalVolume(motherName);
       Log::Assert(motherLog != NULL,
                   "GeoTaggedSourceFactory: Unable to find mother volume '" +
                   motherName + "' for '" + index + "'.");
@@ -111,170 +78,23 @@ namespace RAT
       std::vector<double> const &pos =
         MultiplyVectorByUnit(table->GetDArray("sample_position"),CLHEP::mm);
       Log::Assert(pos.size() == 3,"GeoTaggedSourceFactory: sample_position does not have three components.");
-      G4ThreeVector samplePosition(pos[0], pos[1], pos[2]);
-
-      // =====================================
-      // Read all parameters from the database
-      // =====================================
-
-      // Container parameters
-      const double containerRadius = table->GetD("container_radius") * CLHEP::mm;
-      const double containerHeight = table->GetD("container_height") * CLHEP::mm;
-      const double containerThickness = table->GetD("container_thickness")*CLHEP::mm;
-      const double containerCollarHeight =
-        table->GetD("container_collar_height") * CLHEP::mm;
-      const double containerCollarHoleWidth =
-        table->GetD("container_collar_hole_width") * CLHEP::mm;
-      const double containerCollarHoleRad =
-        table->GetD("container_collar_hole_rad") * CLHEP::mm;
-      const double containerUpperHeight =
-        table->GetD("container_upper_height") * CLHEP::mm;
-      const double containerSlopeHeight =
-        table->GetD("container_slope_height") * CLHEP::mm;
-      const double containerFlangeRadius =
-        table->GetD("container_flange_radius") * CLHEP::mm;
-      const double containerFlangeHeight =
-        table->GetD("container_flange_thickness") * CLHEP::mm;
-      const double containerFlangeBaseHeight =
-        table->GetD("container_flange_base_height") * CLHEP::mm;
-      const double containerScrewHoleRadius =
-        table->GetD("container_screw_hole_radius") * CLHEP::mm;
-      const double containerOringGrooveDepth =
-        table->GetD("oring_groove_height") * CLHEP::mm;
-      const double containerOringGrooveWidth =
-        table->GetD("oring_groove_width") * CLHEP::mm;
-      const double containerOringGrooveInnerRadius =
-        table->GetD("oring_groove_inner_radius") * CLHEP::mm;
-      const double containerNutGrooveHeight =
-        table->GetD("container_nut_groove_height") * CLHEP::mm;
-      const double containerNutGrooveWidth =
-        table->GetD("container_nut_groove_width") * CLHEP::mm;
-      G4Material* const containerMaterial =
-        G4Material::GetMaterial(table->GetS("container_material"));
-
-      //copper box
-      const double copperBoxGap =
-        table->GetD("copper_gap") * CLHEP::mm;
-      const double copperBoxHeight =
-        table->GetD("copper_height") * CLHEP::mm;
-      const double copperBoxWidth =
-        table->GetD("copper_width") * CLHEP::mm;
-      const double copperBoxThickness =
-        table->GetD("copper_thickness") * CLHEP::mm;
-      const double copperBoxFlangeRadius =
-        table->GetD("copper_flange_rad") * CLHEP::mm;
-      const double copperBoxFlangeHeight =
-        table->GetD("copper_flange_height") * CLHEP::mm;
-      const double copperBoxFlangeLipHeight =
-        table->GetD("copper_flange_lip_height") * CLHEP::mm;
-      const double copperBoxFlangeLipWidth =
-        table->GetD("copper_flange_lip_width") * CLHEP::mm;
-      const double copperBoxFlangeLipThickness =
-        table->GetD("copper_flange_lip_thickness") * CLHEP::mm;
-      const double copperBoxGlassRadius =
-        table->GetD("copper_glass_rad") * CLHEP::mm;
-      const double copperBoxGlassHeight =
-        table->GetD("copper_glass_height") * CLHEP::mm;
-      const double copperBoxMetalRadius =
-        table->GetD("copper_metal_rad") * CLHEP::mm;
-      const double copperBoxOringInnerRad =
-        table->GetD("copper_oring_inner_rad") * CLHEP::mm;
-      const double copperBoxOringOuterRad =
-        table->GetD("copper_oring_outter_rad") * CLHEP::mm;
-      const double indiumDepthBottom =
-        table->GetD("indium_depth_bottom") * CLHEP::mm;
-      const double indiumDepthTop =
-        table->GetD("indium_depth_top") * CLHEP::mm;
-      G4Material* const copperMaterial =
-        G4Material::GetMaterial(table->GetS("copper_material"));
-      G4Material* const indiumMaterial =
-        G4Material::GetMaterial(table->GetS("indium_material"));
-      G4Material* const glassMaterial =
-        G4Material::GetMaterial(table->GetS("glass_material"));
-
-      // Stem parameters
-      const double stemFlangeRadius = containerFlangeRadius;
-      const double stemFlangeThickness =
-        table->GetD("stem_flange_thickness") * CLHEP::mm;
-      const double stemScrewHoleRadius = containerScrewHoleRadius;
-      const double connectorRadius = table->GetD("connect_radius") * CLHEP::mm;
-      const double connectorThickness = table->GetD("connect_thickness") * CLHEP::mm;
-      const double boreRadius = table->GetD("bore_radius") * CLHEP::mm;
-      const double stemFlangeEndRadius =
-        table->GetD("stem_flange_end_radius") * CLHEP::mm;
-      const double stemFlangeEndLength =
-        table->GetD("stem_flange_end_length") * CLHEP::mm;
-      const double stemConnectorEndRadius =
-        table->GetD("stem_connect_end_radius") * CLHEP::mm;
-      const double stemLength = table->GetD("stem_length") * CLHEP::mm;
-      const double stemAngle = table->GetD("stem_taper_angle") * CLHEP::deg;
-      const double stemAngledLength =
-        fabs(stemConnectorEndRadius-stemFlangeEndRadius)/tan(stemAngle);
-      const double stemConnectorEndLength = stemLength-stemFlangeThickness-
-        connectorThickness-stemFlangeEndLength-stemAngledLength;
-      G4Material* const stemMaterial =
-        G4Material::GetMaterial(table->GetS("stem_material"));
-
-      // O-ring parameters (o-ring will completely fill o-ring groove)
-      G4Material* const oringMaterial =
-        G4Material::GetMaterial(table->GetS("oring_material"));
-
-      // Screw and nut parameters (allow for lock nuts, with a different
-      // material insert)
-      const bool screwsEnable = table->GetI("screws_enable");
-      const int nScrews = table->GetI("number_of_screws");
-      const double screwDistanceFromCentre =
-        table->GetD("screw_distance_from_centre") * CLHEP::mm;
-      const double screwHeadRadius = table->GetD("screw_head_radius") * CLHEP::mm;
-      const double screwRadius = table->GetD("screw_radius") * CLHEP::mm;
-      const double screwHeadLength = table->GetD("screw_head_length") * CLHEP::mm;
-      const double screwLength = table->GetD("screw_length") * CLHEP::mm;
-      const double nutRadius = table->GetD("nut_radius") * CLHEP::mm;
-      const double nutInsertThickness =table->GetD("nut_insert_thickness")*CLHEP::mm;
-      const double nutThickness = table->GetD("nut_thickness") * CLHEP::mm;
-
-      G4Material* const screwMaterial =
-        G4Material::GetMaterial(table->GetS("screw_material"));
-
-      G4Material* const nutMaterial =
-                     G4Material::GetMaterial(table->GetS("nut_material"));
-      G4Material* const nutInsertMaterial =
-        G4Material::GetMaterial(table->GetS("nut_insert_material"));
-
-      // PMT parameters (H10721P-110) for both the active PMT part (the glass
-      // cylinder) and the aluminum body
-      const double pmtWindowRadius = table->GetD("pmt_window_radius") * CLHEP::mm;
-      const double pmtActiveRadius = table->GetD("pmt_active_radius") * CLHEP::mm;
-      const double pmtWindowInset = table->GetD("pmt_window_inset") * CLHEP::mm;
-      const double pmtLength = table->GetD("pmt_length") * CLHEP::mm;
-      const double pmtFaceLength = table->GetD("pmt_face_length") * CLHEP::mm;
-      const double pmtFaceThickness = 0.1 * CLHEP::mm;
-      G4Material* const pmtMaterial =
-        G4Material::GetMaterial(table->GetS("pmt_material"));
-      G4Material* const pmtActiveMaterial =
-        G4Material::GetMaterial(table->GetS("pmt_active_material"));
-      // PMT parameters for the active part of the PMT, which fires depending
-      // on energy deposition in the scintillator volume and an efficiency
-      // Ensure that the lcn for the pmt is one of the FECD channels, and not
-      // that channel (9207) which reads the raw trigger signal
-      const int lcn = table->GetI("lcn");
-      Log::Assert(lcn >= 9184 && lcn <=9215 && lcn != 9207, "GeoTaggedSourceFactory: LCN "
-                  +to_string(lcn)+" is outside the valid range of [9184,9215], excluding 9207.");
-      std::string detectorName = table->GetS("sensitive_detector");
-      const double pmtEfficiency = table->GetD("source_efficiency");
-      const double pmtEnergyThreshold = table->GetD("energy_threshold") * CLHEP::MeV;
-
-      // Scintillator button parameters
-      const double scintRadius = table->GetD("scintillator_radius") * CLHEP::mm;
-      const double scintThickness = table->GetD("scintillator_thickness")*CLHEP::mm;
-      G4Material* const scintMaterial =
-        G4Material::GetMaterial(table->GetS("scintillator_material"));
-
-      //not sure how to make this from other mesurements
-      const double airCopperRemoval = table->GetD("air_copper_removal") * CLHEP::mm;
-      G4Material* const airMaterial =
-      G4Material::GetMaterial(table->GetS("air_material"));
-
+      G4ThreeVector sourcePosition(pos[0], pos[1], pos[2]);
+
+      // Every part goes in an envelope filled with the mother's material and
+      // only the envelope is placed in the mother. Parts are positioned
+      // relative to the sample position, which is the envelope origin.
+      G4LogicalVolume* const envelopeLog = BuildEnvelope(params,prefix,motherLog);
+      const G4ThreeVector samplePosition(0.,0.,0.);
+
+      // The parts of a source built before from the same parameters only
+      // need placing
+      if(LoadParts(table,params,envelopeLog,pSurfChk)){
+        PlaceEnvelope(envelopeLog,sourcePosition,motherLog,prefix,pSurfChk);
+        if(params.fastSimulation)
+          AddFastSimulation(prefix,DB::Get()->GetLink(params.responseTable,index),
+                            params.GetHash(),params.detectorName);
+        return;
+      }
 
       // ===================================
       // Build the solid and logical volumes
@@ -283,512 +103,521 @@ namespace RAT
 
 
 
-      // Place the container so that the source position remains as specified
-      // relative to snoplus
-      const double containerOffset = -containerThickness/2.-containerHeight-containerCollarHeight+copperBoxHeight-copperBoxGap-scintThickness/2.+(stemLength+containerFlangeHeight+containerSlopeHeight+containerUpperHeight+containerCollarHeight+containerHeight+containerThickness)/2.;
+      // Container
+      // The container is solid delrin out to its outer surface and the air
+      // inside it is a daughter volume, so the cavity is never cut out of
+      // the container. Heights are measured from the centre of the base.
+      const double zCollar = params.containerThickness/2.+params.containerHeight;
+      const double zUpper = zCollar+params.containerCollarHeight;
+      const double zSlope = zUpper+params.containerUpperHeight;
+      const double zFlange = zSlope+params.containerSlopeHeight;
+      const double zNutGroove = zFlange+params.containerFlangeBaseHeight;
+      const double zTop = zFlange+params.containerFlangeHeight;
+      const double rNutGroove = params.containerFlangeRadius-params.containerNutGrooveWidth;
+      // The nut groove is a notch in the outer profile
+      const double containerZ[8] = {-params.containerThickness/2.,zSlope,zFlange,zNutGroove,zNutGroove,
+                                    zNutGroove+params.containerNutGrooveHeight,
+                                    zNutGroove+params.containerNutGrooveHeight,zTop};
+      const double containerR[8] = {params.containerRadius,params.containerRadius,params.containerFlangeRadius,
+                                    params.containerFlangeRadius,rNutGroove,rNutGroove,
+                                    params.containerFlangeRadius,params.containerFlangeRadius};
+      std::vector<double> containerProfileZ(containerZ,containerZ+8);
+      std::vector<double> containerProfileR(containerR,containerR+8);
+      G4VSolid* containerSolid = BuildAxialSolid(prefix+"container_solid",containerProfileZ,
+                                                 std::vector<double>(8,0.),containerProfileR,
+                                                 params.nativeSolids);
+      // Below full detail the screw holes and nut groove are filled in, as
+      // long as the volume of the holes is known
+      double containerFillVolume = reduced ? 0. : -1.;
+      if(params.screwsEnable){
+        G4Tubs* containerScrewHoleSolid = CalibSourceSolidCache::Tubs(
+                                                                      prefix+"container_screw_hole_solid",0.0,
+                                                                      params.containerScrewHoleRadius,
+                                                                      (params.containerFlangeHeight-params.containerFlangeBaseHeight)/2.0,
+                                                                      0.0,CLHEP::twopi);
+        const G4ThreeVector containerScrewHolePosition(params.screwDistanceFromCentre,0.,
+                                                       zNutGroove+params.containerUpperHeight/2.+(params.containerNutGrooveHeight+1)/2.);
+        if(reduced)
+          containerFillVolume = HolePatternVolume(containerSolid,containerScrewHoleSolid,params.nScrews,
+                                                  containerScrewHolePosition);
+        if(containerFillVolume < 0.)    // Remove all the screw holes with one subtraction
+          containerSolid = SubtractHolePattern(prefix+"container_solid",containerSolid,
+                                               prefix+"container_screw_holes_solid",containerScrewHoleSolid,
+                                               params.nScrews,containerScrewHolePosition,params.nativeSolids);
+      }
+      if(containerFillVolume >= 0.){
+        // The holes run through the groove, so fill in the full outline at
+        // once: whatever the full part leaves empty inside it
+        containerProfileZ.erase(containerProfileZ.begin()+3,containerProfileZ.begin()+7);
+        containerProfileR.erase(containerProfileR.begin()+3,containerProfileR.begin()+7);
+        containerFillVolume += CalibSourceVolume::Axial(containerProfileZ,std::vector<double>(4,0.),containerProfileR)-
+          containerSolid->GetCubicVolume();
+        containerSolid = BuildAxialSolid(prefix+"container_solid",containerProfileZ,
+                                         std::vector<double>(4,0.),containerProfileR,
+                                         params.nativeSolids);
+      }
 
+      // The logical and physical volumes
+      G4LogicalVolume* containerLog = new G4LogicalVolume(containerSolid,
+                                                          params.containerMaterial,prefix+"container_log");
+      SetColor(table,"container_colour",containerLog);
+      if(containerFillVolume > 0.)
+        MergeFeature(containerLog,NULL,containerFillVolume,true);
+
+      G4ThreeVector containerPosition(samplePosition.x(),samplePosition.y(),
+                                      samplePosition.z()-params.containerOffset-params.containerThickness/2.-params.containerHeight-
+                                      params.containerCollarHeight+params.copperBoxHeight-params.copperBoxGap-params.scintThickness/2.);
+      G4Transform3D containerTransform(*noRotation,containerPosition);
+      // Place the container relative to the source position
+      G4PVPlacementWithCheck(containerTransform,containerLog,
+                             prefix+"container_phys",envelopeLog,pMany,pCopyNo,
+                             pSurfChk);
 
+      // Fill the container with air: inside the walls, and through the square
+      // hole in the collar with the screw holes in its four corners
+      const double cavityRadius = params.containerRadius-params.containerThickness;
+      const double airContainerZ[6] = {params.containerThickness/2.,zCollar,zCollar,zUpper,zUpper,zTop};
+      const double airContainerR[6] = {cavityRadius,cavityRadius,params.containerCollarHoleRad,
+                                       params.containerCollarHoleRad,cavityRadius,cavityRadius};
+      std::vector<G4VSolid*> airContainerParts;
+      std::vector<G4ThreeVector> airContainerTranslations;
+      airContainerParts.push_back(BuildAxialSolid(prefix+"air_container_solid1",
+                                                  std::vector<double>(airContainerZ,airContainerZ+6),
+                                                  std::vector<double>(6,0.),
+                                                  std::vector<double>(airContainerR,airContainerR+6),
+                                                  params.nativeSolids));
+      airContainerTranslations.push_back(G4ThreeVector());
+      airContainerParts.push_back(CalibSourceSolidCache::Box(prefix+"air_container_solid2",
+                                                             params.containerCollarHoleWidth/2.,params.containerCollarHoleWidth/2.,
+                                                             params.containerCollarHeight/2.));//square hole in collar
+      airContainerTranslations.push_back(G4ThreeVector(0.,0.,zCollar+params.containerCollarHeight/2.));
+      // The square hole and the screw holes at its corners widen the round
+      // hole through the collar. Three quarters of each screw hole lie
+      // outside the square, clear of the round hole, as long as they fit.
+      const double collarHoleHalfWidth = params.containerCollarHoleWidth/2.;
+      const bool collarScrewHolesFit = params.containerScrewHoleRadius <= collarHoleHalfWidth &&
+        params.containerCollarHoleRad+params.containerScrewHoleRadius <= std::sqrt(2.)*collarHoleHalfWidth;
+      // Below full detail the delrin is left round those parts of the holes
+      const double collarScrewHolesVolume = 3.*CLHEP::pi*params.containerScrewHoleRadius*
+        params.containerScrewHoleRadius*params.containerCollarHeight;
+      const bool fillCollarScrewHoles = reduced && collarScrewHolesFit;
+      if(!fillCollarScrewHoles){
+        G4Tubs* collarScrewHoleSolid = CalibSourceSolidCache::Tubs(prefix+"container_collar_hole_solid",0.0,
+                                                                   params.containerScrewHoleRadius,params.containerCollarHeight/2.0,
+                                                                   0.0,CLHEP::twopi);
+        airContainerParts.push_back(BuildHoleRing(prefix+"container_collar_holes_solid",collarScrewHoleSolid,4,
+                                                  G4ThreeVector(params.containerCollarHoleWidth/2.,
+                                                                params.containerCollarHoleWidth/2.,0.),
+                                                  params.nativeSolids));
+        airContainerTranslations.push_back(G4ThreeVector(0.,0.,zCollar+params.containerCollarHeight/2.));
+      }
+      double airContainerVolume = -1.;
+      if(collarScrewHolesFit){
+        const double roundHoleArea = CLHEP::pi*params.containerCollarHoleRad*params.containerCollarHoleRad;
+        const double collarHoleArea = params.containerCollarHoleWidth*params.containerCollarHoleWidth+roundHoleArea-
+          CalibSourceVolume::SquareDiscArea(collarHoleHalfWidth,params.containerCollarHoleRad);
+        airContainerVolume = airContainerParts[0]->GetCubicVolume()+
+          params.containerCollarHeight*(collarHoleArea-roundHoleArea)+
+          (fillCollarScrewHoles ? 0. : collarScrewHolesVolume);
+      }
+      G4VSolid* airContainerSolid = BuildUnion(prefix+"air_container_solid",airContainerParts,
+                                               airContainerTranslations,params.nativeSolids,
+                                               airContainerVolume);
+      G4LogicalVolume* airContainerLog = new G4LogicalVolume(airContainerSolid,
+                                                             params.airMaterial,prefix+"air_container_log");
+      SetColor(table,"air_colour",airContainerLog);
+      if(fillCollarScrewHoles)
+        MergeFeature(containerLog,params.airMaterial,collarScrewHolesVolume,true);
 
-      // Container
-      // Make the container out of a series of additions and subtractions,
-      // since it is a cylinder with varying inner/outer radii
-      // Begin with all of the pieces that will make the final volume
-      G4VSolid* containerSolid1 = new G4Tubs(prefix+"container_solid1",0.0,
-                                             containerRadius,containerThickness/2.0,0.0,CLHEP::twopi);//container base
-      G4VSolid* containerSolid2 = new G4Tubs(prefix+"container_solid2",
-                                             containerRadius-containerThickness,
-                                             containerRadius,containerHeight/2.0,0.0,CLHEP::twopi);//container walls
-      G4VSolid* containerSolid3 = new G4Tubs(prefix+"container_solid3",
-                                             containerCollarHoleRad,containerRadius,
-                                             containerCollarHeight/2.0,0.0,CLHEP::twopi);//container collar
-      G4VSolid* containerSolid4 = new G4Box(prefix+"container_solid4",
-                                            containerCollarHoleWidth/2.,containerCollarHoleWidth/2.,
-                                            (containerCollarHeight+1)/2.);//square hole in collar
-      G4VSolid* containerSolid5 = new G4Tubs(prefix+"container_solid5",
-                                             containerRadius-containerThickness,
-                                             containerRadius,containerUpperHeight/2.,0.,CLHEP::twopi);//Upper container before slope
-      G4VSolid* containerSolid6 = new G4Cons(prefix+"container_solid6",
-                                             containerRadius-containerThickness,containerRadius,
-                                             containerRadius-containerThickness,containerFlangeRadius,
-                                             containerSlopeHeight/2.,0.,CLHEP::twopi);//slope to flange Rad
-      G4VSolid* containerSolid7 = new G4Tubs(prefix+"container_solid7",
-                                             containerRadius-containerThickness,containerFlangeRadius,
-                                             containerFlangeHeight/2.,0.,CLHEP::twopi);//Flange delrin
-      G4VSolid* containerSolid8 = new G4Tubs(prefix+"container_solid8",
-                                             containerFlangeRadius-containerNutGrooveWidth,containerFlangeRadius+1,
-                                             containerNutGrooveHeight/2.,0.,CLHEP::twopi);//Flange groove
-      G4VSolid* containerSolid9 = new G4Tubs(prefix+"container_solid9",
-                                             containerOringGrooveInnerRadius,
-                                             containerOringGrooveInnerRadius+containerOringGrooveWidth,
-                                             containerOringGrooveDepth/2.0,0.0,CLHEP::twopi);
-
-      // Now add/subtract volumes to make the container, noting that the first
-      // volume specified remains the reference for each subsequent volume
-      G4VSolid* lowerContainerSolid = new G4UnionSolid(prefix+"lower_container_solid",
-                                                       containerSolid1,containerSolid2,noRotation,
-                                                       G4ThreeVector(0.,0.,containerHeight/2.+containerThickness/2.));//add base and walls
-      G4VSolid* midContainerSolid = new G4SubtractionSolid(prefix+"mid_container_solid",
-                                                           containerSolid3,containerSolid4,noRotation,
-                                                           G4ThreeVector(0.,0.,0.));//remove square hole
-
-        G4VSolid* upperContainerSolid = new G4UnionSolid(prefix+"upper_container_solid",
-                                                         containerSolid5,containerSolid6,noRotation,
-                                                         G4ThreeVector(0.,0.,containerSlopeHeight/2.
-                                                                       +containerUpperHeight/2.));//add slope to flange
-        upperContainerSolid = new G4UnionSolid(prefix+"upper_container_solid",
-                                               upperContainerSolid,containerSolid7,noRotation,
-                                               G4ThreeVector(0.,0.,containerUpperHeight/2.+
-                                                             containerSlopeHeight+containerFlangeHeight/2.));//add container flange
-        upperContainerSolid = new G4SubtractionSolid(prefix+"upper_container_solid",
-                                                     upperContainerSolid,containerSolid8, noRotation,
-                                                     G4ThreeVector(0.,0.,containerUpperHeight/2.+containerSlopeHeight+
-                                                                   containerFlangeBaseHeight+containerNutGrooveHeight/2.));//remove groove from flange
-        upperContainerSolid = new G4SubtractionSolid(prefix+"upper_container_solid",
-                                                     upperContainerSolid,containerSolid9,noRotation,
-                                                     G4ThreeVector(0.,0.,containerUpperHeight/2.+containerSlopeHeight+
-                                                                   containerFlangeHeight-containerOringGrooveDepth/2.));
-
-        if(screwsEnable){    // Place the screw holes by subtracting them
-           G4VSolid* containerScrewHoleSolid = new G4Tubs(
-                                                         prefix+"container_screw_hole_solid",0.0,
-                                                         containerScrewHoleRadius,
-                                                         (containerFlangeHeight-containerFlangeBaseHeight)/2.0,
-                                                         0.0,CLHEP::twopi);
-           G4ThreeVector screwHoleTranslation(screwDistanceFromCentre,0.,
-                                             containerUpperHeight+containerSlopeHeight+
-                                             containerFlangeBaseHeight+(containerNutGrooveHeight+1)/2.);
-
-           for(int i=0; i<nScrews; i++){
-             screwHoleTranslation =
-               screwHoleTranslation.rotateZ(CLHEP::twopi/double(nScrews));
-             upperContainerSolid = new G4SubtractionSolid(prefix+"upper_container_solid"
-                                                          ,upperContainerSolid,containerScrewHoleSolid,noRotation,
-                                                          screwHoleTranslation);
-          }
-        }
+      // The air shares the container frame
+      G4Transform3D airContainerTransform(*noRotation,G4ThreeVector());
+      G4PVPlacementWithCheck(airContainerTransform,airContainerLog,
+                             prefix+"air_container_phys",containerLog,pMany,pCopyNo,
+                             pSurfChk);
 
-        G4VSolid* collarScrewHoleSolid = new G4Tubs(prefix+"container_collar_hole_solid",0.0,
-                                                    containerScrewHoleRadius,(containerCollarHeight+1)/2.0,
-                                                    0.0,CLHEP::twopi);
-        //holes in the four corners of the square hole
-        midContainerSolid = new G4SubtractionSolid(prefix+"mid_container_solid",
-                                                   midContainerSolid,collarScrewHoleSolid,noRotation,
-                                                   G4ThreeVector(containerCollarHoleWidth/2.,containerCollarHoleWidth/2.,0.));
-        midContainerSolid = new G4SubtractionSolid(prefix+"mid_container_solid",
-                                                   midContainerSolid,collarScrewHoleSolid,noRotation,
-                                                   G4ThreeVector(-containerCollarHoleWidth/2.,containerCollarHoleWidth/2.,0.));
-        midContainerSolid = new G4SubtractionSolid(prefix+"container_solid",
-                                                   midContainerSolid,collarScrewHoleSolid,noRotation,
-                                                   G4ThreeVector(containerCollarHoleWidth/2.,-containerCollarHoleWidth/2.,0.));
-        midContainerSolid = new G4SubtractionSolid(prefix+"container_solid",
-                                                   midContainerSolid,collarScrewHoleSolid,noRotation,
-                                                   G4ThreeVector(-containerCollarHoleWidth/2.,-containerCollarHoleWidth/2.,0.));
-
-        // The logical and physical volumes
-        G4LogicalVolume* lowerContainerLog = new G4LogicalVolume(lowerContainerSolid,
-                                      containerMaterial,prefix+"lower_container_log");
-        SetColor(table,"container_colour",lowerContainerLog);
-
-        G4ThreeVector lowerContainerPosition(samplePosition.x(),samplePosition.y(),
-                                             samplePosition.z()-containerOffset-containerThickness/2.-containerHeight-
-                                             containerCollarHeight+copperBoxHeight-copperBoxGap-scintThickness/2.);
-        G4Transform3D lowerContainerTransform(*noRotation,lowerContainerPosition);
-        // Place the container relative to the source position
-        G4PVPlacementWithCheck(lowerContainerTransform,lowerContainerLog,
-                               prefix+"lower_container_phys",motherLog,pMany,pCopyNo,
-                               pSurfChk);
-
-        G4LogicalVolume* midContainerLog = new G4LogicalVolume(midContainerSolid,
-                                                               containerMaterial,prefix+"mid_container_log");
-        SetColor(table,"container_colour",midContainerLog);
-
-        G4ThreeVector midContainerPosition(samplePosition.x(),samplePosition.y(),
-                                           lowerContainerPosition.z()+containerThickness/2.+containerHeight+containerCollarHeight/2.);
-        G4Transform3D midContainerTransform(*noRotation,midContainerPosition);
-        // Place the container relative to the source position
-        G4PVPlacementWithCheck(midContainerTransform,midContainerLog,
-                               prefix+"mid_container_phys",motherLog,pMany,pCopyNo,
-                               pSurfChk);
-
-        G4LogicalVolume* upperContainerLog = new G4LogicalVolume(upperContainerSolid,
-                                                                 containerMaterial,prefix+"upper_container_log");
-        SetColor(table,"container_colour",upperContainerLog);
-
-        G4ThreeVector upperContainerPosition(samplePosition.x(),samplePosition.y(),
-                                             midContainerPosition.z()+containerCollarHeight/2.+containerUpperHeight/2.);
-        G4Transform3D upperContainerTransform(*noRotation,upperContainerPosition);
-        // Place the container relative to the source position
-        G4PVPlacementWithCheck(upperContainerTransform,upperContainerLog,
-                               prefix+"upper_container_phys",motherLog,pMany,pCopyNo,
-                               pSurfChk);
-
-
-     // O-ring (completely fills the o-ring groove)
-        G4VSolid* oringSolid = new G4Tubs(prefix+"oring_solid",
-                                          containerOringGrooveInnerRadius,
-                                          containerOringGrooveInnerRadius+containerOringGrooveWidth,
-                                          containerOringGrooveDepth/2.0,0.0,CLHEP::twopi);
+      // O-ring (completely fills the o-ring groove)
+      const double oringOuterRadius = params.containerOringGrooveInnerRadius+params.containerOringGrooveWidth;
+      if(reduced){
+        // The o-ring fills its groove, so the flange can be left solid
+        MergeFeature(containerLog,params.oringMaterial,
+                     CLHEP::pi*(oringOuterRadius*oringOuterRadius-params.containerOringGrooveInnerRadius*
+                                params.containerOringGrooveInnerRadius)*params.containerOringGrooveDepth,true);
+      }
+      else{
+        G4VSolid* oringSolid = CalibSourceSolidCache::Tubs(prefix+"oring_solid",
+                                                           params.containerOringGrooveInnerRadius,oringOuterRadius,
+                                                           params.containerOringGrooveDepth/2.0,0.0,CLHEP::twopi);
         G4LogicalVolume* oringLog = new G4LogicalVolume(oringSolid,
-                                                        oringMaterial,prefix+"oring_log");
+                                                        params.oringMaterial,prefix+"oring_log");
 
         SetColor(table,"oring_colour",oringLog);
 
-        // Place the o-oring relative to the container
-        G4ThreeVector oringPosition(samplePosition.x(),samplePosition.y(),
-                                    upperContainerPosition.z()+containerUpperHeight/2.+containerSlopeHeight+
-                                    containerFlangeHeight-containerOringGrooveDepth/2.);
+        // Place the o-ring in the groove at the top of the container flange
+        G4ThreeVector oringPosition(0.,0.,zTop-params.containerOringGrooveDepth/2.);
         G4Transform3D oringTransform(*noRotation,oringPosition);
         G4PVPlacementWithCheck(oringTransform,oringLog,prefix+"oring_phys",
-                                 motherLog,pMany,pCopyNo,pSurfChk);
-
-        //Copper box
-        //Make the copper box out of a series of additions and subtractions
-        // Begin with all of the pieces that will make the final volume
-        G4VSolid* copperSolid1 = new G4Box(prefix+"copper_solid1",copperBoxWidth/2.,
-                                           copperBoxWidth/2.,copperBoxHeight/2.-copperBoxThickness/2.);//create box
-        G4VSolid* copperSolid2 = new G4Box(prefix+"copper_solid2",copperBoxWidth/2.-copperBoxThickness,
-                                           copperBoxWidth/2.-copperBoxThickness,copperBoxHeight/2.-copperBoxThickness);//create box void
-        G4VSolid* copperSolid3 = new G4Box(prefix+"copper_solid3",copperBoxWidth/2.,
-                                           copperBoxWidth/2.,copperBoxThickness/2.);//create bottom
-        G4VSolid* copperSolid4 = new G4Tubs(prefix+"copper_solid4",0.,
-                                            copperBoxFlangeRadius,copperBoxFlangeHeight/2.,0.,CLHEP::twopi);//create bottom flange
-        G4VSolid* copperSolid5 = new G4Box(prefix+"copper_solid5",copperBoxFlangeLipWidth/2.,copperBoxFlangeLipWidth/2.,
-                                           copperBoxFlangeLipHeight/2.);//create bottom flange lip
-        G4VSolid* copperSolid6 = new G4Box(prefix+"copper_solid6",copperBoxFlangeLipWidth/2.-copperBoxFlangeLipThickness,
-                                           copperBoxFlangeLipWidth/2.-copperBoxFlangeLipThickness,
-                                           (copperBoxFlangeLipHeight+copperBoxFlangeHeight)/2.);//create void in bottom flange and lip
-        G4VSolid* copperSolid7 = new G4Tubs(prefix+"copper_solid7",copperBoxMetalRadius, copperBoxFlangeRadius,
-                                            copperBoxFlangeHeight/2.,0.,CLHEP::twopi);//top flange
-        G4VSolid* copperSolid8 = new G4Tubs(prefix+"copper_solid8",copperBoxGlassRadius,copperBoxMetalRadius,
-                                            (copperBoxGlassHeight+copperBoxFlangeHeight)/2.,0.,CLHEP::twopi);//Metal around glass plug
-        G4VSolid* copperSolid9 = new G4Tubs(prefix+"copper_solid9",copperBoxOringInnerRad,copperBoxOringOuterRad,
-                                            (indiumDepthBottom-indiumDepthTop)/2.,0,CLHEP::twopi);
-
-
-        // Now add/subtract volumes to make the copper box, noting that the first
-        // volume specified is the reference for each subsequent volume
-        G4VSolid* copperSolid = new G4UnionSolid(prefix+"copper_solid",
-                                                 copperSolid3,copperSolid1,noRotation,
-                                                 G4ThreeVector(0.,0.,(copperBoxHeight-copperBoxThickness)/2.));//add base to walls
-        copperSolid = new G4SubtractionSolid(prefix+"copper_solid",copperSolid,copperSolid2,noRotation,
-                                             G4ThreeVector(0.,0.,(copperBoxHeight-copperBoxThickness)/2.));//take void away from box
-        copperSolid = new G4UnionSolid(prefix+"copper_solid",
-                                       copperSolid,copperSolid4,noRotation,
-                                       G4ThreeVector(0.,0.,copperBoxHeight+copperBoxFlangeHeight/2.));//add bottom flange
-
-        copperSolid = new G4UnionSolid(prefix+"copper_solid",
-                                       copperSolid,copperSolid5,noRotation,G4ThreeVector(0.,0.,
-                                        copperBoxHeight-copperBoxFlangeLipHeight/2.));//add lower lip
-        copperSolid = new G4SubtractionSolid(prefix+"copper_solid",copperSolid,copperSolid6, noRotation,
-                                             G4ThreeVector(0,0,(copperBoxHeight-(copperBoxFlangeLipHeight+copperBoxFlangeHeight)/2.)));// take void away from lip and flange
-        copperSolid = new G4UnionSolid(prefix+"copper_solid",copperSolid,copperSolid7, noRotation,
-                                       G4ThreeVector(0.,0.,copperBoxHeight+copperBoxFlangeHeight+copperBoxFlangeHeight/2.));//add top flange
-        copperSolid = new G4UnionSolid(prefix+"copper_solid",copperSolid,copperSolid8, noRotation,
-                                       G4ThreeVector(0.,0.,copperBoxHeight+copperBoxFlangeHeight+
-                                                     copperBoxFlangeHeight/2.+copperBoxGlassHeight/2.));//add metal around glass
-        copperSolid = new G4SubtractionSolid(prefix+"copper_solid",copperSolid,copperSolid9,noRotation,
-                                             G4ThreeVector(0.,0.,copperBoxHeight+copperBoxFlangeHeight
-                                                           -indiumDepthBottom+(indiumDepthBottom-indiumDepthTop)/2.));//remove indium flange gap
-
-        G4LogicalVolume* copperLog = new G4LogicalVolume(copperSolid,copperMaterial,
-                                                         prefix+"copper_log");
-        SetColor(table,"copper_colour",copperLog);
-
-        // Position the copperbox relative to the container position
-        G4ThreeVector copperPosition(samplePosition.x(),samplePosition.y(),
-                                     lowerContainerPosition.z()+containerThickness/2.+containerHeight+containerCollarHeight
-                                     -copperBoxHeight+copperBoxGap);
-        G4Transform3D copperTransform(*noRotation,copperPosition);
-
-        G4PVPlacementWithCheck(copperTransform,copperLog,prefix+"copper_phys",
-                               motherLog,pMany,pCopyNo,pSurfChk);
-
-        //glass plug
-        G4VSolid* glassSolid1 = new G4Tubs(prefix+"glass_solid1",0.,
-                                           copperBoxGlassRadius,(copperBoxGlassHeight+copperBoxFlangeHeight)/2.,
-                                           0., CLHEP::twopi);//create glass plug
-        //place plug
-        G4LogicalVolume* glassLog = new G4LogicalVolume(glassSolid1,glassMaterial,
-                                                        prefix+"glass_log");
-        SetColor(table,"glass_colour",glassLog);
-
-        // Position the glass relative to the container position
-        G4ThreeVector glassPosition(samplePosition.x(),samplePosition.y(),
-                                    copperPosition.z()+copperBoxHeight+copperBoxFlangeHeight
-                                    +(copperBoxFlangeHeight+copperBoxGlassHeight)/2.);
-        G4Transform3D glassTransform(*noRotation,glassPosition);
-        G4PVPlacementWithCheck(glassTransform,glassLog,prefix+"glass_phys",
-                               motherLog,pMany,pCopyNo,pSurfChk);
-
-        // Indium O-ring (completely fills the copper box o-ring groove)
-        G4VSolid* copperOringSolid = new G4Tubs(prefix+"copper_oring_solid",
-                                                copperBoxOringInnerRad,copperBoxOringOuterRad,
-                                                (indiumDepthBottom-indiumDepthTop)/2.,0.0,CLHEP::twopi);
+                               containerLog,pMany,pCopyNo,pSurfChk);
+      }
+
+      //Copper box
+      // The box is solid copper out to its outer surface, measured from the
+      // centre of its base, and the space inside it is a daughter volume.
+      // The flanges and the metal around the glass plug form one profile.
+      const double copperFlangeZ[4] = {params.copperBoxHeight,params.copperBoxHeight+2.*params.copperBoxFlangeHeight,
+                                       params.copperBoxHeight+2.*params.copperBoxFlangeHeight,
+                                       params.copperBoxHeight+2.*params.copperBoxFlangeHeight+params.copperBoxGlassHeight};
+      const double copperFlangeR[4] = {params.copperBoxFlangeRadius,params.copperBoxFlangeRadius,
+                                       params.copperBoxMetalRadius,params.copperBoxMetalRadius};
+      std::vector<G4VSolid*> copperParts;
+      std::vector<G4ThreeVector> copperTranslations;
+      copperParts.push_back(BuildAxialSolid(prefix+"copper_solid1",
+                                            std::vector<double>(copperFlangeZ,copperFlangeZ+4),
+                                            std::vector<double>(4,0.),
+                                            std::vector<double>(copperFlangeR,copperFlangeR+4),
+                                            params.nativeSolids));//flanges and metal around glass
+      copperTranslations.push_back(G4ThreeVector());
+      copperParts.push_back(CalibSourceSolidCache::Box(prefix+"copper_solid2",params.copperBoxWidth/2.,params.copperBoxWidth/2.,
+                                                       (params.copperBoxHeight-params.copperBoxThickness/2.)/2.));//base, walls and ceiling
+      copperTranslations.push_back(G4ThreeVector(0.,0.,(params.copperBoxHeight-1.5*params.copperBoxThickness)/2.));
+      copperParts.push_back(CalibSourceSolidCache::Box(prefix+"copper_solid3",params.copperBoxFlangeLipWidth/2.,
+                                                       params.copperBoxFlangeLipWidth/2.,params.copperBoxThickness/2.));//lip above the ceiling
+      copperTranslations.push_back(G4ThreeVector(0.,0.,params.copperBoxHeight-params.copperBoxThickness/2.));
+      // The parts only meet at their faces
+      double copperVolume = 0.;
+      for(size_t i=0; i<copperParts.size(); i++)
+        copperVolume += copperParts[i]->GetCubicVolume();
+      G4VSolid* copperSolid = BuildUnion(prefix+"copper_solid",copperParts,copperTranslations,
+                                         params.nativeSolids,copperVolume);
+
+      G4LogicalVolume* copperLog = new G4LogicalVolume(copperSolid,params.copperMaterial,
+                                                       prefix+"copper_log");
+      SetColor(table,"copper_colour",copperLog);
+
+      // Position the copper box in the air, which shares the container frame
+      G4ThreeVector copperPosition(0.,0.,params.containerThickness/2.+params.containerHeight+params.containerCollarHeight
+                                   -params.copperBoxHeight+params.copperBoxGap);
+      G4Transform3D copperTransform(*noRotation,copperPosition);
+
+      G4PVPlacementWithCheck(copperTransform,copperLog,prefix+"copper_phys",
+                             airContainerLog,pMany,pCopyNo,pSurfChk);
+
+      // The space inside the box: below the ceiling, through the lip and
+      // bottom flange, and the sliver between the lip and the walls
+      const double copperCavityHalfWidth = params.copperBoxWidth/2.-params.copperBoxThickness;
+      const double copperLipCavityHalfWidth = params.copperBoxFlangeLipWidth/2.-params.copperBoxFlangeLipThickness;
+      std::vector<G4VSolid*> copperAirParts;
+      std::vector<G4ThreeVector> copperAirTranslations;
+      copperAirParts.push_back(CalibSourceSolidCache::Box(prefix+"copper_air_solid1",copperCavityHalfWidth,
+                                                          copperCavityHalfWidth,
+                                                          (params.copperBoxHeight-params.copperBoxFlangeLipHeight-params.copperBoxThickness/2.)/2.));
+      copperAirTranslations.push_back(G4ThreeVector(0.,0.,(params.copperBoxHeight-params.copperBoxFlangeLipHeight+
+                                                           params.copperBoxThickness/2.)/2.));
+      copperAirParts.push_back(CalibSourceSolidCache::Box(prefix+"copper_air_solid2",copperLipCavityHalfWidth,
+                                                          copperLipCavityHalfWidth,
+                                                          (params.copperBoxFlangeLipHeight+params.copperBoxFlangeHeight)/2.));
+      copperAirTranslations.push_back(G4ThreeVector(0.,0.,params.copperBoxHeight-
+                                                    (params.copperBoxFlangeLipHeight+params.copperBoxFlangeHeight)/2.));
+      // The space below the ceiling and the one through the lip overlap
+      // over the bottom flange; the sliver is clear of both
+      const double copperCavityTop = params.copperBoxHeight-params.copperBoxFlangeLipHeight;
+      const double copperLipCavityBottom = copperCavityTop-params.copperBoxFlangeHeight;
+      const double copperAirOverlapHalfWidth = std::min(copperCavityHalfWidth,copperLipCavityHalfWidth);
+      double copperAirVolume = copperAirParts[0]->GetCubicVolume()+copperAirParts[1]->GetCubicVolume()-
+        std::max(0.,copperCavityTop-std::max(params.copperBoxThickness/2.,copperLipCavityBottom))*
+        4.*copperAirOverlapHalfWidth*copperAirOverlapHalfWidth;
+      if(copperCavityHalfWidth > params.copperBoxFlangeLipWidth/2.){
+        G4VSolid* copperAirSliverSolid = CalibSourceSolidCache::Box(prefix+"copper_air_solid3",copperCavityHalfWidth,
+                                                                    copperCavityHalfWidth,
+                                                                    (params.copperBoxFlangeLipHeight-1.5*params.copperBoxThickness)/2.);
+        G4VSolid* copperLipSolid = CalibSourceSolidCache::Box(prefix+"copper_air_solid4",params.copperBoxFlangeLipWidth/2.,
+                                                              params.copperBoxFlangeLipWidth/2.,params.copperBoxFlangeLipHeight);
+        const double copperAirSliverVolume = (params.copperBoxFlangeLipHeight-1.5*params.copperBoxThickness)*
+          (4.*copperCavityHalfWidth*copperCavityHalfWidth-
+           params.copperBoxFlangeLipWidth*params.copperBoxFlangeLipWidth);
+        copperAirParts.push_back(Subtract(prefix+"copper_air_sliver_solid",copperAirSliverSolid,copperLipSolid,
+                                          G4ThreeVector(),copperAirSliverVolume));
+        copperAirVolume += copperAirSliverVolume;
+        copperAirTranslations.push_back(G4ThreeVector(0.,0.,params.copperBoxHeight-(params.copperBoxFlangeLipHeight+
+                                                                             1.5*params.copperBoxThickness)/2.));
+      }
+      G4VSolid* copperAirSolid = BuildUnion(prefix+"copper_air_solid",copperAirParts,
+                                            copperAirTranslations,params.nativeSolids,copperAirVolume);
+      G4LogicalVolume* copperAirLog = new G4LogicalVolume(copperAirSolid,params.airMaterial,
+                                                          prefix+"copper_air_log");
+      SetColor(table,"air_colour",copperAirLog);
+
+      G4Transform3D copperAirTransform(*noRotation,G4ThreeVector());
+      G4PVPlacementWithCheck(copperAirTransform,copperAirLog,prefix+"copper_air_phys",
+                             copperLog,pMany,pCopyNo,pSurfChk);
+
+      //glass plug
+      G4VSolid* glassSolid1 = CalibSourceSolidCache::Tubs(prefix+"glass_solid1",0.,
+                                                          params.copperBoxGlassRadius,(params.copperBoxGlassHeight+params.copperBoxFlangeHeight)/2.,
+                                                          0., CLHEP::twopi);//create glass plug
+      //place plug
+      G4LogicalVolume* glassLog = new G4LogicalVolume(glassSolid1,params.glassMaterial,
+                                                      prefix+"glass_log");
+      SetColor(table,"glass_colour",glassLog);
+
+      // Position the glass in the copper box
+      G4ThreeVector glassPosition(0.,0.,params.copperBoxHeight+params.copperBoxFlangeHeight
+                                  +(params.copperBoxFlangeHeight+params.copperBoxGlassHeight)/2.);
+      G4Transform3D glassTransform(*noRotation,glassPosition);
+      G4PVPlacementWithCheck(glassTransform,glassLog,prefix+"glass_phys",
+                             copperLog,pMany,pCopyNo,pSurfChk);
+
+      // Indium O-ring (completely fills the copper box o-ring groove)
+      if(reduced){
+        MergeFeature(copperLog,params.indiumMaterial,
+                     CLHEP::pi*(params.copperBoxOringOuterRad*params.copperBoxOringOuterRad-
+                                params.copperBoxOringInnerRad*params.copperBoxOringInnerRad)*
+                     (params.indiumDepthBottom-params.indiumDepthTop),true);
+      }
+      else{
+        G4VSolid* copperOringSolid = CalibSourceSolidCache::Tubs(prefix+"copper_oring_solid",
+                                                                 params.copperBoxOringInnerRad,params.copperBoxOringOuterRad,
+                                                                 (params.indiumDepthBottom-params.indiumDepthTop)/2.,0.0,CLHEP::twopi);
         G4LogicalVolume* copperOringLog = new G4LogicalVolume(copperOringSolid,
-                                                              indiumMaterial,prefix+"copper_oring_log");
+                                                              params.indiumMaterial,prefix+"copper_oring_log");
         SetColor(table,"indium_colour",copperOringLog);
 
-        // Place the Indium o-oring relative to the container
-        G4ThreeVector copperOringPosition(samplePosition.x(),samplePosition.y(),
-                                          copperPosition.z()+copperBoxHeight+copperBoxFlangeHeight-
-                                          indiumDepthBottom+(indiumDepthBottom-indiumDepthTop)/2.);
+        // Place the Indium o-ring in the copper box flange
+        G4ThreeVector copperOringPosition(0.,0.,params.copperBoxHeight+params.copperBoxFlangeHeight-
+                                          params.indiumDepthBottom+(params.indiumDepthBottom-params.indiumDepthTop)/2.);
         G4Transform3D copperOringTransform(*noRotation,copperOringPosition);
         G4PVPlacementWithCheck(copperOringTransform,copperOringLog,prefix+"copper_oring_phys",
-                               motherLog,pMany,pCopyNo,pSurfChk);
-
-        // Stem
-        // Make the stem out of a series of additions and subtractions, since
-        // it is a cylinder with varying inner/outer radii
-        // Begin with all of the pieces that will make the final volume
-        G4VSolid* stemSolid1 = new G4Tubs(prefix+"stem_solid1",boreRadius,
-                                          stemFlangeRadius,stemFlangeThickness/2.0,0.0,CLHEP::twopi);
-        G4VSolid* stemSolid2 = new G4Tubs(prefix+"stem_solid2",boreRadius,
-                                          stemFlangeEndRadius,stemFlangeEndLength/2.0,0.0,CLHEP::twopi);
-        G4VSolid* stemSolid3 = new G4Cons(prefix+"stem_solid3",boreRadius,
-                                          stemFlangeEndRadius,boreRadius,stemConnectorEndRadius,
-                                          stemAngledLength/2.0,0.0,CLHEP::twopi);//angled part of stem
-        G4VSolid* stemSolid4 = new G4Tubs(prefix+"stem_solid4",boreRadius,
-                                          stemConnectorEndRadius,stemConnectorEndLength/2.0,
-                                          0.0,CLHEP::twopi);
-        G4VSolid* stemSolid5 = new G4Tubs(prefix+"stem_solid5",0.0,
-                                          connectorRadius,connectorThickness/2.0,0.0,CLHEP::twopi);
-
-        // Now add/subtract volumes to make the stem, noting that the first
-        // volume specified is the reference for each subsequent volume
-        G4VSolid* stemSolid = new G4UnionSolid(prefix+"stem_solid",stemSolid1,
-                                               stemSolid2,noRotation,
-                                               G4ThreeVector(0.,0.,(stemFlangeThickness+stemFlangeEndLength)/2.0));
-        stemSolid = new G4UnionSolid(prefix+"stem_solid",stemSolid,stemSolid3,
-                             noRotation,G4ThreeVector(0.,0.,stemFlangeEndLength+
-                             (stemFlangeThickness+stemAngledLength)/2.0));
-        stemSolid = new G4UnionSolid(prefix+"stem_solid",stemSolid,stemSolid4,
-                             noRotation,G4ThreeVector(0.,0.,stemFlangeEndLength+
-                             stemAngledLength+stemFlangeThickness/2.0+
-                             stemConnectorEndLength/2.0));
-        stemSolid = new G4UnionSolid(prefix+"stem_solid",stemSolid,stemSolid5,
-                             noRotation,G4ThreeVector(0.,0.,stemLength-
-                             (stemFlangeThickness+connectorThickness)/2.0));
-        // Now place the screw holes by subtracting them. There are two holes,
-        // one for the screw head and one for the body.
-        if(screwsEnable){
-            G4VSolid* stemScrewHoleSolid = new G4Tubs(
-                                                      prefix+"stem_screw_hole_solid",0.0,stemScrewHoleRadius,
-                                                      (stemFlangeThickness+1)/2.0,0.0,CLHEP::twopi);
-
-            G4ThreeVector screwHoleTranslation(screwDistanceFromCentre,0.,
-                                               0);
-            for(int i=0; i<nScrews; i++){
-                screwHoleTranslation =
-                screwHoleTranslation.rotateZ(CLHEP::twopi/double(nScrews));
-                stemSolid = new G4SubtractionSolid(prefix+"stem_solid",
-                                                   stemSolid,stemScrewHoleSolid,noRotation,
-                                                   screwHoleTranslation);
-            }
-        }
-
-        G4LogicalVolume* stemLog = new G4LogicalVolume(stemSolid,stemMaterial,
-                                                       prefix+"stem_log");
-        SetColor(table,"stem_colour",stemLog);
-
-        // Position the stem relative to the container position
-        G4ThreeVector stemPosition(samplePosition.x(),samplePosition.y(),
-                                   upperContainerPosition.z()
-                                   +containerUpperHeight/2.+containerFlangeHeight+containerSlopeHeight+stemFlangeThickness/2.);
-        G4Transform3D stemTransform(*noRotation,stemPosition);
-        G4PVPlacementWithCheck(stemTransform,stemLog,prefix+"stem_phys",
-                                   motherLog,pMany,pCopyNo,pSurfChk);
-
-      //Fill space in stem with air
-      G4VSolid* airStemSolid1 = new G4Tubs(prefix+"air_stem_solid",0.0,
-                                        boreRadius,stemFlangeThickness/2.0,0.0,CLHEP::twopi);
-      G4VSolid* airStemSolid2 = new G4Tubs(prefix+"air_stem_solid2",0.0,
-                                        boreRadius,stemFlangeEndLength/2.0,0.0,CLHEP::twopi);
-      G4VSolid* airStemSolid3 = new G4Tubs(prefix+"air_stem_solid3",0.0,
-                                        boreRadius,stemAngledLength/2.0,0.0,CLHEP::twopi);
-      G4VSolid* airStemSolid4 = new G4Tubs(prefix+"air_stem_solid4",0.0,
-                                        boreRadius,stemConnectorEndLength/2.0,
-                                        0.0,CLHEP::twopi);
-
-      // Now add/subtract volumes to make the stem, noting that the first
-      // volume specified is the reference for each subsequent volume
-      G4VSolid* airStemSolid = new G4UnionSolid(prefix+"air_stem_solid",airStemSolid1,
-                                             airStemSolid2,noRotation,
-                                             G4ThreeVector(0.,0.,(stemFlangeThickness+stemFlangeEndLength)/2.0));
-      airStemSolid = new G4UnionSolid(prefix+"air_stem_solid",airStemSolid,airStemSolid3,
-                                   noRotation,G4ThreeVector(0.,0.,stemFlangeEndLength+
-                                                            (stemFlangeThickness+stemAngledLength)/2.0));
-      airStemSolid = new G4UnionSolid(prefix+"air_stem_solid",airStemSolid,airStemSolid4,
-                                   noRotation,G4ThreeVector(0.,0.,stemFlangeEndLength+
-                                                            stemAngledLength+stemFlangeThickness/2.0+
-                                                            stemConnectorEndLength/2.0));
-
-      G4LogicalVolume* airStemLog = new G4LogicalVolume(airStemSolid,airMaterial,
-                                                     prefix+"air_stem_log");
+                               copperLog,pMany,pCopyNo,pSurfChk);
+      }
+
+      // Stem
+      // The stem is solid out to its outer profile, measured from the centre
+      // of the flange, and the air in the bore is a daughter volume
+      const double zFlangeEnd = params.stemFlangeThickness/2.;
+      const double zAngled = zFlangeEnd+params.stemFlangeEndLength;
+      const double zConnectorEnd = zAngled+params.stemAngledLength;
+      const double zConnector = zConnectorEnd+params.stemConnectorEndLength;
+      const double stemZ[8] = {-params.stemFlangeThickness/2.,zFlangeEnd,zFlangeEnd,zAngled,
+                               zConnectorEnd,zConnector,zConnector,zConnector+params.connectorThickness};
+      const double stemR[8] = {params.stemFlangeRadius,params.stemFlangeRadius,params.stemFlangeEndRadius,
+                               params.stemFlangeEndRadius,params.stemConnectorEndRadius,params.stemConnectorEndRadius,
+                               params.connectorRadius,params.connectorRadius};
+      G4VSolid* stemSolid = BuildAxialSolid(prefix+"stem_solid",
+                                            std::vector<double>(stemZ,stemZ+8),
+                                            std::vector<double>(8,0.),
+                                            std::vector<double>(stemR,stemR+8),
+                                            params.nativeSolids);
+      double stemHolesVolume = -1.;
+      if(params.screwsEnable){
+        G4Tubs* stemScrewHoleSolid = CalibSourceSolidCache::Tubs(
+                                                                 prefix+"stem_screw_hole_solid",0.0,params.stemScrewHoleRadius,
+                                                                 (params.stemFlangeThickness+1)/2.0,0.0,CLHEP::twopi);
+        const G4ThreeVector stemScrewHolePosition(params.screwDistanceFromCentre,0.,0.);
+        if(reduced)    // Filled in, if their volume is known
+          stemHolesVolume = HolePatternVolume(stemSolid,stemScrewHoleSolid,params.nScrews,stemScrewHolePosition);
+        if(stemHolesVolume < 0.)    // Remove all the screw holes with one subtraction
+          stemSolid = SubtractHolePattern(prefix+"stem_solid",stemSolid,prefix+"stem_screw_holes_solid",
+                                          stemScrewHoleSolid,params.nScrews,stemScrewHolePosition,
+                                          params.nativeSolids);
+      }
+
+      G4LogicalVolume* stemLog = new G4LogicalVolume(stemSolid,params.stemMaterial,
+                                                     prefix+"stem_log");
+      SetColor(table,"stem_colour",stemLog);
+      if(stemHolesVolume > 0.)
+        MergeFeature(stemLog,NULL,stemHolesVolume,true);
+
+      // Position the stem relative to the container position
+      G4ThreeVector stemPosition(samplePosition.x(),samplePosition.y(),
+                                 containerPosition.z()+zTop+params.stemFlangeThickness/2.);
+      G4Transform3D stemTransform(*noRotation,stemPosition);
+      G4PVPlacementWithCheck(stemTransform,stemLog,prefix+"stem_phys",
+                             envelopeLog,pMany,pCopyNo,pSurfChk);
+
+      //Fill space in stem with air, up to the connector
+      const double airStemZ[2] = {-params.stemFlangeThickness/2.,zConnector};
+      const double airStemR[2] = {params.boreRadius,params.boreRadius};
+      G4VSolid* airStemSolid = BuildAxialSolid(prefix+"air_stem_solid",
+                                               std::vector<double>(airStemZ,airStemZ+2),
+                                               std::vector<double>(2,0.),
+                                               std::vector<double>(airStemR,airStemR+2),
+                                               params.nativeSolids);
+
+      G4LogicalVolume* airStemLog = new G4LogicalVolume(airStemSolid,params.airMaterial,
+                                                        prefix+"air_stem_log");
       SetColor(table,"air_colour",airStemLog);
 
-      // Position the air in the stem
-      G4Transform3D airStemTransform(*noRotation,stemPosition);
-      G4PVPlacementWithCheck(stemTransform,airStemLog,prefix+"air_stem_phys",
-                             motherLog,pMany,pCopyNo,pSurfChk);
-
-      //fill the lower container with air
-      G4VSolid* airContainerSolid1 = new G4Tubs(prefix+"air_container_solid1",
-                                                0.0,containerRadius-containerThickness,
-                                                containerHeight/2.0,0.0,CLHEP::twopi);
-      G4VSolid* airContainerSolid2 = new G4Box(prefix+"air_container_solid2",copperBoxWidth/2.,
-                                               copperBoxWidth/2.,copperBoxHeight/2.);//create copper box hole
-      //remove the copper box from the air volume
-      G4VSolid* airContainerSolid = new G4SubtractionSolid(prefix+"air_container_solid",
-                                                           airContainerSolid1,airContainerSolid2,noRotation,
-                                                           G4ThreeVector(0.,0.,containerHeight/2-airCopperRemoval));
-      // The logical and physical volumes
-      G4LogicalVolume* airContainerLog = new G4LogicalVolume(airContainerSolid,
-                                                             airMaterial,prefix+"air_container_log");
-      SetColor(table,"air_colour",airContainerLog);
-
-      G4ThreeVector airContainerPosition(samplePosition.x(),samplePosition.y(),
-                                         samplePosition.z()-containerOffset+containerHeight/2.-scintThickness/2.-containerThickness/2.);
-      G4Transform3D airContainerTransform(*noRotation,airContainerPosition);
-      // Place the container relative to the source position
-      G4PVPlacementWithCheck(airContainerTransform,airContainerLog,
-                             prefix+"air_container_phys",motherLog,pMany,pCopyNo,
-                             pSurfChk);
+      // The air shares the stem frame
+      G4Transform3D airStemTransform(*noRotation,G4ThreeVector());
+      G4PVPlacementWithCheck(airStemTransform,airStemLog,prefix+"air_stem_phys",
+                             stemLog,pMany,pCopyNo,pSurfChk);
 
 
      // Screws and nuts (if enabled)
-        if(screwsEnable){
-            // The screws
-            G4VSolid* screwSolid = new G4Tubs(prefix+"screw_solid",0.0,
-                                            screwRadius,screwLength/2.0,
-                                            0.0,CLHEP::twopi);
-            G4VSolid* screwHeadSolid = new G4Tubs(prefix+"screw_head_solid",0.0,
-                                            screwHeadRadius,screwHeadLength/2.0,
-                                            0.0,CLHEP::twopi);
-            screwSolid = new G4UnionSolid(prefix+"screw_solid",screwSolid,
-                                            screwHeadSolid,noRotation,
-                                            G4ThreeVector(0.,0.,
-                                           (screwLength-screwHeadLength)/2.0));
-            G4LogicalVolume* screwLog = new G4LogicalVolume(screwSolid,
-                                            screwMaterial,prefix+"screw_log");
-            SetColor(table,"screw_colour",screwLog);
-
-            // Place the screws relative to the stem position
+        if(params.screwsEnable && reduced){
+            // Each screw goes into the stem flange it holds down, and its
+            // nut and insert into the container flange
+            const double screwZ[4] = {-params.screwLength/2.,params.screwLength/2.-params.screwHeadLength,
+                                      params.screwLength/2.-params.screwHeadLength,params.screwLength/2.};
+            const double screwR[4] = {params.screwRadius,params.screwRadius,params.screwHeadRadius,params.screwHeadRadius};
+            MergeFeature(stemLog,params.screwMaterial,
+                         params.nScrews*CalibSourceVolume::Axial(std::vector<double>(screwZ,screwZ+4),
+                                                                 std::vector<double>(4,0.),
+                                                                 std::vector<double>(screwR,screwR+4)),false);
+            const double insertRadius = params.screwRadius+params.nutInsertThickness;
+            MergeFeature(containerLog,params.nutMaterial,
+                         params.nScrews*CLHEP::pi*(params.nutRadius*params.nutRadius-insertRadius*insertRadius)*
+                         params.nutThickness,false);
+            MergeFeature(containerLog,params.nutInsertMaterial,
+                         params.nScrews*CLHEP::pi*(insertRadius*insertRadius-params.screwRadius*params.screwRadius)*
+                         params.nutThickness,false);
+        }
+        else if(params.screwsEnable){
+            // Each screw with its nut sits in a cell shaped to fit round them,
+            // centred on the screw. The cells are placed round the flange as
+            // one parameterised volume, with a copy number for each screw.
             G4ThreeVector screwPosition(samplePosition.x()+
-                                 screwDistanceFromCentre,samplePosition.y(),
+                                 params.screwDistanceFromCentre,samplePosition.y(),
                                  stemPosition.z()+
-                                (stemFlangeThickness-screwLength)/2.+
-                                 screwHeadLength);
+                                (params.stemFlangeThickness-params.screwLength)/2.+
+                                 params.screwHeadLength);
+            // The nuts sit in the groove in the container flange
+            const double nutOffset = containerPosition.z()+zNutGroove+params.containerNutGrooveHeight/2.-
+              screwPosition.z();
+
+            const double boltZLow[3] = {-params.screwLength/2.,params.screwLength/2.-params.screwHeadLength,
+                                        nutOffset-params.nutThickness/2.};
+            const double boltZHigh[3] = {params.screwLength/2.-params.screwHeadLength,params.screwLength/2.,
+                                         nutOffset+params.nutThickness/2.};
+            const double boltRadius[3] = {params.screwRadius,params.screwHeadRadius,params.nutRadius};
+            G4VSolid* boltSolid = BuildCylinderHull(prefix+"bolt_solid",
+                                                    std::vector<double>(boltZLow,boltZLow+3),
+                                                    std::vector<double>(boltZHigh,boltZHigh+3),
+                                                    std::vector<double>(boltRadius,boltRadius+3),
+                                                    params.nativeSolids);
+            G4LogicalVolume* boltLog = new G4LogicalVolume(boltSolid,envelopeLog->GetMaterial(),
+                                                           prefix+"bolt_log");
+            boltLog->SetVisAttributes(G4VisAttributes::Invisible);
+
+            // The screws (shaft and head as one profile)
+            const double screwZ[4] = {-params.screwLength/2.,params.screwLength/2.-params.screwHeadLength,
+                                      params.screwLength/2.-params.screwHeadLength,params.screwLength/2.};
+            const double screwR[4] = {params.screwRadius,params.screwRadius,params.screwHeadRadius,params.screwHeadRadius};
+            G4VSolid* screwSolid = BuildAxialSolid(prefix+"screw_solid",
+                                                   std::vector<double>(screwZ,screwZ+4),
+                                                   std::vector<double>(4,0.),
+                                                   std::vector<double>(screwR,screwR+4),
+                                                   params.nativeSolids);
+            G4LogicalVolume* screwLog = new G4LogicalVolume(screwSolid,
+                                            params.screwMaterial,prefix+"screw_log");
+            SetColor(table,"screw_colour",screwLog);
             // The nuts
-            G4VSolid* nutSolid = new G4Tubs(prefix+"nut_solid",
-                                        screwRadius+nutInsertThickness,
-                                        nutRadius,nutThickness/2.0,0.0,CLHEP::twopi);
-            G4LogicalVolume* nutLog = new G4LogicalVolume(nutSolid,nutMaterial,
+            G4VSolid* nutSolid = CalibSourceSolidCache::Tubs(prefix+"nut_solid",
+                                        params.screwRadius+params.nutInsertThickness,
+                                        params.nutRadius,params.nutThickness/2.0,0.0,CLHEP::twopi);
+            G4LogicalVolume* nutLog = new G4LogicalVolume(nutSolid,params.nutMaterial,
                                                       prefix+"nut_log");
             SetColor(table,"nut_colour",nutLog);
-            G4VSolid* nutInsertSolid = new G4Tubs(prefix+"nut_insert_solid",
-                             screwRadius,screwRadius+nutInsertThickness,
-                             nutThickness/2.0,0.0,CLHEP::twopi);
+            G4VSolid* nutInsertSolid = CalibSourceSolidCache::Tubs(prefix+"nut_insert_solid",
+                             params.screwRadius,params.screwRadius+params.nutInsertThickness,
+                             params.nutThickness/2.0,0.0,CLHEP::twopi);
             G4LogicalVolume* nutInsertLog = new G4LogicalVolume(nutInsertSolid,
-                                     nutInsertMaterial,prefix+"nut_insert_log");
+                                     params.nutInsertMaterial,prefix+"nut_insert_log");
             SetColor(table,"nut_insert_colour",nutInsertLog);
-            // Place the nuts relative to the stem position
-            G4ThreeVector nutPosition(screwPosition.x(),screwPosition.y(),
-                                      upperContainerPosition.z()+containerUpperHeight/2.+containerSlopeHeight+containerFlangeBaseHeight+containerNutGrooveHeight/2.);
-
-            // Physically place the nuts and screws
-            for(int i=0; i<nScrews; i++){
-                screwPosition = screwPosition.rotateZ(CLHEP::twopi/double(nScrews));
-                nutPosition = nutPosition.rotateZ(CLHEP::twopi/double(nScrews));
-                G4Transform3D screwTransform(*noRotation,screwPosition);
-                G4Transform3D nutTransform(*noRotation,nutPosition);
-                G4Transform3D nutInsertTransform(*noRotation,nutPosition);
-                G4PVPlacementWithCheck(screwTransform,screwLog,
-                               prefix+"screw_phys_"+to_string(i),motherLog,
-                               pMany,pCopyNo,pSurfChk);
-                G4PVPlacementWithCheck(nutTransform,nutLog,
-                               prefix+"nut_phys_"+to_string(i),motherLog,
-                               pMany,pCopyNo,pSurfChk);
-                G4PVPlacementWithCheck(nutInsertTransform,nutInsertLog,
-                               prefix+"nut_insert_phys_"+to_string(i),
-                               motherLog,pMany,pCopyNo,pSurfChk);
-            }
+
+            // Physically place the screw and nut in the cell, then the cells
+            G4Transform3D screwTransform(*noRotation,G4ThreeVector());
+            G4Transform3D nutTransform(*noRotation,G4ThreeVector(0.,0.,nutOffset));
+            G4PVPlacementWithCheck(screwTransform,screwLog,prefix+"screw_phys",
+                                   boltLog,pMany,pCopyNo,pSurfChk);
+            G4PVPlacementWithCheck(nutTransform,nutLog,prefix+"nut_phys",
+                                   boltLog,pMany,pCopyNo,pSurfChk);
+            G4PVPlacementWithCheck(nutTransform,nutInsertLog,prefix+"nut_insert_phys",
+                                   boltLog,pMany,pCopyNo,pSurfChk);
+            PlaceBoltCircle(prefix+"bolt",boltLog,params.nScrews,screwPosition,envelopeLog,
+                            params.nativeSolids,pSurfChk);
         }
 
      // PMT
         // The PMT body (metal enclosure)
-        G4VSolid* pmtSolid = new G4Box(prefix+"pmt_solid",pmtFaceLength/2.0,
-                                        pmtFaceLength/2.0,pmtLength/2.0);
-        G4VSolid* pmtInsetSolid = new G4Tubs(prefix+"pmt_inset_solid",0.0,
-                                        pmtWindowRadius,
-                                        (pmtWindowInset+pmtFaceThickness)/2.0,
+        G4VSolid* pmtSolid = CalibSourceSolidCache::Box(prefix+"pmt_solid",params.pmtFaceLength/2.0,
+                                                         params.pmtFaceLength/2.0,params.pmtLength/2.0);
+        G4VSolid* pmtInsetSolid = CalibSourceSolidCache::Tubs(prefix+"pmt_inset_solid",0.0,
+                                        params.pmtWindowRadius,
+                                        (params.pmtWindowInset+params.pmtFaceThickness)/2.0,
                                         0.0,CLHEP::twopi);
-        pmtSolid = new G4SubtractionSolid(prefix+"pmt_solid",pmtSolid,
-                             pmtInsetSolid,noRotation,G4ThreeVector(0.,0.,
-                             -(pmtLength-pmtWindowInset-pmtFaceThickness)/2.0));
-
-        G4LogicalVolume* pmtLog = new G4LogicalVolume(pmtSolid,pmtMaterial,
+        // The inset is cut into the end of the body
+        const double pmtVolume = pmtSolid->GetCubicVolume()-
+          CalibSourceVolume::SquareDiscArea(params.pmtFaceLength/2.,params.pmtWindowRadius)*
+          std::min(params.pmtWindowInset+params.pmtFaceThickness,params.pmtLength);
+        pmtSolid = Subtract(prefix+"pmt_solid",pmtSolid,pmtInsetSolid,
+                            G4ThreeVector(0.,0.,-(params.pmtLength-params.pmtWindowInset-params.pmtFaceThickness)/2.0),
+                            pmtVolume);
+
+        G4LogicalVolume* pmtLog = new G4LogicalVolume(pmtSolid,params.pmtMaterial,
                                                       prefix+"pmt_log");
         SetColor(table,"pmt_colour",pmtLog);
 
-        // Position the PMT relative to the scintillator
-        G4ThreeVector pmtPosition(samplePosition.x(),samplePosition.y(),
-                                  copperPosition.z()+pmtLength/2.+(copperBoxThickness+scintThickness+pmtWindowInset)/2.);
+        // The PMT and scintillator sit in the air inside the copper box,
+        // which shares the copper box frame
+        G4ThreeVector pmtPosition(0.,0.,params.pmtLength/2.+(params.copperBoxThickness+params.scintThickness+params.pmtWindowInset)/2.);
         G4Transform3D pmtTransform(*noRotation,pmtPosition);
         G4PVPlacementWithCheck(pmtTransform,pmtLog,prefix+"pmt_phys",
-                               motherLog,pMany,pCopyNo,pSurfChk);
+                               copperAirLog,pMany,pCopyNo,pSurfChk);
 
         // The non-active part of the PMT face
-        G4VSolid* pmtFaceSolid = new G4Tubs(prefix+"pmt_face_solid",
-                                            pmtActiveRadius,pmtWindowRadius,
-                                            pmtFaceThickness/2.0,0.0,CLHEP::twopi);
+        G4VSolid* pmtFaceSolid = CalibSourceSolidCache::Tubs(prefix+"pmt_face_solid",
+                                                             params.pmtActiveRadius,params.pmtWindowRadius,
+                                                             params.pmtFaceThickness/2.0,0.0,CLHEP::twopi);
         G4LogicalVolume* pmtFaceLog = new G4LogicalVolume(pmtFaceSolid,
-                                     pmtActiveMaterial,prefix+"pmt_face_log");
+                                     params.pmtActiveMaterial,prefix+"pmt_face_log");
         SetColor(table,"pmt_colour",pmtFaceLog);
 
-        G4ThreeVector pmtFacePosition(samplePosition.x(),samplePosition.y(),
-                                      copperPosition.z()+(scintThickness+pmtFaceThickness));
+        G4ThreeVector pmtFacePosition(0.,0.,params.scintThickness+params.pmtFaceThickness);
         G4Transform3D pmtFaceTransform(*noRotation,pmtFacePosition);
         G4PVPlacementWithCheck(pmtFaceTransform,pmtFaceLog,
-                   prefix+"pmt_face_phys",motherLog,pMany,pCopyNo,pSurfChk);
+                   prefix+"pmt_face_phys",copperAirLog,pMany,pCopyNo,pSurfChk);
 
         // The active part of the PMT face
-        G4VSolid* pmtActiveSolid = new G4Tubs(prefix+"pmt_active_solid",
-                                             0.0,pmtActiveRadius,
-                                             pmtFaceThickness/2.0,0.0,CLHEP::twopi);
+        G4VSolid* pmtActiveSolid = CalibSourceSolidCache::Tubs(prefix+"pmt_active_solid",
+                                                              0.0,params.pmtActiveRadius,
+                                                              params.pmtFaceThickness/2.0,0.0,CLHEP::twopi);
         G4LogicalVolume* pmtActiveLog = new G4LogicalVolume(pmtActiveSolid,
-                                   pmtActiveMaterial,prefix+"pmt_active_log");
+                                   params.pmtActiveMaterial,prefix+"pmt_active_log");
         SetColor(table,"pmt_colour",pmtActiveLog);
 
-        G4ThreeVector pmtActivePosition(samplePosition.x(),samplePosition.y(),
-                                        copperPosition.z()+copperBoxThickness+(scintThickness+pmtFaceThickness));
+        G4ThreeVector pmtActivePosition(0.,0.,params.copperBoxThickness+(params.scintThickness+params.pmtFaceThickness));
         G4Transform3D pmtActiveTransform(*noRotation,pmtActivePosition);
         G4PVPlacementWithCheck(pmtActiveTransform,pmtActiveLog,
-                 prefix+"pmt_active_phys",motherLog,pMany,pCopyNo,pSurfChk);
+                 prefix+"pmt_active_phys",copperAirLog,pMany,pCopyNo,pSurfChk);
 
         // Scintillator button
-        G4VSolid* scintSolid = new G4Tubs(prefix+"scintillator_solid",0.0,
-                                          scintRadius,scintThickness/2.0,0.0,CLHEP::twopi);
+        G4VSolid* scintSolid = CalibSourceSolidCache::Tubs(prefix+"scintillator_solid",0.0,
+                                                           params.scintRadius,params.scintThickness/2.0,0.0,CLHEP::twopi);
         G4LogicalVolume* scintLog = new G4LogicalVolume(scintSolid,
-                                      scintMaterial,prefix+"scintillator_log");
+                                      params.scintMaterial,prefix+"scintillator_log");
         SetColor(table,"scintillator_colour",scintLog);
 
         // Make the scintillator sensitive (the PMT will record a photoelectron
-        // based on a non-zero energy deposition in the scintillator)
-        G4SDManager* sDManager = G4SDManager::GetSDMpointer();
-        CalibPMTSD* pmtSD = new CalibPMTSD(detectorName,lcn,pmtEnergyThreshold,
-                                           pmtEfficiency);
-        sDManager->AddNewDetector(pmtSD);
-        scintLog->SetSensitiveDetector(pmtSD);
-
-        // Place the scintillator (its centre is where the source is, by
-        // assumption)
-        G4ThreeVector scintPosition(samplePosition.x(),samplePosition.y(),
-                                    copperPosition.z()+scintThickness/2.+copperBoxThickness);
+        // based on a non-zero energy deposition in the scintillator). The
+        // detector itself is created per thread.
+        AddSensitiveVolume(scintLog,params.detectorName,params.lcn,params.pmtEnergyThreshold,
+                           params.pmtEfficiency,params.earlyAbort,params.accumulateTag);
+
+        // Place the scintillator on the floor of the copper box
+        G4ThreeVector scintPosition(0.,0.,params.scintThickness/2.+params.copperBoxThickness);
         G4Transform3D scintTransform(*noRotation,scintPosition);
         G4PVPlacementWithCheck(scintTransform,scintLog,
-                                    prefix+"scintillator_phys",motherLog,
+                                    prefix+"scintillator_phys",copperAirLog,
                                     pMany,pCopyNo,pSurfChk);
 
+
+      // Wrap the envelope around the parts and place it in the mother
+      PlaceEnvelope(envelopeLog,sourcePosition,motherLog,prefix,pSurfChk);
+
+      // Optionally skip tracking through the capsule altogether
+      if(params.fastSimulation)
+        AddFastSimulation(prefix,DB::Get()->GetLink(params.responseTable,index),
+                          params.GetHash(),params.detectorName);
     }
     catch(DBNotFoundError &e) {
         Log::Die("GeoTaggedSourceFactory: DBNotFoundError. Table " + e.table + ", index " + e.index + ", field " + e.field + ".");
@@ -32,36 +32,36 @@
 //             /generator/add co60source
 //             /generator/add sc46source
 //
+//         The parts are nested: the air fills the container, the copper
+//         box sits in the air and the scintillator and PMT sit in the air
+//         inside the copper box. Each outer solid is filled, so no cavity
+//         has to be subtracted from its mother.
+//
+//         With native_solids set in the table the solids of revolution and
+//         the unions are built as polycones and multi-unions rather than as
+//         chains of booleans.
+//
 ////////////////////////////////////////////////////////////////////////
 
 #ifndef __RAT_GeoTaggedSourceFactory__
 #define __RAT_GeoTaggedSourceFactory__
 
-#include <RAT/GeoFactory.hh>
+#include <RAT/GeoCalibSourceFactory.hh>
 #include <G4PVPlacement.hh>
 
 namespace RAT
 {
 
-  class GeoTaggedSourceFactory : public GeoFactory
+  class GeoTaggedSourceFactory : public GeoCalibSourceFactory
   {
   public:
-    GeoTaggedSourceFactory() : GeoFactory("TaggedSource") {};
+    GeoTaggedSourceFactory() : GeoCalibSourceFactory("TaggedSource",1) {};
     virtual ~GeoTaggedSourceFactory() { };
     //virtual G4VPhysicalVolume* Construct(DBLinkPtr table);
     virtual void Construct(DBLinkPtr table, const bool checkOverlaps);
   private:
-    void SetColor(DBLinkPtr table, G4String colorName,
-                  G4LogicalVolume *logicalVolume);
     std::vector<double> MultiplyVectorByUnit(std::vector<double> v,
                                              const double unit);
-    G4PVPlacement* G4PVPlacementWithCheck(G4Transform3D &Transform3D,
-                                          G4LogicalVolume *pCurrentLogical,
-                                          const G4String &pName,
-                                          G4LogicalVolume *pMotherLogical,
-                                          G4bool pMany,
-                                          G4int pCopyNo,
-                                          G4bool pSurfChk = false);
   };
 
 } // namespace RAT
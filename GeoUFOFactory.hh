@@ -25,30 +25,21 @@
 #ifndef __RAT_GeoUFOFactory__
 #define __RAT_GeoUFOFactory__
 
-#include <RAT/GeoFactory.hh>
+#include <RAT/GeoCalibSourceFactory.hh>
 #include <G4PVPlacement.hh>
 
 namespace RAT
 {
 
-  class GeoUFOFactory : public GeoFactory
+  class GeoUFOFactory : public GeoCalibSourceFactory
   {
   public:
-    GeoUFOFactory() : GeoFactory("UFO") {};
+    GeoUFOFactory() : GeoCalibSourceFactory("UFO",1) {};
     virtual ~GeoUFOFactory() { };
     virtual void Construct(DBLinkPtr table, const bool checkOverlaps);
   private:
-    void SetColor(DBLinkPtr table, G4String colorName,
-                  G4LogicalVolume *logicalVolume);
     std::vector<double> MultiplyVectorByUnit(std::vector<double> v,
                                              const double unit);
-    G4PVPlacement* G4PVPlacementWithCheck(G4Transform3D &Transform3D,
-                                          G4LogicalVolume *pCurrentLogical,
-                                          const G4String &pName,
-                                          G4LogicalVolume *pMotherLogical,
-                                          G4bool pMany,
-                                          G4int pCopyNo,
-                                          G4bool pSurfChk = false);
   };
 
 } // namespace RAT
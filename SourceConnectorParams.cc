@@ -0,0 +1,38 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/SourceConnectorParams.hh>
+
+#include <G4SystemOfUnits.hh>
+
+namespace RAT
+{
+  void SourceConnectorParams::Visit(CalibSourceParamVisitor &visitor)
+  {
+    CalibSourceParams::Visit(visitor);
+
+    visitor.Field("quick_connect_radius",quickConnectRadius,CLHEP::mm);
+    visitor.Field("quick_connect_inner_radius",quickConnectInnerRadius,CLHEP::mm);
+    visitor.Field("quick_connect_height",quickConnectHeight,CLHEP::mm);
+    visitor.Field("quick_connect_plate_thickness",quickConnectPlateThickness,CLHEP::mm);
+    visitor.Field("quick_connect_material",quickConnectMaterialName);
+    visitor.Field("air_material",airMaterialName);
+  } // Visit
+
+  void SourceConnectorParams::Derive(std::vector<std::string> &problems)
+  {
+    quickConnectMaterial = FindMaterial(quickConnectMaterialName,problems);
+    airMaterial = FindMaterial(airMaterialName,problems);
+  } // Derive
+
+  void SourceConnectorParams::Validate(std::vector<std::string> &problems) const
+  {
+    CalibSourceParams::Validate(problems);
+
+    if(quickConnectInnerRadius >= quickConnectRadius)
+      problems.push_back("quick_connect_inner_radius must be less than quick_connect_radius");
+    if(quickConnectPlateThickness >= quickConnectHeight)
+      problems.push_back("quick_connect_plate_thickness must be less than quick_connect_height");
+  } // Validate
+} // namespace RAT
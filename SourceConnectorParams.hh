@@ -0,0 +1,39 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::SourceConnectorParams
+//
+// \brief Parameters of the source connector geometry table
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version, split out of GeoSourceConnectorFactory. \n
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_SourceConnectorParams__
+#define __RAT_SourceConnectorParams__
+
+#include <RAT/CalibSourceParams.hh>
+
+namespace RAT
+{
+
+  struct SourceConnectorParams : public CalibSourceParams
+  {
+    virtual void Visit(CalibSourceParamVisitor &visitor);
+    virtual void Derive(std::vector<std::string> &problems);
+    virtual void Validate(std::vector<std::string> &problems) const;
+
+    double quickConnectRadius;
+    double quickConnectInnerRadius;
+    double quickConnectHeight;
+    double quickConnectPlateThickness;
+    std::string quickConnectMaterialName;
+    std::string airMaterialName;
+
+    // Derived
+    G4Material* quickConnectMaterial;
+    G4Material* airMaterial;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/TaggedSourceParams.hh>
+
+#include <RAT/string_utilities.hpp>
+
+#include <G4SystemOfUnits.hh>
+
+#include <cmath>
+
+namespace RAT
+{
+  TaggedSourceParams::TaggedSourceParams()
+    : screwsEnable(false), nScrews(0), lcn(0), earlyAbort(false), accumulateTag(false), fastSimulation(false),
+      responseTable("CALIB_SOURCE_RESPONSE"), pmtFaceThickness(0.1 * CLHEP::mm)
+  {
+  }
+
+  void TaggedSourceParams::Visit(CalibSourceParamVisitor &visitor)
+  {
+    CalibSourceParams::Visit(visitor);
+
+    visitor.Field("container_radius",containerRadius,CLHEP::mm);
+    visitor.Field("container_height",containerHeight,CLHEP::mm);
+    visitor.Field("container_thickness",containerThickness,CLHEP::mm);
+    visitor.Field("container_collar_height",containerCollarHeight,CLHEP::mm);
+    visitor.Field("container_collar_hole_width",containerCollarHoleWidth,CLHEP::mm);
+    visitor.Field("container_collar_hole_rad",containerCollarHoleRad,CLHEP::mm);
+    visitor.Field("container_upper_height",containerUpperHeight,CLHEP::mm);
+    visitor.Field("container_slope_height",containerSlopeHeight,CLHEP::mm);
+    visitor.Field("container_flange_radius",containerFlangeRadius,CLHEP::mm);
+    visitor.Field("container_flange_thickness",containerFlangeHeight,CLHEP::mm);
+    visitor.Field("container_flange_base_height",containerFlangeBaseHeight,CLHEP::mm);
+    visitor.Field("container_screw_hole_radius",containerScrewHoleRadius,CLHEP::mm);
+    visitor.Field("oring_groove_height",containerOringGrooveDepth,CLHEP::mm);
+    visitor.Field("oring_groove_width",containerOringGrooveWidth,CLHEP::mm);
+    visitor.Field("oring_groove_inner_radius",containerOringGrooveInnerRadius,CLHEP::mm);
+    visitor.Field("container_nut_groove_height",containerNutGrooveHeight,CLHEP::mm);
+    visitor.Field("container_nut_groove_width",containerNutGrooveWidth,CLHEP::mm);
+    visitor.Field("container_material",containerMaterialName);
+
+    visitor.Field("copper_gap",copperBoxGap,CLHEP::mm);
+    visitor.Field("copper_height",copperBoxHeight,CLHEP::mm);
+    visitor.Field("copper_width",copperBoxWidth,CLHEP::mm);
+    visitor.Field("copper_thickness",copperBoxThickness,CLHEP::mm);
+    visitor.Field("copper_flange_rad",copperBoxFlangeRadius,CLHEP::mm);
+    visitor.Field("copper_flange_height",copperBoxFlangeHeight,CLHEP::mm);
+    visitor.Field("copper_flange_lip_height",copperBoxFlangeLipHeight,CLHEP::mm);
+    visitor.Field("copper_flange_lip_width",copperBoxFlangeLipWidth,CLHEP::mm);
+    visitor.Field("copper_flange_lip_thickness",copperBoxFlangeLipThickness,CLHEP::mm);
+    visitor.Field("copper_glass_rad",copperBoxGlassRadius,CLHEP::mm);
+    visitor.Field("copper_glass_height",copperBoxGlassHeight,CLHEP::mm);
+    visitor.Field("copper_metal_rad",copperBoxMetalRadius,CLHEP::mm);
+    visitor.Field("copper_oring_inner_rad",copperBoxOringInnerRad,CLHEP::mm);
+    visitor.Field("copper_oring_outter_rad",copperBoxOringOuterRad,CLHEP::mm);
+    visitor.Field("indium_depth_bottom",indiumDepthBottom,CLHEP::mm);
+    visitor.Field("indium_depth_top",indiumDepthTop,CLHEP::mm);
+    visitor.Field("copper_material",copperMaterialName);
+    visitor.Field("indium_material",indiumMaterialName);
+    visitor.Field("glass_material",glassMaterialName);
+
+    visitor.Field("stem_flange_thickness",stemFlangeThickness,CLHEP::mm);
+    visitor.Field("connect_radius",connectorRadius,CLHEP::mm);
+    visitor.Field("connect_thickness",connectorThickness,CLHEP::mm);
+    visitor.Field("bore_radius",boreRadius,CLHEP::mm);
+    visitor.Field("stem_flange_end_radius",stemFlangeEndRadius,CLHEP::mm);
+    visitor.Field("stem_flange_end_length",stemFlangeEndLength,CLHEP::mm);
+    visitor.Field("stem_connect_end_radius",stemConnectorEndRadius,CLHEP::mm);
+    visitor.Field("stem_length",stemLength,CLHEP::mm);
+    visitor.Field("stem_taper_angle",stemAngle,CLHEP::deg);
+    visitor.Field("stem_material",stemMaterialName);
+
+    visitor.Field("oring_material",oringMaterialName);
+
+    visitor.Field("screws_enable",screwsEnable);
+    visitor.Field("number_of_screws",nScrews);
+    visitor.Field("screw_distance_from_centre",screwDistanceFromCentre,CLHEP::mm);
+    visitor.Field("screw_head_radius",screwHeadRadius,CLHEP::mm);
+    visitor.Field("screw_radius",screwRadius,CLHEP::mm);
+    visitor.Field("screw_head_length",screwHeadLength,CLHEP::mm);
+    visitor.Field("screw_length",screwLength,CLHEP::mm);
+    visitor.Field("nut_radius",nutRadius,CLHEP::mm);
+    visitor.Field("nut_insert_thickness",nutInsertThickness,CLHEP::mm);
+    visitor.Field("nut_thickness",nutThickness,CLHEP::mm);
+    visitor.Field("screw_material",screwMaterialName);
+    visitor.Field("nut_material",nutMaterialName);
+    visitor.Field("nut_insert_material",nutInsertMaterialName);
+
+    visitor.Field("pmt_window_radius",pmtWindowRadius,CLHEP::mm);
+    visitor.Field("pmt_active_radius",pmtActiveRadius,CLHEP::mm);
+    visitor.Field("pmt_window_inset",pmtWindowInset,CLHEP::mm);
+    visitor.Field("pmt_length",pmtLength,CLHEP::mm);
+    visitor.Field("pmt_face_length",pmtFaceLength,CLHEP::mm);
+    visitor.Field("pmt_material",pmtMaterialName);
+    visitor.Field("pmt_active_material",pmtActiveMaterialName);
+    visitor.Field("lcn",lcn);
+    visitor.Field("sensitive_detector",detectorName);
+    visitor.Field("source_efficiency",pmtEfficiency,1.);
+    visitor.Field("energy_threshold",pmtEnergyThreshold,CLHEP::MeV);
+    visitor.Field("early_abort",earlyAbort,true);
+    visitor.Field("accumulate_tag",accumulateTag,true);
+
+    visitor.Field("scintillator_radius",scintRadius,CLHEP::mm);
+    visitor.Field("scintillator_thickness",scintThickness,CLHEP::mm);
+    visitor.Field("scintillator_material",scintMaterialName);
+
+    visitor.Field("air_material",airMaterialName);
+
+    visitor.Field("fast_simulation",fastSimulation,true);
+    visitor.Field("response_table",responseTable,true);
+  } // Visit
+
+  void TaggedSourceParams::Derive(std::vector<std::string> &problems)
+  {
+    // The stem flange is the same size as the container flange, and the
+    // screws pass through holes of the same size in both
+    stemFlangeRadius = containerFlangeRadius;
+    stemScrewHoleRadius = containerScrewHoleRadius;
+    stemAngledLength = fabs(stemConnectorEndRadius-stemFlangeEndRadius)/tan(stemAngle);
+    stemConnectorEndLength = stemLength-stemFlangeThickness-
+      connectorThickness-stemFlangeEndLength-stemAngledLength;
+
+    // Place the container so that the source position remains as specified
+    // relative to snoplus
+    containerOffset = -containerThickness/2.-containerHeight-containerCollarHeight+copperBoxHeight-copperBoxGap-scintThickness/2.+(stemLength+containerFlangeHeight+containerSlopeHeight+containerUpperHeight+containerCollarHeight+containerHeight+containerThickness)/2.;
+
+    containerMaterial = FindMaterial(containerMaterialName,problems);
+    copperMaterial = FindMaterial(copperMaterialName,problems);
+    indiumMaterial = FindMaterial(indiumMaterialName,problems);
+    glassMaterial = FindMaterial(glassMaterialName,problems);
+    stemMaterial = FindMaterial(stemMaterialName,problems);
+    oringMaterial = FindMaterial(oringMaterialName,problems);
+    screwMaterial = FindMaterial(screwMaterialName,problems);
+    nutMaterial = FindMaterial(nutMaterialName,problems);
+    nutInsertMaterial = FindMaterial(nutInsertMaterialName,problems);
+    pmtMaterial = FindMaterial(pmtMaterialName,problems);
+    pmtActiveMaterial = FindMaterial(pmtActiveMaterialName,problems);
+    scintMaterial = FindMaterial(scintMaterialName,problems);
+    airMaterial = FindMaterial(airMaterialName,problems);
+  } // Derive
+
+  void TaggedSourceParams::Validate(std::vector<std::string> &problems) const
+  {
+    CalibSourceParams::Validate(problems);
+
+    // Ensure that the lcn for the pmt is one of the FECD channels, and not
+    // that channel (9207) which reads the raw trigger signal
+    if(lcn < 9184 || lcn > 9215 || lcn == 9207)
+      problems.push_back("lcn " + to_string(lcn) + " is outside the valid range of [9184,9215], excluding 9207");
+    if(containerThickness >= containerRadius)
+      problems.push_back("container_thickness must be less than container_radius");
+    if(stemAngle <= 0.)
+      problems.push_back("stem_taper_angle must be positive");
+    else if(stemConnectorEndLength <= 0.)
+      problems.push_back("stem_length leaves no room for the stem after its flange, taper and connector");
+    if(copperBoxWidth/2.-copperBoxThickness < pmtFaceLength/2.)
+      problems.push_back("copper_width leaves no room for the PMT (pmt_face_length)");
+    if(screwsEnable && nScrews <= 0)
+      problems.push_back("number_of_screws must be positive when screws_enable is set");
+    if(screwsEnable && screwRadius >= containerScrewHoleRadius)
+      problems.push_back("screw_radius must be less than container_screw_hole_radius");
+    // Filled in, the source has no scintillator to tag with
+    if(GetDetailLevel() == kEnvelopeOnly && (earlyAbort || accumulateTag || fastSimulation))
+      problems.push_back("early_abort, accumulate_tag and fast_simulation need the scintillator, "
+                         "so detail_level cannot be \"envelope-only\"");
+  } // Validate
+} // namespace RAT
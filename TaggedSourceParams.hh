@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::TaggedSourceParams
+//
+// \brief Parameters of the tagged source geometry table
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version, split out of GeoTaggedSourceFactory. \n
+//
+//
+// \detail Lengths are in Geant4 units. The stem taper and the offset of
+//         the container from the sample position are derived once the
+//         fields are loaded, as are the materials.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_TaggedSourceParams__
+#define __RAT_TaggedSourceParams__
+
+#include <RAT/CalibSourceParams.hh>
+
+namespace RAT
+{
+
+  struct TaggedSourceParams : public CalibSourceParams
+  {
+    TaggedSourceParams();
+
+    virtual void Visit(CalibSourceParamVisitor &visitor);
+    virtual void Derive(std::vector<std::string> &problems);
+    virtual void Validate(std::vector<std::string> &problems) const;
+
+    // Container
+    double containerRadius;
+    double containerHeight;
+    double containerThickness;
+    double containerCollarHeight;
+    double containerCollarHoleWidth;
+    double containerCollarHoleRad;
+    double containerUpperHeight;
+    double containerSlopeHeight;
+    double containerFlangeRadius;
+    double containerFlangeHeight;
+    double containerFlangeBaseHeight;
+    double containerScrewHoleRadius;
+    double containerOringGrooveDepth;
+    double containerOringGrooveWidth;
+    double containerOringGrooveInnerRadius;
+    double containerNutGrooveHeight;
+    double containerNutGrooveWidth;
+    std::string containerMaterialName;
+
+    // Copper box
+    double copperBoxGap;
+    double copperBoxHeight;
+    double copperBoxWidth;
+    double copperBoxThickness;
+    double copperBoxFlangeRadius;
+    double copperBoxFlangeHeight;
+    double copperBoxFlangeLipHeight;
+    double copperBoxFlangeLipWidth;
+    double copperBoxFlangeLipThickness;
+    double copperBoxGlassRadius;
+    double copperBoxGlassHeight;
+    double copperBoxMetalRadius;
+    double copperBoxOringInnerRad;
+    double copperBoxOringOuterRad;
+    double indiumDepthBottom;
+    double indiumDepthTop;
+    std::string copperMaterialName;
+    std::string indiumMaterialName;
+    std::string glassMaterialName;
+
+    // Stem
+    double stemFlangeThickness;
+    double connectorRadius;
+    double connectorThickness;
+    double boreRadius;
+    double stemFlangeEndRadius;
+    double stemFlangeEndLength;
+    double stemConnectorEndRadius;
+    double stemLength;
+    double stemAngle;
+    std::string stemMaterialName;
+
+    // O-ring
+    std::string oringMaterialName;
+
+    // Screws and nuts
+    bool screwsEnable;
+    int nScrews;
+    double screwDistanceFromCentre;
+    double screwHeadRadius;
+    double screwRadius;
+    double screwHeadLength;
+    double screwLength;
+    double nutRadius;
+    double nutInsertThickness;
+    double nutThickness;
+    std::string screwMaterialName;
+    std::string nutMaterialName;
+    std::string nutInsertMaterialName;
+
+    // PMT and its sensitive detector
+    double pmtWindowRadius;
+    double pmtActiveRadius;
+    double pmtWindowInset;
+    double pmtLength;
+    double pmtFaceLength;
+    std::string pmtMaterialName;
+    std::string pmtActiveMaterialName;
+    int lcn;
+    std::string detectorName;
+    double pmtEfficiency;
+    double pmtEnergyThreshold;
+    // Abort events in which the tag cannot fire, and only hand
+    // CalibPMTSD the step that fires it
+    bool earlyAbort;
+    bool accumulateTag;
+
+    // Scintillator button
+    double scintRadius;
+    double scintThickness;
+    std::string scintMaterialName;
+
+    std::string airMaterialName;
+
+    // Replace tracking in the capsule with the response table
+    bool fastSimulation;
+    std::string responseTable;
+
+    // Derived
+    double stemFlangeRadius;
+    double stemScrewHoleRadius;
+    double stemAngledLength;
+    double stemConnectorEndLength;
+    double pmtFaceThickness;
+    double containerOffset;
+    G4Material* containerMaterial;
+    G4Material* copperMaterial;
+    G4Material* indiumMaterial;
+    G4Material* glassMaterial;
+    G4Material* stemMaterial;
+    G4Material* oringMaterial;
+    G4Material* screwMaterial;
+    G4Material* nutMaterial;
+    G4Material* nutInsertMaterial;
+    G4Material* pmtMaterial;
+    G4Material* pmtActiveMaterial;
+    G4Material* scintMaterial;
+    G4Material* airMaterial;
+  };
+
+} // namespace RAT
+
+#endif
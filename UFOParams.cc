@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////
+// Last svn revision: $Id$
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/UFOParams.hh>
+
+#include <G4SystemOfUnits.hh>
+
+namespace RAT
+{
+  void UFOParams::Visit(CalibSourceParamVisitor &visitor)
+  {
+    CalibSourceParams::Visit(visitor);
+
+    // In the blue print measurements are in inches, keep so can see conversion
+    const double inch = 25.4 * CLHEP::mm;
+
+    visitor.Field("acrylic_radius",acrylicRadius,CLHEP::mm);
+    visitor.Field("acrylic_height",acrylicHeight,CLHEP::mm);
+    visitor.Field("acrylic_inner_rad",acrylicInnerRad,CLHEP::mm);
+    visitor.Field("acrylic_collar_height",acrylicCollarHeight,CLHEP::mm);
+    visitor.Field("acrylic_collar_rad",acrylicCollarRad,CLHEP::mm);
+    visitor.Field("acrylic_oring_groove_thickness",acrylicOringGrooveThickness,CLHEP::mm);
+    visitor.Field("acrylic_oring_groove_rad",acrylicOringGrooveRad,CLHEP::mm);
+    visitor.Field("acrylic_oring_groove_height",acrylicOringGrooveHeight,CLHEP::mm);
+    visitor.Field("acrylic_LED_height",acrylicLEDHeight,CLHEP::mm);
+    visitor.Field("acrylic_material",acrylicMaterialName);
+    visitor.Field("oring_material",oringMaterialName);
+
+    visitor.Field("cap_inner_rad",capInnerRadius,inch);
+    visitor.Field("cap_radius",capRadius,inch);
+    visitor.Field("cap_thickness",capThickness,inch);
+    visitor.Field("cap_space_rad",capSpaceRadius,inch);
+    visitor.Field("cap_space_thk",capSpaceThickness,inch);
+    visitor.Field("cap_material",capMaterialName);
+
+    visitor.Field("bottom_cup_radius",bottomCupRadius,inch);
+    visitor.Field("bottom_cup_height",bottomCupHeight,inch);
+    visitor.Field("bottom_cup_top_inner_rad",bottomCupTopInnerRadius,inch);
+    visitor.Field("bottom_cup_top_height",bottomCupTopHeight,inch);
+    visitor.Field("bottom_cup_mid_inner_rad",bottomCupMidInnerRadius,inch);
+    visitor.Field("bottom_cup_mid_height",bottomCupMidHeight,inch);
+    visitor.Field("bottom_cup_bot_inner_rad",bottomCupBotInnerRadius,inch);
+    visitor.Field("bottom_cup_bot_outer_rad",bottomCupBotOuterRadius,inch);
+    visitor.Field("bottom_cup_bot_outer_height",bottomCupBotOuterHeight,inch);
+    visitor.Field("bottom_cup_mid_top_height",bottomCupMidTopHeight,inch);
+    visitor.Field("bottom_cup_gap",bottomCupGap,inch);
+    visitor.Field("bottom_cup_material",bottomCupMaterialName);
+
+    visitor.Field("bottom_disc_radius",bottomDiscRadius,CLHEP::mm);
+    visitor.Field("bottom_disc_inner_radius",bottomDiscInnerRadius,CLHEP::mm);
+    visitor.Field("bottom_disc_thickness",bottomDiscThickness,CLHEP::mm);
+    visitor.Field("bottom_disc_hole_radius",bottomDiscHoleRadius,CLHEP::mm);
+    visitor.Field("bottom_disc_distance_rad",bottomDiscDistanceRad,CLHEP::mm);
+    visitor.Field("bottom_disc_material",bottomDiscMaterialName);
+
+    visitor.Field("electronics_rad",electronicsRadius,CLHEP::mm);
+    visitor.Field("electronics_thk",electronicsThickness,CLHEP::mm);
+    visitor.Field("electronics_material",electronicsMaterialName);
+
+    visitor.Field("air_material",airMaterialName);
+  } // Visit
+
+  void UFOParams::Derive(std::vector<std::string> &problems)
+  {
+    acrylicMaterial = FindMaterial(acrylicMaterialName,problems);
+    oringMaterial = FindMaterial(oringMaterialName,problems);
+    electronicsMaterial = FindMaterial(electronicsMaterialName,problems);
+    capMaterial = FindMaterial(capMaterialName,problems);
+    bottomCupMaterial = FindMaterial(bottomCupMaterialName,problems);
+    bottomDiscMaterial = FindMaterial(bottomDiscMaterialName,problems);
+    airMaterial = FindMaterial(airMaterialName,problems);
+  } // Derive
+
+  void UFOParams::Validate(std::vector<std::string> &problems) const
+  {
+    CalibSourceParams::Validate(problems);
+
+    if(acrylicInnerRad >= acrylicCollarRad || acrylicCollarRad >= acrylicRadius)
+      problems.push_back("acrylic_inner_rad, acrylic_collar_rad and acrylic_radius must increase");
+    if(2.*acrylicCollarHeight >= acrylicHeight)
+      problems.push_back("acrylic_height must leave room for a collar at each end");
+    if(capInnerRadius >= capRadius)
+      problems.push_back("cap_inner_rad must be less than cap_radius");
+    if(bottomDiscDistanceRad+bottomDiscHoleRadius >= bottomDiscRadius ||
+       bottomDiscDistanceRad-bottomDiscHoleRadius <= bottomDiscInnerRadius)
+      problems.push_back("the bottom disc holes must lie between bottom_disc_inner_radius and bottom_disc_radius");
+  } // Validate
+} // namespace RAT
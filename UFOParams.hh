@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////
+// \class RAT::UFOParams
+//
+// \brief Parameters of the UFO geometry table
+//
+// REVISION HISTORY:\n
+//     17/10/2026 : First version, split out of GeoUFOFactory. \n
+//
+//
+// \detail Lengths are in Geant4 units. The cap and bottom cup are given
+//         in inches in the table, as on the blueprint, and are converted
+//         when loaded.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef __RAT_UFOParams__
+#define __RAT_UFOParams__
+
+#include <RAT/CalibSourceParams.hh>
+
+namespace RAT
+{
+
+  struct UFOParams : public CalibSourceParams
+  {
+    virtual void Visit(CalibSourceParamVisitor &visitor);
+    virtual void Derive(std::vector<std::string> &problems);
+    virtual void Validate(std::vector<std::string> &problems) const;
+
+    // Acrylic container
+    double acrylicRadius;
+    double acrylicHeight;
+    double acrylicInnerRad;
+    double acrylicCollarHeight;
+    double acrylicCollarRad;
+    double acrylicOringGrooveThickness;
+    double acrylicOringGrooveRad;
+    double acrylicOringGrooveHeight;
+    double acrylicLEDHeight;
+    std::string acrylicMaterialName;
+    std::string oringMaterialName;
+
+    // Cap
+    double capInnerRadius;
+    double capRadius;
+    double capThickness;
+    double capSpaceRadius;
+    double capSpaceThickness;
+    std::string capMaterialName;
+
+    // Bottom connection to the UFO
+    double bottomCupRadius;
+    double bottomCupHeight;
+    double bottomCupTopInnerRadius;
+    double bottomCupTopHeight;
+    double bottomCupMidInnerRadius;
+    double bottomCupMidHeight;
+    double bottomCupBotInnerRadius;
+    double bottomCupBotOuterRadius;
+    double bottomCupBotOuterHeight;
+    double bottomCupMidTopHeight;
+    double bottomCupGap;
+    std::string bottomCupMaterialName;
+
+    // Bottom disc
+    double bottomDiscRadius;
+    double bottomDiscInnerRadius;
+    double bottomDiscThickness;
+    double bottomDiscHoleRadius;
+    double bottomDiscDistanceRad;
+    std::string bottomDiscMaterialName;
+
+    // Electronics
+    double electronicsRadius;
+    double electronicsThickness;
+    std::string electronicsMaterialName;
+
+    std::string airMaterialName;
+
+    // Derived
+    G4Material* acrylicMaterial;
+    G4Material* oringMaterial;
+    G4Material* electronicsMaterial;
+    G4Material* capMaterial;
+    G4Material* bottomCupMaterial;
+    G4Material* bottomDiscMaterial;
+    G4Material* airMaterial;
+  };
+
+} // namespace RAT
+
+#endif
@@ -0,0 +1,492 @@
+////////////////////////////////////////////////////////////////////////
+// calib_source_bench
+//
+// Times the navigation calls of every solid of a calibration source:
+//
+//     calib_source_bench <geo file> <index> [calls] [output .json]
+//                        [world material]
+//
+// The source is built by its factory (TaggedSource, UFO or
+// SourceConnector) from the GEO table with the given index, alone in an
+// otherwise empty world; no run manager is needed. Each solid of the
+// source (every logical volume whose name starts with "<index>_") is then
+// given calls (default 1000000) of each of
+//
+//     Inside(p)              points drawn over its bounding box
+//     DistanceToIn(p,v)      those points outside it, random directions
+//     DistanceToOut(p,v)     those points inside it, random directions
+//     SurfaceNormal(p)       points on its surface, found along those rays
+//
+// and the mean time per call in ns is written as JSON (to the output file,
+// or the standard output), together with the hash of the source parameters
+// so that runs on different geometry revisions can be told apart.
+//
+// Every CalibSourceHoleRing found in those solids, and a few standalone
+// rings of other shapes, are first compared call by call with the
+// G4MultiUnion of G4Tubs they replace: Inside, both DistanceToIn and both
+// DistanceToOut, and SurfaceNormal, at random points in, out and on the
+// holes with random directions. Any disagreement is reported, counted in
+// the JSON, and makes the bench exit with status 1.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/GeoTaggedSourceFactory.hh>
+#include <RAT/GeoUFOFactory.hh>
+#include <RAT/GeoSourceConnectorFactory.hh>
+#include <RAT/TaggedSourceParams.hh>
+#include <RAT/UFOParams.hh>
+#include <RAT/SourceConnectorParams.hh>
+#include <RAT/CalibSourceHoleRing.hh>
+
+#include <RAT/DB.hh>
+#include <RAT/Log.hh>
+#include <RAT/Materials.hh>
+
+#include <G4Material.hh>
+#include <G4NistManager.hh>
+#include <G4Box.hh>
+#include <G4Tubs.hh>
+#include <G4MultiUnion.hh>
+#include <G4BooleanSolid.hh>
+#include <G4DisplacedSolid.hh>
+#include <G4VSolid.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4PVPlacement.hh>
+#include <G4RandomDirection.hh>
+#include <Randomize.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+#include <G4Transform3D.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace RAT;
+
+namespace
+{
+  // Distinct points and rays per call type; the calls cycle through them
+  const size_t kMaxSamples = 100000;
+
+  struct SolidTiming
+  {
+    std::string name;
+    std::string type;
+    // Fraction of the bounding box points inside the solid
+    double insideFraction;
+    // ns per call, or negative if the solid gave no points to call it with
+    double inside;
+    double distanceToIn;
+    double distanceToOut;
+    double surfaceNormal;
+  };
+
+  // Keeps the compiler from dropping the calls being timed
+  volatile double gSink = 0.;
+
+  template<class Call>
+  double TimeCalls(const size_t calls, const size_t samples, Call call)
+  {
+    if(samples == 0)
+      return -1.;
+    double sum = 0.;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(size_t i=0, j=0; i<calls; i++, j = j+1 < samples ? j+1 : 0)
+      sum += call(j);
+    const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    gSink += sum;
+    return std::chrono::duration<double,std::nano>(stop-start).count()/calls;
+  }
+
+  SolidTiming TimeSolid(const G4VSolid *solid, const size_t calls)
+  {
+    SolidTiming timing;
+    timing.name = solid->GetName();
+    timing.type = solid->GetEntityType();
+
+    // A little beyond the bounding box, so that rays from outside can miss
+    G4ThreeVector low, high;
+    solid->BoundingLimits(low,high);
+    const G4ThreeVector margin = 0.1*(high-low);
+    low -= margin;
+    high += margin;
+
+    const size_t nSamples = std::min(calls,kMaxSamples);
+    std::vector<G4ThreeVector> points(nSamples), outside, inside, insideDirections, surface;
+    for(size_t i=0; i<nSamples; i++){
+      points[i] = G4ThreeVector(low.x()+(high.x()-low.x())*G4UniformRand(),
+                                low.y()+(high.y()-low.y())*G4UniformRand(),
+                                low.z()+(high.z()-low.z())*G4UniformRand());
+      const EInside where = solid->Inside(points[i]);
+      if(where == kOutside)
+        outside.push_back(points[i]);
+      else if(where == kInside)
+        inside.push_back(points[i]);
+    }
+    std::vector<G4ThreeVector> outsideDirections(outside.size());
+    for(size_t i=0; i<outside.size(); i++)
+      outsideDirections[i] = G4RandomDirection();
+    insideDirections.resize(inside.size());
+    for(size_t i=0; i<inside.size(); i++){
+      insideDirections[i] = G4RandomDirection();
+      surface.push_back(inside[i]+solid->DistanceToOut(inside[i],insideDirections[i])*insideDirections[i]);
+    }
+    timing.insideFraction = static_cast<double>(inside.size())/nSamples;
+
+    timing.inside = TimeCalls(calls,points.size(),
+                              [&](const size_t i) { return static_cast<double>(solid->Inside(points[i])); });
+    timing.distanceToIn = TimeCalls(calls,outside.size(),
+                                    [&](const size_t i) { return solid->DistanceToIn(outside[i],outsideDirections[i]); });
+    timing.distanceToOut = TimeCalls(calls,inside.size(),
+                                     [&](const size_t i) { return solid->DistanceToOut(inside[i],insideDirections[i]); });
+    timing.surfaceNormal = TimeCalls(calls,surface.size(),
+                                     [&](const size_t i) { return solid->SurfaceNormal(surface[i]).z(); });
+    return timing;
+  }
+
+  // Points compared per hole ring, half of them around a single hole
+  const size_t kRingSamples = 20000;
+  // Largest difference in a distance, and in the components of a unit
+  // normal, still taken as agreement
+  const double kRingTolerance = 1e-6*CLHEP::mm;
+  const double kNormalTolerance = 1e-6;
+  // Disagreements printed per ring; the rest are only counted
+  const size_t kMaxReported = 10;
+
+  struct RingCheck
+  {
+    std::string name;
+    size_t comparisons;
+    size_t mismatches;
+  };
+
+  // The hole rings a solid is built from, through its Boolean and displaced parts
+  void CollectHoleRings(const G4VSolid *solid, std::vector<const CalibSourceHoleRing*> &rings)
+  {
+    if(const CalibSourceHoleRing* ring = dynamic_cast<const CalibSourceHoleRing*>(solid)){
+      if(std::find(rings.begin(),rings.end(),ring) == rings.end())
+        rings.push_back(ring);
+    }
+    else if(const G4DisplacedSolid* displaced = dynamic_cast<const G4DisplacedSolid*>(solid))
+      CollectHoleRings(displaced->GetConstituentMovedSolid(),rings);
+    else if(const G4BooleanSolid* boolean = dynamic_cast<const G4BooleanSolid*>(solid)){
+      CollectHoleRings(boolean->GetConstituentSolid(0),rings);
+      CollectHoleRings(boolean->GetConstituentSolid(1),rings);
+    }
+    else if(const G4MultiUnion* multiUnion = dynamic_cast<const G4MultiUnion*>(solid))
+      for(int i=0; i<multiUnion->GetNumberOfSolids(); i++)
+        CollectHoleRings(multiUnion->GetSolid(i),rings);
+  }
+
+  bool SameDistance(const double distance, const double expected)
+  {
+    if(expected >= kInfinity || distance >= kInfinity)
+      return expected >= kInfinity && distance >= kInfinity;
+    return std::fabs(distance-expected) <= kRingTolerance;
+  }
+
+  bool SameNormal(const G4ThreeVector &normal, const G4ThreeVector &expected)
+  {
+    return (normal-expected).mag() <= kNormalTolerance;
+  }
+
+  RingCheck CheckHoleRing(const CalibSourceHoleRing *ring)
+  {
+    RingCheck check;
+    check.name = ring->GetName();
+    check.comparisons = 0;
+    check.mismatches = 0;
+
+    // The holes do not touch, so the union needs no care where they meet.
+    // A single hole is the tube alone, moved into place.
+    const double radius = ring->GetHoleRadius();
+    const double halfLength = ring->GetZHalfLength();
+    G4Tubs hole(check.name + "_reference_hole",0.,radius,halfLength,0.,CLHEP::twopi);
+    G4MultiUnion multiUnion(check.name + "_reference");
+    for(int i=0; i<ring->GetNHoles(); i++)
+      multiUnion.AddNode(hole,G4Translate3D(ring->GetHolePosition(i)));
+    multiUnion.Voxelize();
+    G4DisplacedSolid single(check.name + "_reference_single",&hole,G4Translate3D(ring->GetHolePosition(0)));
+    const G4VSolid &reference = ring->GetNHoles() == 1 ? static_cast<const G4VSolid&>(single) : multiUnion;
+
+    // Exact distance to the nearest hole from outside, or to the surface
+    // of the hole from inside, which the safeties may not exceed
+    auto exactSafety = [&](const G4ThreeVector &p) {
+      double safety = kInfinity;
+      for(int i=0; i<ring->GetNHoles(); i++){
+        const G4ThreeVector local = p-ring->GetHolePosition(i);
+        const double dRho = local.perp()-radius;
+        const double dZ = std::fabs(local.z())-halfLength;
+        if(dRho <= 0. && dZ <= 0.)
+          return std::min(-dRho,-dZ);
+        safety = std::min(safety,std::sqrt(std::pow(std::max(dRho,0.),2)+std::pow(std::max(dZ,0.),2)));
+      }
+      return safety;
+    };
+    auto compare = [&](const bool agree, const std::string &call, const G4ThreeVector &p,
+                       const G4ThreeVector &v, const std::string &detail) {
+      check.comparisons++;
+      if(agree)
+        return;
+      if(check.mismatches++ >= kMaxReported)
+        return;
+      std::ostringstream where;
+      where << p;
+      if(v.mag2() > 0.)
+        where << " along " << v;
+      warn << "calib_source_bench: " << check.name << " " << call << " at " << where.str()
+           << ": " << detail << newline;
+    };
+    auto describe = [](const double value, const double expected) {
+      std::ostringstream out;
+      out << value << " where the union of tubes gives " << expected;
+      return out.str();
+    };
+    auto describeNormal = [](const G4ThreeVector &normal, const G4ThreeVector &expected) {
+      std::ostringstream out;
+      out << normal << " where the union of tubes gives " << expected;
+      return out.str();
+    };
+    const G4ThreeVector none;
+
+    G4ThreeVector low, high;
+    ring->BoundingLimits(low,high);
+    const G4ThreeVector margin = 0.1*(high-low);
+    low -= margin;
+    high += margin;
+    const G4ThreeVector holeSize(1.2*radius,1.2*radius,1.2*halfLength);
+    for(size_t i=0; i<kRingSamples; i++){
+      G4ThreeVector p;
+      if(i % 2 == 0)
+        p = G4ThreeVector(low.x()+(high.x()-low.x())*G4UniformRand(),
+                          low.y()+(high.y()-low.y())*G4UniformRand(),
+                          low.z()+(high.z()-low.z())*G4UniformRand());
+      else {
+        const int n = std::min(static_cast<int>(ring->GetNHoles()*G4UniformRand()),ring->GetNHoles()-1);
+        p = ring->GetHolePosition(n)+G4ThreeVector(holeSize.x()*(2.*G4UniformRand()-1.),
+                                                   holeSize.y()*(2.*G4UniformRand()-1.),
+                                                   holeSize.z()*(2.*G4UniformRand()-1.));
+      }
+      const G4ThreeVector v = G4RandomDirection();
+      const EInside where = ring->Inside(p);
+      const EInside expectedWhere = reference.Inside(p);
+      compare(where == expectedWhere,"Inside",p,none,describe(where,expectedWhere));
+      if(expectedWhere == kOutside){
+        const double distance = ring->DistanceToIn(p,v);
+        const double expected = reference.DistanceToIn(p,v);
+        compare(SameDistance(distance,expected),"DistanceToIn",p,v,describe(distance,expected));
+        const double safety = ring->DistanceToIn(p);
+        compare(safety >= 0. && safety <= exactSafety(p)+kRingTolerance,"DistanceToIn",p,none,
+                describe(safety,exactSafety(p)) + " exactly");
+      }
+      else if(expectedWhere == kInside){
+        bool validNormal = false;
+        G4ThreeVector normal;
+        const double distance = ring->DistanceToOut(p,v,true,&validNormal,&normal);
+        bool expectedValidNormal = false;
+        G4ThreeVector expectedExitNormal;
+        const double expected = reference.DistanceToOut(p,v,true,&expectedValidNormal,&expectedExitNormal);
+        compare(SameDistance(distance,expected),"DistanceToOut",p,v,describe(distance,expected));
+        // Whether the whole solid lies behind the exit surface
+        compare(validNormal == expectedValidNormal,"DistanceToOut validNorm",p,v,
+                describe(validNormal,expectedValidNormal));
+        const G4ThreeVector expectedNormal = reference.SurfaceNormal(p+expected*v);
+        compare(SameNormal(normal,expectedNormal),"DistanceToOut normal",p,v,
+                describeNormal(normal,expectedNormal));
+        const double safety = ring->DistanceToOut(p);
+        compare(safety >= 0. && safety <= exactSafety(p)+kRingTolerance,"DistanceToOut",p,none,
+                describe(safety,exactSafety(p)) + " exactly");
+      }
+
+      // On the surface, rays leave through it or cross the hole
+      const G4ThreeVector s = ring->GetPointOnSurface();
+      const EInside surfaceWhere = reference.Inside(s);
+      compare(ring->Inside(s) == kSurface && surfaceWhere == kSurface,"Inside",s,none,
+              describe(ring->Inside(s),surfaceWhere));
+      const G4ThreeVector normal = ring->SurfaceNormal(s);
+      const G4ThreeVector expectedNormal = reference.SurfaceNormal(s);
+      compare(SameNormal(normal,expectedNormal),"SurfaceNormal",s,none,describeNormal(normal,expectedNormal));
+      if(v.dot(expectedNormal) > 0.1){
+        const double distance = ring->DistanceToIn(s,v);
+        const double expected = reference.DistanceToIn(s,v);
+        compare(SameDistance(distance,expected),"DistanceToIn",s,v,describe(distance,expected));
+      }
+      else if(v.dot(expectedNormal) < -0.1){
+        const double distance = ring->DistanceToOut(s,v);
+        const double expected = reference.DistanceToOut(s,v);
+        compare(SameDistance(distance,expected),"DistanceToOut",s,v,describe(distance,expected));
+      }
+    }
+    return check;
+  }
+
+  // A call that could not be made is written as null
+  std::string JSONValue(const double value)
+  {
+    if(value < 0.)
+      return "null";
+    std::ostringstream out;
+    out << value;
+    return out.str();
+  }
+
+  void WriteJSON(std::ostream &out, const std::string &geoFile, const std::string &index,
+                 const std::string &factory, const std::string &geometryHash, const size_t calls,
+                 const std::vector<RingCheck> &ringChecks, const std::vector<SolidTiming> &timings)
+  {
+    out << "{\n"
+        << "  \"geo_file\": \"" << geoFile << "\",\n"
+        << "  \"index\": \"" << index << "\",\n"
+        << "  \"factory\": \"" << factory << "\",\n"
+        << "  \"geometry_hash\": \"" << geometryHash << "\",\n"
+        << "  \"calls\": " << calls << ",\n"
+        << "  \"hole_rings\": [\n";
+    for(size_t i=0; i<ringChecks.size(); i++)
+      out << "    {\"name\": \"" << ringChecks[i].name << "\", "
+          << "\"comparisons\": " << ringChecks[i].comparisons << ", "
+          << "\"mismatches\": " << ringChecks[i].mismatches << "}"
+          << (i+1 < ringChecks.size() ? ",\n" : "\n");
+    out << "  ],\n"
+        << "  \"unit\": \"ns/call\",\n"
+        << "  \"solids\": [\n";
+    for(size_t i=0; i<timings.size(); i++)
+      out << "    {\"name\": \"" << timings[i].name << "\", \"type\": \"" << timings[i].type << "\", "
+          << "\"inside_fraction\": " << timings[i].insideFraction << ", "
+          << "\"Inside\": " << JSONValue(timings[i].inside) << ", "
+          << "\"DistanceToIn\": " << JSONValue(timings[i].distanceToIn) << ", "
+          << "\"DistanceToOut\": " << JSONValue(timings[i].distanceToOut) << ", "
+          << "\"SurfaceNormal\": " << JSONValue(timings[i].surfaceNormal) << "}"
+          << (i+1 < timings.size() ? ",\n" : "\n");
+    out << "  ]\n"
+        << "}\n";
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 3 || argc > 6){
+    std::cerr << "Usage: " << argv[0] << " <geo file> <index> [calls] [output .json] [world material]"
+              << std::endl;
+    return 1;
+  }
+  const std::string geoFile = argv[1];
+  const std::string index = argv[2];
+  const long calls = argc > 3 ? atol(argv[3]) : 1000000;
+  const std::string outputFile = argc > 4 ? argv[4] : "";
+  const std::string worldMaterialName = argc > 5 ? argv[5] : "G4_WATER";
+  if(calls <= 0){
+    std::cerr << argv[0] << ": the number of calls must be positive" << std::endl;
+    return 1;
+  }
+
+  DB* db = DB::Get();
+  db->LoadDefaults();
+  db->Load(geoFile);
+  Materials::LoadMaterials();
+
+  // Only the geometry is wanted: no fast model or early abort, which need
+  // a run
+  db->SetS("GEO",index,"mother","world");
+  db->SetI("GEO",index,"fast_simulation",0);
+  db->SetI("GEO",index,"early_abort",0);
+  DBLinkPtr table = db->GetLink("GEO",index);
+
+  G4Material* worldMaterial = G4Material::GetMaterial(worldMaterialName,false);
+  if(worldMaterial == NULL)
+    worldMaterial = G4NistManager::Instance()->FindOrBuildMaterial(worldMaterialName);
+  Log::Assert(worldMaterial != NULL,"calib_source_bench: No material " + worldMaterialName + ".");
+  G4LogicalVolume* worldLog = new G4LogicalVolume(new G4Box("world_solid",CLHEP::m,CLHEP::m,CLHEP::m),
+                                                  worldMaterial,"world");
+  new G4PVPlacement(0,G4ThreeVector(),worldLog,"world",0,false,0);
+
+  std::string factory, geometryHash;
+  try {
+    factory = table->GetS("factory");
+  }
+  catch(DBNotFoundError &e) {
+    Log::Die("calib_source_bench: DBNotFoundError. Table " + e.table + ", index " + e.index + ", field " + e.field + ".");
+  };
+  if(factory == "TaggedSource"){
+    GeoTaggedSourceFactory().Construct(table,false);
+    TaggedSourceParams params;
+    params.Load(table,"calib_source_bench");
+    geometryHash = params.GetHash();
+  }
+  else if(factory == "UFO"){
+    GeoUFOFactory().Construct(table,false);
+    UFOParams params;
+    params.Load(table,"calib_source_bench");
+    geometryHash = params.GetHash();
+  }
+  else if(factory == "SourceConnector"){
+    GeoSourceConnectorFactory().Construct(table,false);
+    SourceConnectorParams params;
+    params.Load(table,"calib_source_bench");
+    geometryHash = params.GetHash();
+  }
+  else
+    Log::Die("calib_source_bench: No calibration source factory " + factory + ".");
+
+  // Each solid once, in the order its first volume was made
+  const std::string prefix = index + "_";
+  std::vector<const G4VSolid*> solids;
+  G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+  for(size_t i=0; i<store->size(); i++){
+    const G4LogicalVolume* volume = (*store)[i];
+    if(volume->GetName().compare(0,prefix.size(),prefix) == 0
+       && std::find(solids.begin(),solids.end(),volume->GetSolid()) == solids.end())
+      solids.push_back(volume->GetSolid());
+  }
+
+  // The rings of the source, then ones of shapes it may not have: a single
+  // hole, and rings of few and many holes at odd angles
+  std::vector<const CalibSourceHoleRing*> rings;
+  for(size_t i=0; i<solids.size(); i++)
+    CollectHoleRings(solids[i],rings);
+  CalibSourceHoleRing single("calib_source_bench_ring_1",1,2.*CLHEP::mm,5.*CLHEP::mm,10.*CLHEP::mm,0.);
+  CalibSourceHoleRing pair("calib_source_bench_ring_2",2,1.*CLHEP::mm,3.*CLHEP::mm,4.*CLHEP::mm,0.3);
+  CalibSourceHoleRing triple("calib_source_bench_ring_3",3,5.*CLHEP::mm,10.*CLHEP::mm,12.*CLHEP::mm,-1.);
+  CalibSourceHoleRing six("calib_source_bench_ring_6",6,2.*CLHEP::mm,2.*CLHEP::mm,8.*CLHEP::mm,0.5);
+  CalibSourceHoleRing twelve("calib_source_bench_ring_12",12,1.*CLHEP::mm,1.*CLHEP::mm,10.*CLHEP::mm,2.);
+  rings.push_back(&single);
+  rings.push_back(&pair);
+  rings.push_back(&triple);
+  rings.push_back(&six);
+  rings.push_back(&twelve);
+  std::vector<RingCheck> ringChecks;
+  size_t mismatches = 0;
+  for(size_t i=0; i<rings.size(); i++){
+    ringChecks.push_back(CheckHoleRing(rings[i]));
+    mismatches += ringChecks.back().mismatches;
+    info << "calib_source_bench: Checked " << ringChecks.back().name << ", "
+         << ringChecks.back().mismatches << " of " << ringChecks.back().comparisons
+         << " calls disagree with the union of tubes" << newline;
+  }
+
+  std::vector<SolidTiming> timings;
+  for(size_t i=0; i<solids.size(); i++){
+    timings.push_back(TimeSolid(solids[i],calls));
+    info << "calib_source_bench: Timed " << timings.back().name << newline;
+  }
+
+  if(outputFile.empty())
+    WriteJSON(std::cout,geoFile,index,factory,geometryHash,calls,ringChecks,timings);
+  else {
+    std::ofstream out(outputFile.c_str());
+    Log::Assert(out.good(),"calib_source_bench: Cannot write " + outputFile + ".");
+    WriteJSON(out,geoFile,index,factory,geometryHash,calls,ringChecks,timings);
+  }
+  if(mismatches > 0){
+    warn << "calib_source_bench: " << mismatches << " hole ring calls disagree with the union of tubes" << newline;
+    return 1;
+  }
+  return 0;
+}
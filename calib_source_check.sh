@@ -0,0 +1,54 @@
+#!/bin/sh
+########################################################################
+# calib_source_check.sh
+#
+# Runs the unattended checks of the calibration sources and fails if any
+# of them does:
+#
+#     calib_source_check.sh [events] [threads]
+#
+# calib_source_fidelity compares the reduced detail level of each source
+# with the full one (TaggedSource with Co60 and Sc46, UFO with its LED
+# photons), with events (default 10000) each; envelope-only has no tag and
+# is not meant to pass. calib_source_bench checks the hole rings of every
+# source against the unions of tubes they replace. The tools are taken
+# from the PATH, or from CALIB_SOURCE_BIN if set, and run in the directory
+# holding this script, where the .geo files are. Each tool's output goes
+# to <tool>_<index>[_<primaries>].log; the exit status is the number of
+# failed checks (0 if all pass).
+#
+########################################################################
+
+events=${1:-10000}
+threads=${2:-}
+bin=${CALIB_SOURCE_BIN:+$CALIB_SOURCE_BIN/}
+
+cd "$(dirname "$0")" || exit 1
+
+failed=0
+
+# check <log> <command...>: runs the command, keeping its output in the log
+check() {
+  log=$1
+  shift
+  if "$@" > "$log" 2>&1; then
+    echo "passed: $*"
+  else
+    echo "FAILED: $* (see $log)"
+    failed=$((failed+1))
+  fi
+}
+
+for primaries in Co60 Sc46; do
+  check "calib_source_fidelity_TaggedSource_${primaries}.log" \
+    "${bin}calib_source_fidelity" TaggedSource.geo TaggedSource "$primaries" "$events" full reduced $threads
+done
+check "calib_source_fidelity_UFO_LED.log" \
+  "${bin}calib_source_fidelity" UFO.geo UFO LED "$events" full reduced $threads
+
+for source in TaggedSource UFO SourceConnector; do
+  check "calib_source_bench_${source}.log" \
+    "${bin}calib_source_bench" "$source.geo" "$source" 100000 "calib_source_bench_${source}.json"
+done
+
+exit $failed
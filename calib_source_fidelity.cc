@@ -0,0 +1,370 @@
+////////////////////////////////////////////////////////////////////////
+// calib_source_fidelity
+//
+// Checks that a calibration source built at one detail level behaves
+// like the same source built at another (see detail_level in the GEO
+// tables):
+//
+//     calib_source_fidelity <geo file> <index> Co60|Sc46|LED <events>
+//                           <reference level> <test level> [threads]
+//                           [seed] [significance] [world material]
+//
+// The source is the GEO table with the given index in the geo file, alone
+// in a world as for calib_source_response: TaggedSource with the decays of
+// Co60 or Sc46, or UFO with its LED photons. The two configurations run at
+// the same time, in two processes sharing the threads (default: one per
+// core), with the same seed (default 12345), so each sees the same
+// primaries event by event. Their events are kept in
+// <index>_reference.fidelity and <index>_test.fidelity.
+//
+// The report compares the tag rate (McNemar's test, as the events are
+// paired), the number of escaping particles of each kind (Poisson) and
+// their energy and time spectra (Kolmogorov-Smirnov), and gives the CPU
+// time per event of each configuration and their ratio. The exit status is
+// 0 if no test fails at the significance (default 0.01, Bonferroni
+// corrected for the number of tests), so the check can run unattended;
+// calib_source_check.sh runs it on each source and fails with it.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceFidelityActions.hh>
+#include <RAT/CalibSourceResponseActions.hh>
+#include <RAT/TaggedSourceParams.hh>
+
+#include <RAT/DB.hh>
+#include <RAT/Log.hh>
+#include <RAT/Materials.hh>
+
+#include <G4MTRunManager.hh>
+#include <G4PhysListFactory.hh>
+#include <G4VModularPhysicsList.hh>
+#include <G4OpticalPhysics.hh>
+#include <G4Threading.hh>
+#include <Randomize.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace RAT;
+
+namespace
+{
+  // One configuration of the source
+  struct Configuration
+  {
+    std::string geoFile;
+    std::string index;
+    std::string primaries;
+    int nEvents;
+    std::string detailLevel;
+    std::string outputFile;
+    int nThreads;
+    long seed;
+    std::string worldMaterial;
+  };
+
+  // A quantity compared between the configurations, and the probability
+  // of a difference at least as large if they behave the same (negative
+  // if it is not tested)
+  struct Comparison
+  {
+    std::string quantity;
+    double reference;
+    double test;
+    double pValue;
+  };
+
+  // Run one configuration and write its events; the exit status of the
+  // process that runs it
+  int RunConfiguration(const Configuration &configuration)
+  {
+    DB* db = DB::Get();
+    db->LoadDefaults();
+    db->Load(configuration.geoFile);
+    Materials::LoadMaterials();
+    db->SetS("GEO",configuration.index,"detail_level",configuration.detailLevel);
+
+    // The lines of the tagged sources' isotopes; the UFO's LEDs are blue
+    CalibSourceFidelitySettings settings;
+    settings.source.index = configuration.index;
+    settings.source.photonEnergy = 3.06*CLHEP::eV; // 405 nm
+    settings.detailLevel = configuration.detailLevel;
+    settings.outputFile = configuration.outputFile;
+    settings.betaEndPoint = 0.;
+    settings.tagThreshold = 0.;
+    if(configuration.primaries == "Co60"){
+      settings.betaEndPoint = 0.3179*CLHEP::MeV;
+      settings.gammaLines.push_back(1.1732*CLHEP::MeV);
+      settings.gammaLines.push_back(1.3325*CLHEP::MeV);
+    }
+    else if(configuration.primaries == "Sc46"){
+      settings.betaEndPoint = 0.3569*CLHEP::MeV;
+      settings.gammaLines.push_back(0.8893*CLHEP::MeV);
+      settings.gammaLines.push_back(1.1205*CLHEP::MeV);
+    }
+    settings.source.mode = configuration.primaries == "LED" ? CalibSourceResponseSettings::kOptical :
+      CalibSourceResponseSettings::kTagged;
+
+    CLHEP::HepRandom::setTheSeed(configuration.seed);
+    G4MTRunManager* runManager = new G4MTRunManager();
+    runManager->SetNumberOfThreads(configuration.nThreads);
+    runManager->SetUserInitialization(new CalibSourceResponseDetector(settings.source,configuration.worldMaterial));
+    G4PhysListFactory physListFactory;
+    G4VModularPhysicsList* physics = physListFactory.GetReferencePhysList("QBBC");
+    if(settings.source.mode == CalibSourceResponseSettings::kOptical)
+      physics->RegisterPhysics(new G4OpticalPhysics());
+    runManager->SetUserInitialization(physics);
+    runManager->SetUserInitialization(new CalibSourceFidelityActionInitialization(settings));
+    runManager->Initialize();
+
+    // The source's own threshold decides what is tagged
+    if(settings.source.mode == CalibSourceResponseSettings::kTagged){
+      TaggedSourceParams params;
+      params.Load(db->GetLink("GEO",configuration.index),"calib_source_fidelity");
+      settings.tagThreshold = params.pmtEnergyThreshold;
+    }
+    runManager->BeamOn(configuration.nEvents);
+
+    delete runManager;
+    return 0;
+  }
+
+  // Probability that the Kolmogorov-Smirnov statistic exceeds lambda
+  double KolmogorovProbability(const double lambda)
+  {
+    double sum = 0., sign = 1., previous = 0.;
+    for(int j=1; j<=100; j++){
+      const double term = 2.*sign*std::exp(-2.*j*j*lambda*lambda);
+      sum += term;
+      if(std::fabs(term) <= 1e-3*previous || std::fabs(term) <= 1e-8*sum)
+        return std::min(1.,std::max(0.,sum));
+      sign = -sign;
+      previous = std::fabs(term);
+    }
+    // Not converging only happens for tiny lambda
+    return 1.;
+  }
+
+  // Two sample Kolmogorov-Smirnov test; negative if either sample is empty
+  double KolmogorovSmirnovTest(std::vector<double> a, std::vector<double> b)
+  {
+    if(a.empty() || b.empty())
+      return -1.;
+    std::sort(a.begin(),a.end());
+    std::sort(b.begin(),b.end());
+    double distance = 0.;
+    size_t i = 0, j = 0;
+    while(i < a.size() && j < b.size()){
+      const double value = std::min(a[i],b[j]);
+      while(i < a.size() && a[i] == value)
+        i++;
+      while(j < b.size() && b[j] == value)
+        j++;
+      distance = std::max(distance,std::fabs(double(i)/a.size()-double(j)/b.size()));
+    }
+    const double effective = std::sqrt(double(a.size())*b.size()/(a.size()+b.size()));
+    return KolmogorovProbability((effective+0.12+0.11/effective)*distance);
+  }
+
+  // Whether two Poisson counts agree
+  double PoissonTest(const double a, const double b)
+  {
+    if(a+b <= 0.)
+      return 1.;
+    return std::erfc(std::fabs(a-b)/std::sqrt(a+b)/std::sqrt(2.));
+  }
+
+  // McNemar's test of paired yes/no outcomes, from the pairs that differ
+  double McNemarTest(const double onlyA, const double onlyB)
+  {
+    if(onlyA+onlyB <= 0.)
+      return 1.;
+    const double difference = std::max(0.,std::fabs(onlyA-onlyB)-1.);
+    return std::erfc(std::sqrt(difference*difference/(onlyA+onlyB)/2.));
+  }
+
+  double Mean(const std::vector<double> &values)
+  {
+    double sum = 0.;
+    for(size_t i=0; i<values.size(); i++)
+      sum += values[i];
+    return values.empty() ? 0. : sum/values.size();
+  }
+
+  std::vector<Comparison> Compare(const CalibSourceFidelitySample &reference,
+                                  const CalibSourceFidelitySample &test,
+                                  const bool tagged)
+  {
+    std::vector<Comparison> comparisons;
+    const size_t nEvents = reference.events.size();
+
+    if(tagged){
+      double nReference = 0., nTest = 0., onlyReference = 0., onlyTest = 0.;
+      for(size_t i=0; i<nEvents; i++){
+        const bool referenceTag = reference.events[i].tagEnergy > reference.tagThreshold;
+        const bool testTag = test.events[i].tagEnergy > test.tagThreshold;
+        nReference += referenceTag;
+        nTest += testTag;
+        onlyReference += referenceTag && !testTag;
+        onlyTest += testTag && !referenceTag;
+      }
+      Comparison comparison = { "tag rate", nReference/nEvents, nTest/nEvents,
+                                McNemarTest(onlyReference,onlyTest) };
+      comparisons.push_back(comparison);
+    }
+
+    for(int kind=0; kind<CalibSourceFidelityParticle::kNKinds; kind++){
+      std::vector<double> energies[2], times[2];
+      const CalibSourceFidelitySample* samples[2] = { &reference, &test };
+      for(int s=0; s<2; s++)
+        for(size_t i=0; i<nEvents; i++)
+          for(size_t j=0; j<samples[s]->events[i].escaped.size(); j++)
+            if(samples[s]->events[i].escaped[j].kind == kind){
+              energies[s].push_back(samples[s]->events[i].escaped[j].energy);
+              times[s].push_back(samples[s]->events[i].escaped[j].time);
+            }
+      if(energies[0].empty() && energies[1].empty())
+        continue;
+      const std::string name = CalibSourceFidelityParticle::GetKindName(kind);
+      Comparison escaped = { name + " escaping per event", double(energies[0].size())/nEvents,
+                             double(energies[1].size())/nEvents,
+                             PoissonTest(energies[0].size(),energies[1].size()) };
+      Comparison energy = { name + " mean energy (MeV)", Mean(energies[0])/CLHEP::MeV,
+                            Mean(energies[1])/CLHEP::MeV, KolmogorovSmirnovTest(energies[0],energies[1]) };
+      Comparison time = { name + " mean time (ns)", Mean(times[0])/CLHEP::ns, Mean(times[1])/CLHEP::ns,
+                          KolmogorovSmirnovTest(times[0],times[1]) };
+      comparisons.push_back(escaped);
+      comparisons.push_back(energy);
+      comparisons.push_back(time);
+    }
+
+    // Only reported: the point of a simpler geometry is to differ here
+    double cpu[2] = { 0., 0. };
+    for(size_t i=0; i<nEvents; i++){
+      cpu[0] += reference.events[i].cpuTime;
+      cpu[1] += test.events[i].cpuTime;
+    }
+    Comparison cpuTime = { "cpu per event (ms)", 1e3*cpu[0]/nEvents, 1e3*cpu[1]/nEvents, -1. };
+    comparisons.push_back(cpuTime);
+    return comparisons;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 7 || argc > 11){
+    std::cerr << "Usage: " << argv[0] << " <geo file> <index> Co60|Sc46|LED <events> <reference level>"
+              << " <test level> [threads] [seed] [significance] [world material]" << std::endl;
+    return 1;
+  }
+  Configuration configurations[2];
+  Configuration &reference = configurations[0];
+  reference.geoFile = argv[1];
+  reference.index = argv[2];
+  reference.primaries = argv[3];
+  reference.nEvents = atoi(argv[4]);
+  reference.detailLevel = argv[5];
+  const int nThreads = argc > 7 ? atoi(argv[7]) : G4Threading::G4GetNumberOfCores();
+  reference.nThreads = std::max(1,nThreads/2);
+  reference.seed = argc > 8 ? atol(argv[8]) : 12345;
+  const double significance = argc > 9 ? atof(argv[9]) : 0.01;
+  reference.worldMaterial = argc > 10 ? argv[10] : "G4_WATER";
+  reference.outputFile = reference.index + "_reference.fidelity";
+  configurations[1] = reference;
+  configurations[1].detailLevel = argv[6];
+  configurations[1].outputFile = reference.index + "_test.fidelity";
+
+  const std::string levels[3] = { "full", "reduced", "envelope-only" };
+  const bool knownLevels = std::find(levels,levels+3,configurations[0].detailLevel) != levels+3 &&
+    std::find(levels,levels+3,configurations[1].detailLevel) != levels+3;
+  if((reference.primaries != "Co60" && reference.primaries != "Sc46" && reference.primaries != "LED") ||
+     !knownLevels || reference.nEvents <= 0 || nThreads <= 0 || significance <= 0. || significance >= 1.){
+    std::cerr << argv[0] << ": the primaries must be Co60, Sc46 or LED, the levels full, reduced or envelope-only,"
+              << " with a positive number of events and threads and a significance between 0 and 1" << std::endl;
+    return 1;
+  }
+
+  // Nothing has been set up yet, so each configuration starts afresh in
+  // its own process
+  pid_t children[2];
+  for(int i=0; i<2; i++){
+    children[i] = fork();
+    if(children[i] < 0){
+      std::cerr << argv[0] << ": cannot start the " << (i == 0 ? "reference" : "test") << " run" << std::endl;
+      return 1;
+    }
+    if(children[i] == 0){
+      const int status = RunConfiguration(configurations[i]);
+      std::cout.flush();
+      std::cerr.flush();
+      _exit(status);
+    }
+  }
+  bool finished = true;
+  for(int i=0; i<2; i++){
+    int status = 0;
+    waitpid(children[i],&status,0);
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+      std::cerr << argv[0] << ": the " << (i == 0 ? "reference" : "test") << " run at "
+                << configurations[i].detailLevel << " detail failed" << std::endl;
+      finished = false;
+    }
+  }
+  if(!finished)
+    return 1;
+
+  CalibSourceFidelitySample samples[2];
+  for(int i=0; i<2; i++)
+    Log::Assert(CalibSourceFidelityRun::Read(configurations[i].outputFile,samples[i]),
+                "calib_source_fidelity: Cannot read " + configurations[i].outputFile + ".");
+  Log::Assert(samples[0].events.size() == samples[1].events.size(),
+              "calib_source_fidelity: The runs do not have the same number of events.");
+  for(size_t i=0; i<samples[0].events.size(); i++)
+    Log::Assert(samples[0].events[i].id == samples[1].events[i].id,
+                "calib_source_fidelity: The runs do not have the same events.");
+
+  const std::vector<Comparison> comparisons = Compare(samples[0],samples[1],reference.primaries != "LED");
+  int nTests = 0;
+  for(size_t i=0; i<comparisons.size(); i++)
+    nTests += comparisons[i].pValue >= 0.;
+  const double threshold = significance/std::max(1,nTests);
+
+  std::ostringstream report;
+  report << "calib_source_fidelity: " << reference.index << " with " << reference.primaries << ", "
+         << configurations[0].detailLevel << " (reference) against " << configurations[1].detailLevel
+         << " (test), " << samples[0].events.size() << " events, seed " << reference.seed << "\n"
+         << std::setw(36) << std::left << "  quantity" << std::right << std::setw(14) << "reference"
+         << std::setw(14) << "test" << std::setw(12) << "p-value" << "\n";
+  bool passed = true;
+  for(size_t i=0; i<comparisons.size(); i++){
+    const Comparison &comparison = comparisons[i];
+    report << std::setw(36) << std::left << "  " + comparison.quantity << std::right
+           << std::setw(14) << std::setprecision(6) << comparison.reference
+           << std::setw(14) << comparison.test;
+    if(comparison.pValue < 0.)
+      report << std::setw(12) << "-";
+    else
+      report << std::setw(12) << std::setprecision(3) << comparison.pValue
+             << (comparison.pValue < threshold ? "  differs" : "");
+    report << "\n";
+    passed = passed && (comparison.pValue < 0. || comparison.pValue >= threshold);
+  }
+  const double cpuRatio = comparisons.back().reference > 0. ? comparisons.back().test/comparisons.back().reference : 0.;
+  report << std::setw(36) << std::left << "  cpu ratio (test/reference)" << std::right
+         << std::setw(28) << std::setprecision(4) << cpuRatio << "\n"
+         << (passed ? "PASSED" : "FAILED") << ": " << nTests << " tests at a significance of "
+         << significance << " (" << threshold << " each)\n";
+  std::cout << report.str();
+  return passed ? 0 : 1;
+}
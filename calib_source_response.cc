@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////
+// calib_source_response
+//
+// Makes the response table of a calibration source by tracking particles
+// through the full source geometry, with no detector around it:
+//
+//     calib_source_response <geo file> <index> tagged|optical <events>
+//                           <output .ratdb> [threads] [world material]
+//
+// The source is the GEO table with the given index in the geo file (e.g.
+// TaggedSource in TaggedSource.geo, tagged; or UFO in UFO.geo, optical).
+// Events are spread over threads (default: one per core). The table is
+// written to the output file, ready for /rat/db/load, and records the hash
+// of the source parameters so that a table made for an older geometry is
+// refused (see CalibSourceResponse). A tagged table is read back as the
+// source placed in its mother would read it, and the tool stops if the
+// source would refuse it.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <RAT/CalibSourceResponseActions.hh>
+#include <RAT/CalibSourceResponse.hh>
+#include <RAT/TaggedSourceParams.hh>
+
+#include <RAT/DB.hh>
+#include <RAT/Log.hh>
+#include <RAT/Materials.hh>
+
+#include <G4MTRunManager.hh>
+#include <G4PhysListFactory.hh>
+#include <G4VModularPhysicsList.hh>
+#include <G4OpticalPhysics.hh>
+#include <G4Threading.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace RAT;
+
+int main(int argc, char **argv)
+{
+  if(argc < 6 || argc > 8){
+    std::cerr << "Usage: " << argv[0] << " <geo file> <index> tagged|optical <events> <output .ratdb>"
+              << " [threads] [world material]" << std::endl;
+    return 1;
+  }
+  const std::string geoFile = argv[1];
+  const std::string mode = argv[3];
+  const int nEvents = atoi(argv[4]);
+  const int nThreads = argc > 6 ? atoi(argv[6]) : G4Threading::G4GetNumberOfCores();
+  const std::string worldMaterial = argc > 7 ? argv[7] : "G4_WATER";
+  if((mode != "tagged" && mode != "optical") || nEvents <= 0 || nThreads <= 0){
+    std::cerr << argv[0] << ": the mode must be tagged or optical, with a positive number of events and threads"
+              << std::endl;
+    return 1;
+  }
+
+  // Every gamma and beta line of the tagged sources is below 2.5 MeV; the
+  // UFO's LEDs are blue
+  CalibSourceResponseSettings settings;
+  settings.mode = mode == "tagged" ? CalibSourceResponseSettings::kTagged : CalibSourceResponseSettings::kOptical;
+  settings.index = argv[2];
+  settings.outputFile = argv[5];
+  settings.minEnergy = 0.;
+  settings.maxEnergy = 2.5*CLHEP::MeV;
+  settings.energyBins = 50;
+  settings.spectrumBins = 20;
+  settings.photonEnergy = 3.06*CLHEP::eV; // 405 nm
+  settings.maxTime = 10.*CLHEP::ns;
+  settings.timeBins = 50;
+
+  DB* db = DB::Get();
+  db->LoadDefaults();
+  db->Load(geoFile);
+  Materials::LoadMaterials();
+
+  // The tagged source's parameters as it is placed in the detector, before
+  // the response's world replaces its mother
+  TaggedSourceParams placed;
+  if(settings.mode == CalibSourceResponseSettings::kTagged)
+    placed.Load(db->GetLink("GEO",settings.index),"calib_source_response");
+
+  G4MTRunManager* runManager = new G4MTRunManager();
+  runManager->SetNumberOfThreads(nThreads);
+  runManager->SetUserInitialization(new CalibSourceResponseDetector(settings,worldMaterial));
+  G4PhysListFactory physListFactory;
+  G4VModularPhysicsList* physics = physListFactory.GetReferencePhysList("QBBC");
+  if(settings.mode == CalibSourceResponseSettings::kOptical)
+    physics->RegisterPhysics(new G4OpticalPhysics());
+  runManager->SetUserInitialization(physics);
+  runManager->SetUserInitialization(new CalibSourceResponseActionInitialization(settings));
+
+  runManager->Initialize();
+  runManager->BeamOn(nEvents);
+  delete runManager;
+
+  // The table is only of use if the placed source accepts it
+  if(settings.mode == CalibSourceResponseSettings::kTagged){
+    db->Load(settings.outputFile);
+    CalibSourceResponse response;
+    response.Load(db->GetLink(placed.responseTable,settings.index),placed.GetHash());
+    info << "calib_source_response: " << settings.outputFile << " loads for " << settings.index
+         << " in " << placed.mother << newline;
+  }
+  return 0;
+}